@@ -0,0 +1,469 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "Culling.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CULL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles AVX intrinsics anywhere; GCC and Clang need the function to
+// be built for AVX, and cull_best_mode makes sure it only runs where it can.
+#if defined(CULL_X86) && defined(__GNUC__)
+#define CULL_AVX_TARGET __attribute__((target("avx")))
+#else
+#define CULL_AVX_TARGET
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void cull_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static uint64_t cull_now_ns() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////
+
+cull_mode_t cull_best_mode() {
+#if defined(CULL_X86) && defined(_MSC_VER)
+	// AVX needs the CPU to have it and the OS to save the YMM registers
+	int info[4];
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx     = (info[2] & (1 << 28)) != 0;
+	if (osxsave && avx && (_xgetbv(0) & 6) == 6)
+		return cull_mode_avx;
+	return cull_mode_sse;
+#elif defined(CULL_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx"))
+		return cull_mode_avx;
+	return cull_mode_sse;
+#else
+	return cull_mode_scalar;
+#endif
+}
+
+const char* cull_mode_name(cull_mode_t mode) {
+	switch (mode) {
+	case cull_mode_scalar: return "scalar";
+	case cull_mode_sse:    return "sse";
+	case cull_mode_avx:    return "avx";
+	default:               return "unknown";
+	}
+}
+
+void cull_init(cull_t& cull, cull_mode_t mode) {
+	cull.mode  = mode;
+	cull.stats = {};
+	cull.visible.clear();
+}
+
+uint32_t cull_bounds_add(cull_bounds_t& bounds, float x, float y, float z, float radius) {
+	bounds.x     .push_back(x);
+	bounds.y     .push_back(y);
+	bounds.z     .push_back(z);
+	bounds.radius.push_back(radius);
+	return (uint32_t)bounds.x.size() - 1;
+}
+
+void cull_bounds_clear(cull_bounds_t& bounds) {
+	bounds.x     .clear();
+	bounds.y     .clear();
+	bounds.z     .clear();
+	bounds.radius.clear();
+}
+
+///////////////////////////////////////////
+
+static float cull_dot(const float a[3], const float b[3]) {
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// v rotated by q
+static void cull_rotate(const XrQuaternionf& q, const float v[3], float result[3]) {
+	float u[3] = { q.x, q.y, q.z };
+	float t[3] = {
+		2.0f * (u[1] * v[2] - u[2] * v[1]),
+		2.0f * (u[2] * v[0] - u[0] * v[2]),
+		2.0f * (u[0] * v[1] - u[1] * v[0]) };
+	result[0] = v[0] + q.w * t[0] + (u[1] * t[2] - u[2] * t[1]);
+	result[1] = v[1] + q.w * t[1] + (u[2] * t[0] - u[0] * t[2]);
+	result[2] = v[2] + q.w * t[2] + (u[0] * t[1] - u[1] * t[0]);
+}
+
+static void cull_accept_all(cull_frustum_t& frustum) {
+	for (int32_t p = 0; p < CULL_PLANES; p++) {
+		frustum.planes[p][0] = 0.0f;
+		frustum.planes[p][1] = 0.0f;
+		frustum.planes[p][2] = 0.0f;
+		frustum.planes[p][3] = 1.0f;
+	}
+}
+
+// The combined frustum looks along the first view's forward axis from an
+// apex behind the views, pulled back far enough that the outer planes of the
+// views line up with it. Its planes are then fit around the near and far
+// corners of every view. A frustum is convex, so holding every corner means
+// holding every view's whole frustum, which keeps it conservative however
+// the views are posed.
+bool cull_make_frustum(const XrView* views, uint32_t view_count, float near_z, float far_z, cull_frustum_t& frustum) {
+	cull_accept_all(frustum);
+	if (view_count == 0)
+		return false;
+
+	// OpenXR views look down -Z, with +Y up
+	const float axis_right  [3] = { 1, 0,  0 };
+	const float axis_up     [3] = { 0, 1,  0 };
+	const float axis_forward[3] = { 0, 0, -1 };
+	float right[3], up[3], forward[3];
+	cull_rotate(views[0].pose.orientation, axis_right,   right);
+	cull_rotate(views[0].pose.orientation, axis_up,      up);
+	cull_rotate(views[0].pose.orientation, axis_forward, forward);
+
+	float center[3]     = {};
+	float tan_left      = 0, tan_right = 0;
+	float min_offset    = 0, max_offset = 0;
+	for (uint32_t i = 0; i < view_count; i++) {
+		const XrVector3f& position = views[i].pose.position;
+		center[0] += position.x / view_count;
+		center[1] += position.y / view_count;
+		center[2] += position.z / view_count;
+		tan_left  = std::min(tan_left,  tanf(views[i].fov.angleLeft));
+		tan_right = std::max(tan_right, tanf(views[i].fov.angleRight));
+	}
+	for (uint32_t i = 0; i < view_count; i++) {
+		float offset[3] = { views[i].pose.position.x - center[0], views[i].pose.position.y - center[1], views[i].pose.position.z - center[2] };
+		min_offset = std::min(min_offset, cull_dot(offset, right));
+		max_offset = std::max(max_offset, cull_dot(offset, right));
+	}
+	float pull_back = tan_right - tan_left > 0.001f ? (max_offset - min_offset) / (tan_right - tan_left) : 0.0f;
+	float apex[3] = {
+		center[0] - forward[0] * pull_back,
+		center[1] - forward[1] * pull_back,
+		center[2] - forward[2] * pull_back };
+
+	// Tangents and depth of every corner, as seen from the apex
+	float bound_left = 1e9f, bound_right = -1e9f, bound_down = 1e9f, bound_up = -1e9f;
+	float bound_near = 1e9f, bound_far   = -1e9f;
+	for (uint32_t i = 0; i < view_count; i++) {
+		const XrFovf& fov = views[i].fov;
+		float tan_x[2] = { tanf(fov.angleLeft), tanf(fov.angleRight) };
+		float tan_y[2] = { tanf(fov.angleDown), tanf(fov.angleUp) };
+		float depth[2] = { near_z, far_z };
+		for (int32_t corner = 0; corner < 8; corner++) {
+			float d     = depth[corner >> 2];
+			float local[3] = { tan_x[corner & 1] * d, tan_y[(corner >> 1) & 1] * d, -d };
+			float world[3];
+			cull_rotate(views[i].pose.orientation, local, world);
+			world[0] += views[i].pose.position.x - apex[0];
+			world[1] += views[i].pose.position.y - apex[1];
+			world[2] += views[i].pose.position.z - apex[2];
+
+			float z = cull_dot(world, forward);
+			if (z < 0.0001f) {
+				cull_accept_all(frustum);
+				return false;
+			}
+			float x = cull_dot(world, right) / z;
+			float y = cull_dot(world, up)    / z;
+			bound_left  = std::min(bound_left,  x);
+			bound_right = std::max(bound_right, x);
+			bound_down  = std::min(bound_down,  y);
+			bound_up    = std::max(bound_up,    y);
+			bound_near  = std::min(bound_near,  z);
+			bound_far   = std::max(bound_far,   z);
+		}
+	}
+
+	// Inward normals in the apex's right, up, forward basis, and their
+	// distance along that normal from the apex
+	float local_planes[CULL_PLANES][4] = {
+		{  1,  0, -bound_left,  0 },
+		{ -1,  0,  bound_right, 0 },
+		{  0,  1, -bound_down,  0 },
+		{  0, -1,  bound_up,    0 },
+		{  0,  0,  1, -bound_near },
+		{  0,  0, -1,  bound_far  },
+	};
+	for (int32_t p = 0; p < CULL_PLANES; p++) {
+		const float* plane  = local_planes[p];
+		float        length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		float        normal[3];
+		for (int32_t k = 0; k < 3; k++)
+			normal[k] = (right[k] * plane[0] + up[k] * plane[1] + forward[k] * plane[2]) / length;
+		frustum.planes[p][0] = normal[0];
+		frustum.planes[p][1] = normal[1];
+		frustum.planes[p][2] = normal[2];
+		frustum.planes[p][3] = plane[3] / length - cull_dot(normal, apex);
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+// Every path evaluates the plane distance in the same order, so they agree
+// exactly, on the boundary too
+static uint32_t cull_test_scalar(const cull_frustum_t& frustum, const cull_bounds_t& bounds, uint32_t first, uint32_t count, uint32_t* visible) {
+	const float* x = bounds.x.data();
+	const float* y = bounds.y.data();
+	const float* z = bounds.z.data();
+	const float* r = bounds.radius.data();
+
+	uint32_t result = 0;
+	for (uint32_t i = first; i < first + count; i++) {
+		bool inside = true;
+		for (int32_t p = 0; p < CULL_PLANES; p++) {
+			const float* plane = frustum.planes[p];
+			float distance = plane[0] * x[i] + plane[1] * y[i] + plane[2] * z[i] + plane[3];
+			inside &= distance >= -r[i];
+		}
+		visible[result] = i;
+		result += inside ? 1 : 0;
+	}
+	return result;
+}
+
+#ifdef CULL_X86
+static uint32_t cull_test_sse(const cull_frustum_t& frustum, const cull_bounds_t& bounds, uint32_t first, uint32_t count, uint32_t* visible) {
+	const float* x = bounds.x.data();
+	const float* y = bounds.y.data();
+	const float* z = bounds.z.data();
+	const float* r = bounds.radius.data();
+
+	__m128 planes[CULL_PLANES][4];
+	for (int32_t p = 0; p < CULL_PLANES; p++) {
+		for (int32_t k = 0; k < 4; k++)
+			planes[p][k] = _mm_set1_ps(frustum.planes[p][k]);
+	}
+
+	uint32_t result = 0;
+	uint32_t i      = first;
+	uint32_t end    = first + count;
+	for (; i + 4 <= end; i += 4) {
+		__m128 px     = _mm_loadu_ps(x + i);
+		__m128 py     = _mm_loadu_ps(y + i);
+		__m128 pz     = _mm_loadu_ps(z + i);
+		__m128 neg_r  = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+		__m128 inside = _mm_cmpeq_ps(px, px); // All ones, unless NaN
+		for (int32_t p = 0; p < CULL_PLANES; p++) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(planes[p][0], px),
+				_mm_mul_ps(planes[p][1], py)),
+				_mm_mul_ps(planes[p][2], pz)),
+				planes[p][3]);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_r));
+		}
+
+		// Write every index, advance only past the visible ones
+		uint32_t mask = (uint32_t)_mm_movemask_ps(inside);
+		for (uint32_t b = 0; b < 4; b++) {
+			visible[result] = i + b;
+			result += (mask >> b) & 1;
+		}
+	}
+	return result + cull_test_scalar(frustum, bounds, i, end - i, visible + result);
+}
+
+CULL_AVX_TARGET
+static uint32_t cull_test_avx(const cull_frustum_t& frustum, const cull_bounds_t& bounds, uint32_t first, uint32_t count, uint32_t* visible) {
+	const float* x = bounds.x.data();
+	const float* y = bounds.y.data();
+	const float* z = bounds.z.data();
+	const float* r = bounds.radius.data();
+
+	__m256 planes[CULL_PLANES][4];
+	for (int32_t p = 0; p < CULL_PLANES; p++) {
+		for (int32_t k = 0; k < 4; k++)
+			planes[p][k] = _mm256_set1_ps(frustum.planes[p][k]);
+	}
+
+	uint32_t result = 0;
+	uint32_t i      = first;
+	uint32_t end    = first + count;
+	for (; i + 8 <= end; i += 8) {
+		__m256 px     = _mm256_loadu_ps(x + i);
+		__m256 py     = _mm256_loadu_ps(y + i);
+		__m256 pz     = _mm256_loadu_ps(z + i);
+		__m256 neg_r  = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+		__m256 inside = _mm256_cmp_ps(px, px, _CMP_EQ_OQ);
+		for (int32_t p = 0; p < CULL_PLANES; p++) {
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(planes[p][0], px),
+				_mm256_mul_ps(planes[p][1], py)),
+				_mm256_mul_ps(planes[p][2], pz)),
+				planes[p][3]);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, neg_r, _CMP_GE_OQ));
+		}
+
+		uint32_t mask = (uint32_t)_mm256_movemask_ps(inside);
+		for (uint32_t b = 0; b < 8; b++) {
+			visible[result] = i + b;
+			result += (mask >> b) & 1;
+		}
+	}
+	return result + cull_test_scalar(frustum, bounds, i, end - i, visible + result);
+}
+#endif
+
+uint32_t cull_test(cull_mode_t mode, const cull_frustum_t& frustum, const cull_bounds_t& bounds, uint32_t first, uint32_t count, uint32_t* visible) {
+#ifdef CULL_X86
+	switch (mode) {
+	case cull_mode_avx: return cull_test_avx(frustum, bounds, first, count, visible);
+	case cull_mode_sse: return cull_test_sse(frustum, bounds, first, count, visible);
+	default: break;
+	}
+#endif
+	return cull_test_scalar(frustum, bounds, first, count, visible);
+}
+
+uint32_t cull_run(cull_t& cull, const cull_frustum_t& frustum, const cull_bounds_t& bounds) {
+	uint64_t start = cull_now_ns();
+	uint32_t count = (uint32_t)bounds.x.size();
+	cull.visible.resize(count);
+	uint32_t visible = cull_test(cull.mode, frustum, bounds, 0, count, cull.visible.data());
+	cull.visible.resize(visible);
+
+	cull.stats.frames  += 1;
+	cull.stats.tested  += count;
+	cull.stats.visible += visible;
+	cull.stats.ticks   += cull_now_ns() - start;
+	return visible;
+}
+
+void cull_report(const cull_t& cull) {
+	const cull_stats_t& stats = cull.stats;
+	if (stats.frames == 0)
+		return;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Culling (%s): %.1f of %.1f objects visible per frame, %.2f us per frame\n",
+		cull_mode_name(cull.mode),
+		(double)stats.visible / stats.frames, (double)stats.tested / stats.frames,
+		stats.ticks / 1000.0 / stats.frames);
+	cull_log(text);
+}
+
+///////////////////////////////////////////
+
+static uint32_t cull_random(uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static float cull_random_range(uint32_t& state, float min, float max) {
+	return min + (max - min) * (cull_random(state) & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+bool cull_benchmark(uint32_t max_objects) {
+	// A typical headset: eyes 64 mm apart, asymmetric fields of view, looking
+	// down -Z a little to the right
+	XrView views[2] = {};
+	views[0].type = views[1].type = XR_TYPE_VIEW;
+	XrQuaternionf orientation = { 0.0f, sinf(-0.15f), 0.0f, cosf(-0.15f) };
+	views[0].pose = { orientation, { -0.032f, 1.6f, 0.0f } };
+	views[1].pose = { orientation, {  0.032f, 1.6f, 0.0f } };
+	views[0].fov  = { -0.90f, 0.75f, 0.80f, -0.85f };
+	views[1].fov  = { -0.75f, 0.90f, 0.80f, -0.85f };
+	const float near_z = 0.05f, far_z = 50.0f;
+
+	cull_frustum_t stereo, eyes[2];
+	cull_make_frustum(views, 2, near_z, far_z, stereo);
+	cull_make_frustum(&views[0], 1, near_z, far_z, eyes[0]);
+	cull_make_frustum(&views[1], 1, near_z, far_z, eyes[1]);
+
+	cull_mode_t best = cull_best_mode();
+	char text[256];
+	snprintf(text, sizeof(text), "Culling benchmark, best mode %s\n", cull_mode_name(best));
+	cull_log(text);
+
+	bool passed = true;
+	for (uint32_t object_count = 1000; object_count <= max_objects; object_count *= 10) {
+		uint32_t      seed = 0x2545F491;
+		cull_bounds_t bounds;
+		for (uint32_t i = 0; i < object_count; i++) {
+			cull_bounds_add(bounds,
+				cull_random_range(seed, -60.0f, 60.0f),
+				cull_random_range(seed, -5.0f, 10.0f),
+				cull_random_range(seed, -60.0f, 60.0f),
+				cull_random_range(seed, 0.05f, 1.0f));
+		}
+
+		// Enough repetitions for a few million tests each
+		uint32_t repeat = std::max(1u, 4000000u / object_count);
+		std::vector<uint32_t> visible[cull_mode_count];
+		double                ns_per_object[cull_mode_count] = {};
+		for (int32_t mode = 0; mode < cull_mode_count; mode++) {
+			if (mode > best)
+				continue;
+			visible[mode].resize(object_count);
+			uint32_t count = 0;
+			uint64_t start = cull_now_ns();
+			for (uint32_t r = 0; r < repeat; r++)
+				count = cull_test((cull_mode_t)mode, stereo, bounds, 0, object_count, visible[mode].data());
+			ns_per_object[mode] = (double)(cull_now_ns() - start) / ((double)repeat * object_count);
+			visible[mode].resize(count);
+			if (visible[mode] != visible[cull_mode_scalar]) {
+				snprintf(text, sizeof(text), "  %u objects: %s disagrees with scalar\n", object_count, cull_mode_name((cull_mode_t)mode));
+				cull_log(text);
+				passed = false;
+			}
+		}
+
+		// The alternative: each eye culled on its own. Everything either eye
+		// sees has to be in the shared list.
+		std::vector<uint32_t> eye_visible[2];
+		uint64_t start = cull_now_ns();
+		for (uint32_t r = 0; r < repeat; r++) {
+			for (int32_t e = 0; e < 2; e++) {
+				eye_visible[e].resize(object_count);
+				eye_visible[e].resize(cull_test(best, eyes[e], bounds, 0, object_count, eye_visible[e].data()));
+			}
+		}
+		double per_eye_ns = (double)(cull_now_ns() - start) / ((double)repeat * object_count);
+
+		const std::vector<uint32_t>& shared = visible[cull_mode_scalar];
+		std::vector<uint32_t>        either;
+		std::set_union(eye_visible[0].begin(), eye_visible[0].end(), eye_visible[1].begin(), eye_visible[1].end(), std::back_inserter(either));
+		if (!std::includes(shared.begin(), shared.end(), either.begin(), either.end())) {
+			snprintf(text, sizeof(text), "  %u objects: stereo frustum misses objects an eye can see\n", object_count);
+			cull_log(text);
+			passed = false;
+		}
+
+		snprintf(text, sizeof(text), "  %7u objects: scalar %.2f, sse %.2f, avx %.2f ns/object; per-eye %.2f ns/object; %zu visible, %zu to either eye\n",
+			object_count, ns_per_object[cull_mode_scalar], ns_per_object[cull_mode_sse], ns_per_object[cull_mode_avx],
+			per_eye_ns, shared.size(), either.size());
+		cull_log(text);
+	}
+	return passed;
+}
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <vector>
+
+// Frustum culling, once per frame for every view together. cull_make_frustum
+// builds a single conservative frustum that encloses the frusta of all the
+// views xrLocateViews returned, so both eyes share one visible list instead
+// of culling twice.
+//
+// Object bounds are spheres kept as structure of arrays, so a batch of 4
+// (SSE) or 8 (AVX) objects is tested against a plane with a few vector
+// instructions. Visible indices are written out compactly, without branches.
+// The scalar path gives the same results and is used where neither
+// instruction set is available.
+//
+// There are no graphics dependencies here, and cull_benchmark runs without
+// OpenXR or a GPU.
+
+#define CULL_PLANES 6
+
+enum cull_mode_t {
+	cull_mode_scalar = 0,
+	cull_mode_sse,
+	cull_mode_avx,
+	cull_mode_count,
+};
+
+// Planes point inward, a point p is inside when dot(plane.xyz, p) + plane.w >= 0.
+// Order: left, right, bottom, top, near, far.
+typedef struct cull_frustum_t {
+	float planes[CULL_PLANES][4];
+} cull_frustum_t;
+
+// Bounding spheres, in world space
+typedef struct cull_bounds_t {
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> radius;
+} cull_bounds_t;
+
+typedef struct cull_stats_t {
+	uint64_t frames;
+	uint64_t tested;
+	uint64_t visible;
+	uint64_t ticks; // steady_clock nanoseconds spent in cull_run
+} cull_stats_t;
+
+typedef struct cull_t {
+	cull_mode_t           mode;
+	std::vector<uint32_t> visible; // Indices into the bounds of the last cull_run
+	cull_stats_t          stats;
+} cull_t;
+
+// The fastest mode this CPU and OS support
+cull_mode_t cull_best_mode();
+const char* cull_mode_name(cull_mode_t mode);
+
+void     cull_init(cull_t& cull, cull_mode_t mode);
+uint32_t cull_bounds_add(cull_bounds_t& bounds, float x, float y, float z, float radius);
+void     cull_bounds_clear(cull_bounds_t& bounds);
+
+// Encloses the view frusta of every view, each clipped to near_z and far_z.
+// Returns false, and a frustum that accepts everything, if the views can't be
+// enclosed by one frustum, such as when they face apart.
+bool cull_make_frustum(const XrView* views, uint32_t view_count, float near_z, float far_z, cull_frustum_t& frustum);
+
+// Tests bounds[first, first + count) and writes the indices of spheres that
+// touch the frustum to visible, which needs room for count entries. Returns
+// how many were written.
+uint32_t cull_test(cull_mode_t mode, const cull_frustum_t& frustum, const cull_bounds_t& bounds, uint32_t first, uint32_t count, uint32_t* visible);
+
+// Culls all of bounds into cull.visible
+uint32_t cull_run(cull_t& cull, const cull_frustum_t& frustum, const cull_bounds_t& bounds);
+
+void cull_report(const cull_t& cull);
+
+// Culls random scenes of 1k up to max_objects against a stereo frustum with
+// every mode, checks the modes agree and logs the time per object
+bool cull_benchmark(uint32_t max_objects);
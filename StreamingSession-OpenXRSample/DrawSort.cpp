@@ -0,0 +1,246 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "DrawSort.h"
+#include "RenderBackend.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void draw_sort_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static uint64_t draw_sort_now_ns() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////
+
+static uint64_t draw_key_field(uint64_t key, uint32_t value, uint32_t bits) {
+	return (key << bits) | (value & ((1u << bits) - 1));
+}
+
+uint64_t draw_key(uint32_t layer, draw_pass_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth, float depth_range) {
+	const uint32_t depth_max = (1u << DRAW_KEY_DEPTH_BITS) - 1;
+	float    scaled    = depth_range > 0.0f ? depth / depth_range * depth_max : 0.0f;
+	uint32_t quantized = scaled <= 0.0f ? 0 : scaled >= (float)depth_max ? depth_max : (uint32_t)scaled;
+	if (pass == draw_pass_transparent)
+		quantized = depth_max - quantized;
+
+	uint64_t key = 0;
+	key = draw_key_field(key, layer,          DRAW_KEY_LAYER_BITS);
+	key = draw_key_field(key, (uint32_t)pass, DRAW_KEY_PASS_BITS);
+	key = draw_key_field(key, pipeline,       DRAW_KEY_PIPELINE_BITS);
+	key = draw_key_field(key, material,       DRAW_KEY_MATERIAL_BITS);
+	key = draw_key_field(key, mesh,           DRAW_KEY_MESH_BITS);
+	key = draw_key_field(key, quantized,      DRAW_KEY_DEPTH_BITS);
+	return key;
+}
+
+void draw_list_reserve(draw_list_t& list, uint32_t count) {
+	list.keys         .reserve(count);
+	list.items        .reserve(count);
+	list.scratch_keys .reserve(count);
+	list.scratch_items.reserve(count);
+}
+
+void draw_list_clear(draw_list_t& list) {
+	list.keys .clear();
+	list.items.clear();
+}
+
+void draw_list_add(draw_list_t& list, uint64_t key, uint32_t item) {
+	list.keys .push_back(key);
+	list.items.push_back(item);
+}
+
+void draw_list_sort(draw_list_t& list) {
+	uint64_t start = draw_sort_now_ns();
+	uint32_t count = (uint32_t)list.keys.size();
+	list.scratch_keys .resize(count);
+	list.scratch_items.resize(count);
+
+	// Every byte's histogram from one read of the keys
+	uint32_t histogram[8][256] = {};
+	for (uint32_t i = 0; i < count; i++) {
+		uint64_t key = list.keys[i];
+		for (int32_t b = 0; b < 8; b++)
+			histogram[b][(key >> (b * 8)) & 0xFF]++;
+	}
+
+	uint64_t* keys      = list.keys.data();
+	uint32_t* items     = list.items.data();
+	uint64_t* out_keys  = list.scratch_keys.data();
+	uint32_t* out_items = list.scratch_items.data();
+	uint32_t  passes    = 0;
+	for (int32_t b = 0; b < 8 && count > 1; b++) {
+		// Every key has the same byte here, so this pass wouldn't move anything
+		uint32_t  shift  = b * 8;
+		uint32_t* offset = histogram[b];
+		if (offset[(keys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t total = 0;
+		for (int32_t d = 0; d < 256; d++) {
+			uint32_t digit_count = offset[d];
+			offset[d] = total;
+			total    += digit_count;
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t to = offset[(keys[i] >> shift) & 0xFF]++;
+			out_keys [to] = keys [i];
+			out_items[to] = items[i];
+		}
+		std::swap(keys,  out_keys);
+		std::swap(items, out_items);
+		passes++;
+	}
+	// An odd number of passes leaves the result in the scratch arrays
+	if (passes & 1) {
+		list.keys .swap(list.scratch_keys);
+		list.items.swap(list.scratch_items);
+	}
+
+	list.stats.frames += 1;
+	list.stats.draws  += count;
+	list.stats.passes += passes;
+	list.stats.ticks  += draw_sort_now_ns() - start;
+}
+
+void draw_list_report(const draw_list_t& list) {
+	const draw_sort_stats_t& stats = list.stats;
+	if (stats.frames == 0)
+		return;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Draw sort, per frame: %.1f draws in %.1f radix passes, %.3f ms\n",
+		(double)stats.draws / stats.frames, (double)stats.passes / stats.frames, stats.ticks / 1e6 / stats.frames);
+	draw_sort_log(text);
+}
+
+///////////////////////////////////////////
+
+static uint32_t draw_random(uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+typedef struct draw_bench_t {
+	uint32_t pipeline;
+	uint32_t material;
+	uint32_t mesh;
+} draw_bench_t;
+
+static render_handle_t draw_bench_handle(uint32_t id) {
+	return (render_handle_t)(uintptr_t)(id + 1);
+}
+
+// Issues the draws in the list's order, each with its pipeline, its
+// material's texture and its mesh's buffers, and counts the binds that got
+// past the context
+static uint32_t draw_bench_binds(const draw_list_t& list, const std::vector<draw_bench_t>& draws) {
+	render_recording_t recording = {};
+	render_context_t   render;
+	render_init(render, render_recording_backend(recording));
+	for (uint32_t i = 0; i < (uint32_t)list.items.size(); i++) {
+		const draw_bench_t& draw    = draws[list.items[i]];
+		render_handle_t     texture = draw_bench_handle(draw.material);
+		render_set_pipeline     (render, draw_bench_handle(draw.pipeline));
+		render_set_textures     (render, 0, 1, &texture);
+		render_set_vertex_buffer(render, draw_bench_handle(draw.mesh), 36);
+		render_set_index_buffer (render, draw_bench_handle(draw.mesh), 2);
+		render_draw_indexed     (render, 36);
+	}
+	return render_recording_binds(recording);
+}
+
+bool draw_sort_benchmark(uint32_t max_draws) {
+	// Roughly a game scene: a few pipelines, more materials and meshes, two
+	// layers, and a tenth of the draws transparent
+	const uint32_t pipelines = 8, materials = 64, meshes = 32;
+	const float    depth_range = 50.0f;
+
+	char text[256];
+	draw_sort_log("Draw sort benchmark\n");
+
+	bool passed = true;
+	for (uint32_t draw_count = 1000; draw_count <= max_draws; draw_count *= 10) {
+		uint32_t                  seed = 0x2545F491;
+		std::vector<draw_bench_t> draws(draw_count);
+		std::vector<uint64_t>     keys (draw_count);
+		for (uint32_t i = 0; i < draw_count; i++) {
+			draw_bench_t& draw = draws[i];
+			draw.pipeline = draw_random(seed) % pipelines;
+			draw.material = draw_random(seed) % materials;
+			draw.mesh     = draw_random(seed) % meshes;
+			uint32_t    layer = draw_random(seed) % 2;
+			draw_pass_t pass  = draw_random(seed) % 10 == 0 ? draw_pass_transparent : draw_pass_opaque;
+			float       depth = (draw_random(seed) & 0xFFFF) / 65536.0f * depth_range;
+			keys[i] = draw_key(layer, pass, draw.pipeline, draw.material, draw.mesh, depth, depth_range);
+		}
+
+		draw_list_t list = {};
+		draw_list_reserve(list, draw_count);
+		for (uint32_t i = 0; i < draw_count; i++)
+			draw_list_add(list, keys[i], i);
+		uint32_t unsorted_binds = draw_bench_binds(list, draws);
+
+		// Enough repetitions for a few million draws each
+		uint32_t repeat = std::max(1u, 4000000u / draw_count);
+		for (uint32_t r = 0; r < repeat; r++) {
+			draw_list_clear(list);
+			for (uint32_t i = 0; i < draw_count; i++)
+				draw_list_add(list, keys[i], i);
+			draw_list_sort(list);
+		}
+		double radix_ns = (double)list.stats.ticks / ((double)repeat * draw_count);
+		double passes   = (double)list.stats.passes / repeat;
+
+		std::vector<std::pair<uint64_t, uint32_t>> reference(draw_count);
+		uint64_t reference_ticks = 0;
+		for (uint32_t r = 0; r < repeat; r++) {
+			for (uint32_t i = 0; i < draw_count; i++)
+				reference[i] = { keys[i], i };
+			uint64_t start = draw_sort_now_ns();
+			std::stable_sort(reference.begin(), reference.end(), [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) { return a.first < b.first; });
+			reference_ticks += draw_sort_now_ns() - start;
+		}
+		double reference_ns = (double)reference_ticks / ((double)repeat * draw_count);
+
+		for (uint32_t i = 0; i < draw_count; i++) {
+			if (list.keys[i] != reference[i].first || list.items[i] != reference[i].second) {
+				snprintf(text, sizeof(text), "  %u draws: radix sort disagrees with std::stable_sort at %u\n", draw_count, i);
+				draw_sort_log(text);
+				passed = false;
+				break;
+			}
+		}
+
+		uint32_t sorted_binds = draw_bench_binds(list, draws);
+		snprintf(text, sizeof(text), "  %7u draws: radix %.2f ns/draw in %.1f passes, std::stable_sort %.2f ns/draw; binds %u unsorted, %u sorted\n",
+			draw_count, radix_ns, passes, reference_ns, unsorted_binds, sorted_binds);
+		draw_sort_log(text);
+	}
+	return passed;
+}
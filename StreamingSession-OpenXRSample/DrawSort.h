@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Draw ordering by sort key. Every draw of a frame gets a 64-bit key, most
+// significant bits first:
+//
+//   layer 4 | pass 4 | pipeline 12 | material 16 | mesh 12 | depth 16
+//
+// so sorting the keys groups draws by the state they bind, most expensive
+// to change first, and orders draws that bind the same state by depth.
+// render_context_t already drops binds that wouldn't change anything, so
+// the sorted order turns into fewer binds on its own.
+//
+// draw_list_sort is an LSD radix sort, 8 bits a pass, that skips passes
+// where every key has the same byte, so keys that only differ in a few
+// fields take a few passes. It is stable, so draws with the same key keep
+// the order they were added in. The list keeps its capacity, and nothing
+// allocates once it has held a frame's draws.
+//
+// There are no graphics dependencies here, and draw_sort_benchmark runs
+// without OpenXR or a GPU.
+
+#define DRAW_KEY_LAYER_BITS    4
+#define DRAW_KEY_PASS_BITS     4
+#define DRAW_KEY_PIPELINE_BITS 12
+#define DRAW_KEY_MATERIAL_BITS 16
+#define DRAW_KEY_MESH_BITS     12
+#define DRAW_KEY_DEPTH_BITS    16
+
+enum draw_pass_t {
+	draw_pass_opaque = 0,  // Front to back, so hidden pixels are rejected early
+	draw_pass_transparent, // Back to front, so blending composites correctly
+	draw_pass_count,
+};
+
+typedef struct draw_sort_stats_t {
+	uint64_t frames;
+	uint64_t draws;
+	uint64_t passes; // Radix passes run, out of 8 a sort
+	uint64_t ticks;  // steady_clock nanoseconds spent in draw_list_sort
+} draw_sort_stats_t;
+
+typedef struct draw_list_t {
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> items; // What each key draws, for the caller to look up
+	std::vector<uint64_t> scratch_keys;
+	std::vector<uint32_t> scratch_items;
+	draw_sort_stats_t     stats;
+} draw_list_t;
+
+// Fields wider than their bits are truncated. depth is quantized over
+// [0, depth_range), and anything further sorts last.
+uint64_t draw_key(uint32_t layer, draw_pass_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth, float depth_range);
+
+void draw_list_reserve(draw_list_t& list, uint32_t count);
+void draw_list_clear  (draw_list_t& list);
+void draw_list_add    (draw_list_t& list, uint64_t key, uint32_t item);
+void draw_list_sort   (draw_list_t& list);
+
+void draw_list_report(const draw_list_t& list);
+
+// Sorts random draw lists of 1k up to max_draws, and checks the result
+// against std::stable_sort. Each list is also issued through a render
+// context in the order it was added and in sorted order, and the binds the
+// recording backend sees are logged for both.
+bool draw_sort_benchmark(uint32_t max_draws);
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "DynamicResolution.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void dynres_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static float dynres_clamp(float value, float low, float high) {
+	return value < low ? low : (value > high ? high : value);
+}
+
+dynres_config_t dynres_default_config() {
+	dynres_config_t config;
+	config.budget         = 0.85f;
+	config.min_scale      = 0.6f;
+	config.max_scale      = 1.4f;
+	config.kp             = 0.20f;
+	config.ki             = 0.04f;
+	config.kd             = 0.10f;
+	config.integral_decay = 0.95f;
+	config.deadband       = 0.03f;
+	config.max_step       = 0.10f;
+	return config;
+}
+
+void dynres_init(dynres_t& dynres, const dynres_config_t& config) {
+	bool enabled = dynres.enabled;
+	dynres = {};
+	dynres.enabled         = enabled;
+	dynres.config          = config;
+	dynres.scale           = dynres_clamp(1.0f, config.min_scale, config.max_scale);
+	dynres.stats.scale_min = dynres.scale;
+	dynres.stats.scale_max = dynres.scale;
+}
+
+float dynres_update(dynres_t& dynres, float gpu_ms, float cpu_ms, float display_period_ms) {
+	const dynres_config_t& config = dynres.config;
+
+	float cost_ms   = gpu_ms > cpu_ms ? gpu_ms : cpu_ms;
+	float target_ms = display_period_ms * config.budget;
+	if (cost_ms <= 0.0f || target_ms <= 0.0f)
+		return dynres.scale;
+
+	// Positive error is headroom, negative is over budget
+	float error = (target_ms - cost_ms) / target_ms;
+	if (fabsf(error) < config.deadband)
+		error = 0.0f;
+
+	// Only integrate while the scale can still move in that direction, so a
+	// long stretch pinned at a limit doesn't have to be unwound later.
+	bool pinned = (error > 0 && dynres.scale >= config.max_scale) || (error < 0 && dynres.scale <= config.min_scale);
+	dynres.integral = dynres.integral * config.integral_decay + (pinned ? 0.0f : error);
+
+	float output = config.kp * error + config.ki * dynres.integral + config.kd * (error - dynres.prev_error);
+	dynres.prev_error = error;
+
+	// Cost scales with pixel count, so the controller steers area and the
+	// linear scale follows as its square root.
+	float area  = dynres.scale * dynres.scale;
+	area       *= 1.0f + dynres_clamp(output, -config.max_step, config.max_step);
+	dynres.scale = dynres_clamp(sqrtf(area), config.min_scale, config.max_scale);
+
+	dynres.stats.frames++;
+	if (cost_ms > target_ms) dynres.stats.over_budget++;
+	dynres.stats.scale_sum += dynres.scale;
+	if (dynres.scale < dynres.stats.scale_min) dynres.stats.scale_min = dynres.scale;
+	if (dynres.scale > dynres.stats.scale_max) dynres.stats.scale_max = dynres.scale;
+	return dynres.scale;
+}
+
+void dynres_extent(const dynres_t& dynres, int32_t recommended_width, int32_t recommended_height,
+	int32_t max_width, int32_t max_height, int32_t& out_width, int32_t& out_height) {
+	int32_t width  = (int32_t)(recommended_width  * dynres.scale);
+	int32_t height = (int32_t)(recommended_height * dynres.scale);
+	width  = width  > max_width  ? max_width  : width;
+	height = height > max_height ? max_height : height;
+	out_width  = width  < 2 ? 2 : width  & ~1;
+	out_height = height < 2 ? 2 : height & ~1;
+}
+
+void dynres_report(const dynres_t& dynres) {
+	if (!dynres.enabled)
+		return;
+
+	const dynres_stats_t& stats = dynres.stats;
+	char text[192];
+	snprintf(text, sizeof(text), "Dynamic resolution: %llu frames, scale avg %.2f min %.2f max %.2f, %llu frames over budget\n",
+		(unsigned long long)stats.frames,
+		stats.frames ? stats.scale_sum / stats.frames : (double)dynres.scale,
+		stats.scale_min, stats.scale_max,
+		(unsigned long long)stats.over_budget);
+	dynres_log(text);
+}
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+
+// Dynamic resolution controller. Every rendered frame it is fed the measured
+// GPU and CPU frame times, and it picks a resolution scale relative to the
+// runtime's recommended image size. Over budget, the scale drops before
+// frames start getting missed. With headroom to spare, it rises above 1 and
+// the app supersamples.
+//
+// There are no graphics or OpenXR dependencies here, so the controller can
+// be driven by recorded frame time traces as easily as by a live session.
+
+typedef struct dynres_config_t {
+	float budget;         // Fraction of the display period the frame may use
+	float min_scale;      // Linear scale limits, relative to the recommended size
+	float max_scale;
+	float kp;             // PID gains, applied to the relative frame time error
+	float ki;
+	float kd;
+	float integral_decay; // Leak on the integral term, so it can't wind up forever
+	float deadband;       // Relative error that is treated as on target
+	float max_step;       // Largest relative change in pixel count per frame
+} dynres_config_t;
+
+typedef struct dynres_stats_t {
+	uint64_t frames;
+	uint64_t over_budget;
+	double   scale_sum;
+	float    scale_min;
+	float    scale_max;
+} dynres_stats_t;
+
+typedef struct dynres_t {
+	bool            enabled;
+	dynres_config_t config;
+	float           scale;      // Current linear scale
+	float           integral;
+	float           prev_error;
+	dynres_stats_t  stats;
+} dynres_t;
+
+dynres_config_t dynres_default_config();
+void            dynres_init(dynres_t& dynres, const dynres_config_t& config);
+
+// Feeds one frame's measurements and returns the scale for the next frame.
+// The frame costs whichever of GPU and CPU time is larger. A time <= 0 means
+// there was no measurement, e.g. the GPU timestamps weren't ready yet.
+float dynres_update(dynres_t& dynres, float gpu_ms, float cpu_ms, float display_period_ms);
+
+// Image size for the current scale, clamped to the swapchain size and
+// rounded down to an even number of pixels.
+void dynres_extent(const dynres_t& dynres, int32_t recommended_width, int32_t recommended_height,
+	int32_t max_width, int32_t max_height, int32_t& out_width, int32_t& out_height);
+
+void dynres_report(const dynres_t& dynres);
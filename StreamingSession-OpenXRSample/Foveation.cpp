@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "Foveation.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void foveation_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+foveation_config_t foveation_default_config() {
+	foveation_config_t config;
+	config.radius            = 0.25f;  // About 14 degrees
+	config.periphery_scale   = 0.5f;
+	config.alpha             = 0.5f;
+	config.beta              = 0.1f;
+	config.saccade_threshold = 0.15f;
+	config.max_speed         = 10.0f;
+	config.max_horizon_s     = 0.05;
+	config.stale_s           = 0.25;
+	config.max_fovea_area    = 0.6f;
+	return config;
+}
+
+void foveation_init(foveation_t& foveation, const foveation_config_t& config) {
+	std::lock_guard<std::mutex> guard(foveation.lock);
+	foveation.config         = config;
+	foveation.radius         = config.radius;
+	foveation.channel_time_s = -1.0e9;
+	foveation.stats          = {};
+	for (int32_t i = 0; i < FOVEATION_MAX_EYES; i++)
+		foveation.eyes[i] = {};
+}
+
+bool foveation_parse_hint(const uint8_t* data, uint32_t size, foveation_hint_message_t& hint) {
+	if (size < sizeof(hint))
+		return false;
+	memcpy(&hint, data, sizeof(hint));
+	if (hint.magic != FOVEATION_HINT_MAGIC || hint.version != FOVEATION_HINT_VERSION
+		|| hint.eye_count < 1 || hint.eye_count > FOVEATION_MAX_EYES)
+		return false;
+
+	if (!isfinite(hint.radius))
+		return false;
+	for (uint32_t eye = 0; eye < hint.eye_count; eye++) {
+		for (int32_t i = 0; i < 2; i++) {
+			if (!isfinite(hint.tangent[eye][i]))
+				return false;
+			hint.tangent[eye][i] = fmaxf(-FOVEATION_MAX_TANGENT, fminf(FOVEATION_MAX_TANGENT, hint.tangent[eye][i]));
+		}
+	}
+	// Negative means the default, like 0
+	hint.radius = fmaxf(0.0f, fminf(FOVEATION_MAX_TANGENT, hint.radius));
+	return true;
+}
+
+// Caller holds foveation.lock
+static void foveation_update_eye(foveation_t& foveation, uint32_t eye, float tangent_x, float tangent_y, double time_s) {
+	const foveation_config_t& config = foveation.config;
+	foveation_eye_t&          state  = foveation.eyes[eye];
+
+	double dt = time_s - state.time_s;
+	if (!state.valid || dt <= 0.0 || dt > config.stale_s) {
+		state.valid       = true;
+		state.time_s      = time_s;
+		state.position[0] = tangent_x;
+		state.position[1] = tangent_y;
+		state.velocity[0] = state.velocity[1] = 0.0f;
+		return;
+	}
+
+	float predicted[2] = { state.position[0] + state.velocity[0] * (float)dt, state.position[1] + state.velocity[1] * (float)dt };
+	float residual [2] = { tangent_x - predicted[0], tangent_y - predicted[1] };
+	state.time_s = time_s;
+
+	// A saccade moves faster than any smoothing should follow, so jump
+	// straight to it rather than dragging the fovea across the image.
+	if (sqrtf(residual[0] * residual[0] + residual[1] * residual[1]) > config.saccade_threshold) {
+		state.position[0] = tangent_x;
+		state.position[1] = tangent_y;
+		state.velocity[0] = state.velocity[1] = 0.0f;
+		foveation.stats.saccades++;
+		return;
+	}
+
+	for (int32_t i = 0; i < 2; i++) {
+		state.position[i] = predicted[i] + config.alpha * residual[i];
+		state.velocity[i] = state.velocity[i] + config.beta * residual[i] / (float)dt;
+	}
+	float speed = sqrtf(state.velocity[0] * state.velocity[0] + state.velocity[1] * state.velocity[1]);
+	if (speed > config.max_speed) {
+		state.velocity[0] *= config.max_speed / speed;
+		state.velocity[1] *= config.max_speed / speed;
+	}
+}
+
+void foveation_add_hint(foveation_t& foveation, const foveation_hint_message_t& hint, double time_s) {
+	std::lock_guard<std::mutex> guard(foveation.lock);
+	foveation.channel_time_s = time_s;
+	foveation.radius         = hint.radius > 0 ? hint.radius : foveation.config.radius;
+	for (uint32_t eye = 0; eye < FOVEATION_MAX_EYES; eye++) {
+		// A mono hint applies to both eyes
+		uint32_t source = eye < hint.eye_count ? eye : 0;
+		foveation_update_eye(foveation, eye, hint.tangent[source][0], hint.tangent[source][1], time_s);
+	}
+	foveation.stats.samples[foveation_source_channel]++;
+}
+
+void foveation_add_sample(foveation_t& foveation, foveation_source_t source, uint32_t eye, float tangent_x, float tangent_y, double time_s) {
+	if (eye >= FOVEATION_MAX_EYES)
+		return;
+	std::lock_guard<std::mutex> guard(foveation.lock);
+	if (source != foveation_source_channel && time_s - foveation.channel_time_s < foveation.config.stale_s)
+		return;
+	foveation_update_eye(foveation, eye, tangent_x, tangent_y, time_s);
+	foveation.stats.samples[source]++;
+}
+
+static XrVector3f foveation_rotate(const XrQuaternionf& q, const XrVector3f& v) {
+	// v + 2w(u x v) + 2(u x (u x v)), with u the vector part of q
+	XrVector3f t = { 2 * (q.y * v.z - q.z * v.y), 2 * (q.z * v.x - q.x * v.z), 2 * (q.x * v.y - q.y * v.x) };
+	return {
+		v.x + q.w * t.x + (q.y * t.z - q.z * t.y),
+		v.y + q.w * t.y + (q.z * t.x - q.x * t.z),
+		v.z + q.w * t.z + (q.x * t.y - q.y * t.x) };
+}
+
+bool foveation_pose_to_tangent(const XrPosef& eye_pose, const XrPosef& gaze_pose, float& tangent_x, float& tangent_y) {
+	// Gaze origin is ignored: the fixation point is far enough away that the
+	// offset between gaze origin and each eye barely moves it.
+	XrVector3f    forward   = { 0, 0, -1 };
+	XrVector3f    gaze      = foveation_rotate(gaze_pose.orientation, forward);
+	XrQuaternionf eye_inv   = { -eye_pose.orientation.x, -eye_pose.orientation.y, -eye_pose.orientation.z, eye_pose.orientation.w };
+	XrVector3f    local     = foveation_rotate(eye_inv, gaze);
+	if (local.z > -0.1f)
+		return false;
+	tangent_x = local.x / -local.z;
+	tangent_y = local.y / -local.z;
+	return true;
+}
+
+bool foveation_predict(foveation_t& foveation, uint32_t eye, double time_s, float& tangent_x, float& tangent_y) {
+	std::lock_guard<std::mutex> guard(foveation.lock);
+	const foveation_eye_t& state = foveation.eyes[eye < FOVEATION_MAX_EYES ? eye : 0];
+
+	double horizon = time_s - state.time_s;
+	if (!state.valid || horizon > foveation.config.stale_s) {
+		tangent_x = 0.0f;
+		tangent_y = 0.0f;
+		return false;
+	}
+	if (horizon < 0.0)                          horizon = 0.0;
+	if (horizon > foveation.config.max_horizon_s) horizon = foveation.config.max_horizon_s;
+	tangent_x = state.position[0] + state.velocity[0] * (float)horizon;
+	tangent_y = state.position[1] + state.velocity[1] * (float)horizon;
+	return true;
+}
+
+void foveation_make_map(foveation_t& foveation, uint32_t eye, double time_s, const XrFovf& fov, const XrRect2Di& image_rect, foveation_map_t& map) {
+	float tangent_x, tangent_y;
+	bool  tracked = foveation_predict(foveation, eye, time_s, tangent_x, tangent_y);
+
+	float left  = tanf(fov.angleLeft);
+	float right = tanf(fov.angleRight);
+	float up    = tanf(fov.angleUp);
+	float down  = tanf(fov.angleDown);
+
+	// Without gaze, the fovea is centered on the forward axis and made larger,
+	// since the user could be looking anywhere near it.
+	float radius;
+	{
+		std::lock_guard<std::mutex> guard(foveation.lock);
+		radius = tracked ? foveation.radius : foveation.config.radius * 1.5f;
+	}
+
+	float width  = (float)image_rect.extent.width;
+	float height = (float)image_rect.extent.height;
+	float cx = (tangent_x - left) / (right - left) * width;
+	float cy = (up - tangent_y)   / (up - down)    * height;
+	float rx = radius / (right - left) * width;
+	float ry = radius / (up - down)    * height;
+
+	// Align to 8 pixels so the rectangle doesn't shimmer by a pixel each frame
+	int32_t x0 = (int32_t)floorf((cx - rx) / 8.0f) * 8;
+	int32_t y0 = (int32_t)floorf((cy - ry) / 8.0f) * 8;
+	int32_t x1 = (int32_t)ceilf ((cx + rx) / 8.0f) * 8;
+	int32_t y1 = (int32_t)ceilf ((cy + ry) / 8.0f) * 8;
+	x0 = x0 < 0 ? 0 : x0;  x1 = x1 > image_rect.extent.width  ? image_rect.extent.width  : x1;
+	y0 = y0 < 0 ? 0 : y0;  y1 = y1 > image_rect.extent.height ? image_rect.extent.height : y1;
+
+	map.periphery_scale = foveation.config.periphery_scale;
+	map.fovea.offset    = { image_rect.offset.x + x0, image_rect.offset.y + y0 };
+	map.fovea.extent    = { x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0 };
+
+	// A fovea covering most of the image saves nothing over a single pass
+	float area   = (float)map.fovea.extent.width * map.fovea.extent.height / (width * height);
+	map.foveated = area <= foveation.config.max_fovea_area;
+
+	std::lock_guard<std::mutex> guard(foveation.lock);
+	foveation.stats.maps++;
+	if (map.foveated) {
+		foveation.stats.foveated++;
+		foveation.stats.fovea_area_sum += area;
+	}
+}
+
+void foveation_report(const foveation_t& foveation) {
+	if (!foveation.enabled)
+		return;
+
+	const foveation_stats_t& stats = foveation.stats;
+	double fovea  = stats.foveated ? stats.fovea_area_sum / stats.foveated : 1.0;
+	double scale  = foveation.config.periphery_scale;
+	// Full rate inside the fovea, plus the whole image again at periphery resolution
+	double shaded = stats.foveated ? fovea + scale * scale : 1.0;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Foveation: %llu of %llu views foveated, avg fovea %.0f%% of the image, ~%.0f%% of full-rate pixel shading; %llu channel + %llu eye gaze samples, %llu saccades\n",
+		(unsigned long long)stats.foveated, (unsigned long long)stats.maps, fovea * 100.0, shaded * 100.0,
+		(unsigned long long)stats.samples[foveation_source_channel], (unsigned long long)stats.samples[foveation_source_eye_gaze],
+		(unsigned long long)stats.saccades);
+	foveation_log(text);
+}
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <mutex>
+
+// Gaze-driven foveation. Gaze samples come from the streaming client over the
+// opaque data channel (foveation_hint_message_t), or from
+// XR_EXT_eye_gaze_interaction. Each eye's gaze is kept as tangents of the
+// angle from that eye's forward axis, x right and y up, which makes it
+// independent of resolution and field of view.
+//
+// Samples run through an alpha-beta filter, which smooths fixation jitter,
+// snaps to saccades instead of lagging behind them, and predicts ahead to
+// display time. foveation_make_map then turns the predicted gaze into a
+// full-rate fovea rectangle for one eye's image; everything outside it may
+// be shaded at a reduced rate.
+//
+// There are no graphics dependencies here, so the filter and region math can
+// be exercised on any platform.
+
+#define FOVEATION_MAX_EYES      2
+#define FOVEATION_HINT_MAGIC    0x484F5646 // 'FVOH'
+#define FOVEATION_HINT_VERSION  1
+#define FOVEATION_MAX_TANGENT   4.0f // About 76 degrees off axis, past any headset's field of view
+
+// Foveation hint from the streaming client. Little endian, tightly packed.
+#pragma pack(push, 1)
+typedef struct foveation_hint_message_t {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t eye_count;                     // 1 for mono, 2 for stereo
+	float    tangent[FOVEATION_MAX_EYES][2]; // Gaze per eye, as above
+	float    radius;                        // Foveal radius in tangent units, 0 for the default
+} foveation_hint_message_t;
+#pragma pack(pop)
+
+enum foveation_source_t {
+	foveation_source_channel = 0, // Hints from the streaming client, preferred
+	foveation_source_eye_gaze,    // XR_EXT_eye_gaze_interaction
+};
+
+typedef struct foveation_config_t {
+	float  radius;            // Default foveal radius, in tangent units
+	float  periphery_scale;   // Linear resolution of the periphery pass
+	float  alpha;             // Filter position gain
+	float  beta;              // Filter velocity gain
+	float  saccade_threshold; // Residual, in tangent units, that counts as a saccade
+	float  max_speed;         // Velocity clamp, tangent units per second
+	double max_horizon_s;     // Furthest the filter will predict ahead
+	double stale_s;           // Samples older than this are ignored
+	float  max_fovea_area;    // Skip foveation when the fovea would cover more than this
+} foveation_config_t;
+
+typedef struct foveation_eye_t {
+	bool   valid;
+	double time_s;
+	float  position[2];
+	float  velocity[2];
+} foveation_eye_t;
+
+typedef struct foveation_stats_t {
+	uint64_t samples[2]; // Per foveation_source_t
+	uint64_t saccades;
+	uint64_t maps;
+	uint64_t foveated;
+	double   fovea_area_sum; // Fraction of the image at full rate, summed over foveated maps
+} foveation_stats_t;
+
+// Full-rate region for one eye's image, in pixels of the swapchain image
+typedef struct foveation_map_t {
+	bool      foveated;       // False when the whole image should be shaded at full rate
+	XrRect2Di fovea;
+	float     periphery_scale;
+} foveation_map_t;
+
+typedef struct foveation_t {
+	bool               enabled;
+	foveation_config_t config;
+	std::mutex         lock;   // Samples arrive on channel and frame threads
+	foveation_eye_t    eyes[FOVEATION_MAX_EYES];
+	float              radius;
+	double             channel_time_s;
+	foveation_stats_t  stats;
+} foveation_t;
+
+foveation_config_t foveation_default_config();
+void foveation_init(foveation_t& foveation, const foveation_config_t& config);
+
+// Returns false if the message isn't a foveation hint, or holds a non-finite
+// value. Tangents are clamped to +-FOVEATION_MAX_TANGENT and the radius to
+// FOVEATION_MAX_TANGENT, so a bad client can't push the fovea to infinity.
+bool foveation_parse_hint(const uint8_t* data, uint32_t size, foveation_hint_message_t& hint);
+void foveation_add_hint(foveation_t& foveation, const foveation_hint_message_t& hint, double time_s);
+
+// Eye gaze samples are ignored while channel hints are fresh
+void foveation_add_sample(foveation_t& foveation, foveation_source_t source, uint32_t eye, float tangent_x, float tangent_y, double time_s);
+
+// Gaze direction of gaze_pose (looking down its -Z axis), as tangents in the
+// space of eye_pose. Returns false if the gaze points away from the eye's
+// forward hemisphere.
+bool foveation_pose_to_tangent(const XrPosef& eye_pose, const XrPosef& gaze_pose, float& tangent_x, float& tangent_y);
+
+// Predicted gaze at time_s. Falls back to straight ahead with no fresh samples.
+bool foveation_predict(foveation_t& foveation, uint32_t eye, double time_s, float& tangent_x, float& tangent_y);
+
+void foveation_make_map(foveation_t& foveation, uint32_t eye, double time_s, const XrFovf& fov, const XrRect2Di& image_rect, foveation_map_t& map);
+
+void foveation_report(const foveation_t& foveation);
@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "FrameArena.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+struct frame_arena_t {
+	uint8_t*           memory;
+	size_t             capacity;
+	size_t             offset;
+	std::vector<void*> overflow; // Heap fallbacks, freed when the arena resets
+};
+
+uint32_t            frame_arena_warmup_frames = 90;
+frame_arena_stats_t frame_arena_stats         = {};
+
+static frame_arena_t frame_arenas[2];
+static uint32_t      frame_arena_current = 0;
+static uint64_t      frame_arena_frame   = 0;
+static uint64_t      frame_arena_heap_at_begin = 0;
+
+#if FRAME_ARENA_TRACK_HEAP
+static thread_local uint64_t frame_arena_thread_heap_allocs = 0;
+#endif
+
+static void frame_arena_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static void frame_arena_free_overflow(void* memory) {
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+static void frame_arena_reset(frame_arena_t& arena) {
+	for (size_t i = 0; i < arena.overflow.size(); i++)
+		frame_arena_free_overflow(arena.overflow[i]);
+	arena.overflow.clear();
+	arena.offset = 0;
+}
+
+uint64_t frame_arena_heap_alloc_count() {
+#if FRAME_ARENA_TRACK_HEAP
+	return frame_arena_thread_heap_allocs;
+#else
+	return 0;
+#endif
+}
+
+void frame_arena_init(size_t bytes_per_frame) {
+	for (int32_t i = 0; i < 2; i++) {
+		frame_arenas[i].memory   = (uint8_t*)malloc(bytes_per_frame);
+		frame_arenas[i].capacity = frame_arenas[i].memory ? bytes_per_frame : 0;
+		frame_arenas[i].offset   = 0;
+		frame_arenas[i].overflow.reserve(64);
+	}
+	frame_arena_current = 0;
+	frame_arena_frame   = 0;
+	frame_arena_stats   = {};
+}
+
+void frame_arena_shutdown() {
+	for (int32_t i = 0; i < 2; i++) {
+		frame_arena_reset(frame_arenas[i]);
+		free(frame_arenas[i].memory);
+		frame_arenas[i] = {};
+	}
+}
+
+void frame_arena_begin_frame() {
+	frame_arena_current = (frame_arena_current + 1) & 1;
+	frame_arena_reset(frame_arenas[frame_arena_current]);
+	frame_arena_heap_at_begin = frame_arena_heap_alloc_count();
+}
+
+void frame_arena_end_frame() {
+	uint64_t heap_allocs = frame_arena_heap_alloc_count() - frame_arena_heap_at_begin;
+	if (frame_arena_frame++ < frame_arena_warmup_frames || heap_allocs == 0)
+		return;
+
+	frame_arena_stats.heap_allocs += heap_allocs;
+	char text[128];
+	snprintf(text, sizeof(text), "Frame arena: %llu global heap allocations in steady-state frame %llu\n",
+		(unsigned long long)heap_allocs, (unsigned long long)frame_arena_frame);
+	frame_arena_log(text);
+	assert(heap_allocs == 0 && "Render path allocated from the global heap, use the frame arena");
+}
+
+void* frame_arena_alloc(size_t size, size_t align) {
+	frame_arena_t& arena = frame_arenas[frame_arena_current];
+
+	size_t start = (arena.offset + (align - 1)) & ~(align - 1);
+	if (start + size <= arena.capacity) {
+		arena.offset = start + size;
+		if (arena.offset > frame_arena_stats.high_water)
+			frame_arena_stats.high_water = arena.offset;
+		return arena.memory + start;
+	}
+
+	// Out of arena space. Debug builds stop here so the per-frame budget gets
+	// raised; release builds fall back to the heap for the rest of the frame.
+	frame_arena_stats.overflows++;
+	assert(false && "Frame arena overflow, raise the size passed to frame_arena_init");
+
+	void* memory = nullptr;
+#ifdef _WIN32
+	memory = _aligned_malloc(size, align < sizeof(void*) ? sizeof(void*) : align);
+#else
+	if (posix_memalign(&memory, align < sizeof(void*) ? sizeof(void*) : align, size) != 0)
+		memory = nullptr;
+#endif
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	arena.overflow.push_back(memory);
+	return memory;
+}
+
+void frame_arena_report() {
+	char text[192];
+	snprintf(text, sizeof(text), "Frame arena: %zu of %zu bytes high water, %llu overflows, %llu steady-state heap allocations\n",
+		frame_arena_stats.high_water, frame_arenas[0].capacity,
+		(unsigned long long)frame_arena_stats.overflows, (unsigned long long)frame_arena_stats.heap_allocs);
+	frame_arena_log(text);
+}
+
+#if FRAME_ARENA_TRACK_HEAP
+// Counting replacements for the global allocation functions. Array, sized and
+// nothrow forms all route through these.
+void* operator new(size_t size) {
+	frame_arena_thread_heap_allocs++;
+	void* memory = malloc(size ? size : 1);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	frame_arena_thread_heap_allocs++;
+	return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size)                                   { return operator new(size); }
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete  (void* memory) noexcept                         { free(memory); }
+void operator delete  (void* memory, size_t) noexcept                 { free(memory); }
+void operator delete  (void* memory, const std::nothrow_t&) noexcept  { free(memory); }
+void operator delete[](void* memory) noexcept                         { free(memory); }
+void operator delete[](void* memory, size_t) noexcept                 { free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept  { free(memory); }
+#endif
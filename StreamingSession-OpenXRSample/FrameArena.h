@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Per-frame linear allocator for the render path. There are two arenas, and
+// frame_arena_begin_frame, called right after xrBeginFrame, flips between
+// them and resets the new one. So anything allocated during frame N stays
+// valid until frame N+2 begins. Deallocation is a no-op.
+//
+// The arenas belong to the render thread and are not thread safe.
+
+// Debug builds count every global operator new made by the render thread, and
+// once frames reach steady state they assert that a frame made none.
+#if defined(_DEBUG) && !defined(FRAME_ARENA_TRACK_HEAP)
+#define FRAME_ARENA_TRACK_HEAP 1
+#endif
+
+typedef struct frame_arena_stats_t {
+	size_t   high_water;      // Largest number of bytes used by one frame
+	uint64_t overflows;       // Allocations that didn't fit and went to the heap
+	uint64_t heap_allocs;     // Global heap allocations seen in steady-state frames
+} frame_arena_stats_t;
+
+extern uint32_t            frame_arena_warmup_frames;
+extern frame_arena_stats_t frame_arena_stats;
+
+void  frame_arena_init(size_t bytes_per_frame);
+void  frame_arena_shutdown();
+void  frame_arena_begin_frame();
+// Checks the heap allocation counter for the frame that just ended
+void  frame_arena_end_frame();
+void* frame_arena_alloc(size_t size, size_t align);
+void  frame_arena_report();
+
+// Global operator new calls made by the calling thread so far. Always 0 when
+// FRAME_ARENA_TRACK_HEAP is off.
+uint64_t frame_arena_heap_alloc_count();
+
+// STL allocator adapter over the current frame arena
+template <typename T>
+struct frame_allocator_t {
+	typedef T value_type;
+
+	frame_allocator_t() = default;
+	template <typename U> frame_allocator_t(const frame_allocator_t<U>&) {}
+
+	T*   allocate(size_t count)     { return (T*)frame_arena_alloc(count * sizeof(T), alignof(T)); }
+	void deallocate(T*, size_t)     {}
+
+	template <typename U> bool operator==(const frame_allocator_t<U>&) const { return true; }
+	template <typename U> bool operator!=(const frame_allocator_t<U>&) const { return false; }
+};
+
+template <typename T>
+using frame_vector = std::vector<T, frame_allocator_t<T>>;
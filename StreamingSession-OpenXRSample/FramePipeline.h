@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ThreadPolicy.h"
+
+// Single producer, single consumer triple buffer. The producer fills back()
+// and publishes it; the consumer picks up the most recently published slot
+// with acquire() and reads it through front(). Neither side ever blocks or
+// sees a slot the other side is still using.
+template <typename T>
+struct triple_buffer_t {
+	T& back()  { return slots[back_index]; }
+	T& front() { return slots[front_index]; }
+
+	void publish() {
+		uint32_t previous = middle.exchange(back_index | dirty_bit, std::memory_order_acq_rel);
+		back_index = previous & index_mask;
+	}
+
+	bool has_new() const {
+		return (middle.load(std::memory_order_acquire) & dirty_bit) != 0;
+	}
+
+	// Returns false if nothing was published since the last acquire
+	bool acquire() {
+		if (!has_new())
+			return false;
+		uint32_t previous = middle.exchange(front_index, std::memory_order_acq_rel);
+		front_index = previous & index_mask;
+		return true;
+	}
+
+private:
+	static const uint32_t dirty_bit  = 4;
+	static const uint32_t index_mask = 3;
+
+	T                     slots[3]   = {};
+	uint32_t              back_index = 0;
+	std::atomic<uint32_t> middle{1};
+	uint32_t              front_index = 2;
+};
+
+// Hands frames from the frame thread (xrWaitFrame + simulation) to a render
+// thread (xrBeginFrame, rendering, xrEndFrame). Frame data only ever moves
+// through the triple buffer. The mutex and condition variables are just the
+// doorbell that lets the render thread sleep while there is nothing to do.
+//
+// xrWaitFrame for frame N+1 doesn't return until xrBeginFrame has been called
+// for frame N, so the frame thread can run at most one frame ahead and no
+// waited frame is ever overwritten before it is begun.
+template <typename T>
+struct frame_pipeline_t {
+	typedef void (*render_fn_t)(T& frame);
+
+	void start(render_fn_t render_fn, thread_role_t role) {
+		render  = render_fn;
+		running = true;
+		thread  = std::thread([this, role]() {
+			thread_policy_apply(role);
+			render_loop();
+		});
+	}
+
+	// Frame thread: fill back(), then publish()
+	T& back() { return frames.back(); }
+
+	void publish() {
+		frames.publish();
+		{ std::lock_guard<std::mutex> lock(doorbell_lock); }
+		doorbell.notify_one();
+	}
+
+	// Blocks until every published frame has been rendered and submitted.
+	// Needed before xrEndSession, which must not race an in-flight frame.
+	void flush() {
+		if (!running)
+			return;
+		std::unique_lock<std::mutex> lock(doorbell_lock);
+		idle.wait(lock, [this]() { return !frames.has_new() && !rendering; });
+	}
+
+	void stop() {
+		if (!thread.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(doorbell_lock);
+			running = false;
+		}
+		doorbell.notify_one();
+		thread.join();
+	}
+
+private:
+	void render_loop() {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(doorbell_lock);
+				doorbell.wait(lock, [this]() { return !running || frames.has_new(); });
+				if (!frames.has_new())
+					break;
+				rendering = true;
+			}
+
+			frames.acquire();
+			render(frames.front());
+
+			{
+				std::lock_guard<std::mutex> lock(doorbell_lock);
+				rendering = false;
+			}
+			idle.notify_all();
+		}
+	}
+
+	triple_buffer_t<T>      frames;
+	render_fn_t             render    = nullptr;
+	std::thread             thread;
+	std::mutex              doorbell_lock;
+	std::condition_variable doorbell;
+	std::condition_variable idle;
+	bool                    running   = false;
+	bool                    rendering = false;
+};
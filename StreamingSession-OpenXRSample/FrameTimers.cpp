@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "FrameTimers.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+uint32_t frame_timers_report_interval_s = 5;
+
+// Log-linear histogram: values below 2^sub_bits ticks get their own bucket,
+// and every power of two above that is split into 2^sub_bits buckets. The
+// error is bounded to about 6%, across the range from a few ticks to minutes.
+static const int32_t frame_hist_sub_bits    = 4;
+static const int32_t frame_hist_sub_count   = 1 << frame_hist_sub_bits;
+static const int32_t frame_hist_bucket_count = (64 - frame_hist_sub_bits + 1) * frame_hist_sub_count;
+
+struct frame_histogram_t {
+	uint32_t buckets[frame_hist_bucket_count];
+	uint32_t count;
+	uint64_t max;
+};
+
+static const char* frame_phase_names[frame_phase_count] = {
+	"message_pump",
+	"wait_frame",
+	"begin_frame",
+	"locate_views",
+	"swapchain",
+	"render_layer",
+	"end_frame",
+	"spectator",
+	"frame",
+};
+
+static frame_histogram_t frame_histograms[frame_phase_count];
+static uint64_t          frame_phase_ticks[frame_phase_count];
+static bool              frame_phase_touched[frame_phase_count];
+static uint64_t          frame_begin_ticks;
+static uint32_t          frame_count;
+
+// Tick rate calibration. frame_timers_init measures the tick rate against
+// steady_clock over frame_calibration_ms, and every report refines it over
+// the whole time since init.
+static const double                          frame_calibration_ms = 10.0;
+static uint64_t                              frame_calibration_ticks;
+static std::chrono::steady_clock::time_point frame_calibration_time;
+static uint64_t                              frame_report_start_ticks;
+static double                                frame_ticks_per_ms;
+
+static void frame_timers_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static inline int32_t frame_hist_msb(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (int32_t)index;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+static inline int32_t frame_hist_index(uint64_t value) {
+	if (value < (uint64_t)frame_hist_sub_count)
+		return (int32_t)value;
+	int32_t shift = frame_hist_msb(value) - frame_hist_sub_bits;
+	return (shift + 1) * frame_hist_sub_count + (int32_t)((value >> shift) & (frame_hist_sub_count - 1));
+}
+
+// Lower bound of a bucket, in ticks
+static inline uint64_t frame_hist_value(int32_t index) {
+	if (index < frame_hist_sub_count)
+		return (uint64_t)index;
+	int32_t shift = index / frame_hist_sub_count - 1;
+	uint64_t sub  = (uint64_t)(index % frame_hist_sub_count) | (uint64_t)frame_hist_sub_count;
+	return sub << shift;
+}
+
+static uint64_t frame_hist_percentile(const frame_histogram_t& hist, double percentile) {
+	if (hist.count == 0)
+		return 0;
+	uint64_t target = (uint64_t)(percentile * hist.count + 0.5);
+	if (target < 1) target = 1;
+	uint64_t seen = 0;
+	for (int32_t i = 0; i < frame_hist_bucket_count; i++) {
+		seen += hist.buckets[i];
+		if (seen >= target)
+			return frame_hist_value(i);
+	}
+	return hist.max;
+}
+
+static double frame_timers_ticks_per_ms() {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double elapsed_ms = std::chrono::duration<double, std::milli>(now - frame_calibration_time).count();
+	uint64_t elapsed_ticks = frame_timer_now() - frame_calibration_ticks;
+#if FRAME_TIMERS_USE_TSC
+	// Too short an interval is dominated by when each clock was sampled, so
+	// keep the init calibration until there is a longer one
+	if (elapsed_ms < frame_calibration_ms || elapsed_ticks == 0)
+		return frame_ticks_per_ms;
+	return (double)elapsed_ticks / elapsed_ms;
+#else
+	(void)elapsed_ms;
+	(void)elapsed_ticks;
+	return (double)std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num / 1000.0;
+#endif
+}
+
+void frame_timers_init() {
+	memset(frame_histograms,    0, sizeof(frame_histograms));
+	memset(frame_phase_ticks,   0, sizeof(frame_phase_ticks));
+	memset(frame_phase_touched, 0, sizeof(frame_phase_touched));
+	frame_count              = 0;
+	frame_calibration_time   = std::chrono::steady_clock::now();
+	frame_calibration_ticks  = frame_timer_now();
+
+#if FRAME_TIMERS_USE_TSC
+	// The TSC rate isn't reported anywhere portable, so spin for a known
+	// interval and count ticks. Runs once, before the first frame.
+	std::chrono::steady_clock::time_point now;
+	do {
+		now = std::chrono::steady_clock::now();
+	} while (std::chrono::duration<double, std::milli>(now - frame_calibration_time).count() < frame_calibration_ms);
+	frame_ticks_per_ms = (double)(frame_timer_now() - frame_calibration_ticks) / std::chrono::duration<double, std::milli>(now - frame_calibration_time).count();
+#else
+	frame_ticks_per_ms = frame_timers_ticks_per_ms();
+#endif
+	frame_report_start_ticks = frame_timer_now();
+	frame_begin_ticks        = frame_calibration_ticks;
+}
+
+void frame_timers_begin_frame() {
+	memset(frame_phase_ticks,   0, sizeof(frame_phase_ticks));
+	memset(frame_phase_touched, 0, sizeof(frame_phase_touched));
+	frame_begin_ticks = frame_timer_now();
+}
+
+void frame_timers_add(frame_phase_t phase, uint64_t ticks) {
+	frame_phase_ticks  [phase] += ticks;
+	frame_phase_touched[phase]  = true;
+}
+
+void frame_timers_end_frame() {
+	uint64_t now = frame_timer_now();
+	frame_timers_add(frame_phase_frame, now - frame_begin_ticks);
+
+	for (int32_t i = 0; i < frame_phase_count; i++) {
+		if (!frame_phase_touched[i])
+			continue;
+		frame_histogram_t& hist = frame_histograms[i];
+		uint64_t ticks = frame_phase_ticks[i];
+		hist.buckets[frame_hist_index(ticks)]++;
+		hist.count++;
+		if (ticks > hist.max) hist.max = ticks;
+	}
+	frame_count++;
+
+	// Rough interval check against the previous calibration, the precise tick
+	// rate is only needed when printing.
+	if (frame_timers_report_interval_s > 0) {
+		if ((double)(now - frame_report_start_ticks) >= frame_ticks_per_ms * 1000.0 * frame_timers_report_interval_s)
+			frame_timers_report();
+	}
+}
+
+void frame_timers_report() {
+	frame_ticks_per_ms  = frame_timers_ticks_per_ms();
+	double ticks_per_ms = frame_ticks_per_ms;
+	double seconds      = (double)(frame_timer_now() - frame_report_start_ticks) / ticks_per_ms / 1000.0;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Frame timing over %.1f s, %u frames (ms):\n", seconds, frame_count);
+	frame_timers_log(text);
+	for (int32_t i = 0; i < frame_phase_count; i++) {
+		const frame_histogram_t& hist = frame_histograms[i];
+		if (hist.count == 0)
+			continue;
+		snprintf(text, sizeof(text), "  %-13s p50 %7.3f  p95 %7.3f  p99 %7.3f  max %7.3f\n",
+			frame_phase_names[i],
+			frame_hist_percentile(hist, 0.50) / ticks_per_ms,
+			frame_hist_percentile(hist, 0.95) / ticks_per_ms,
+			frame_hist_percentile(hist, 0.99) / ticks_per_ms,
+			hist.max / ticks_per_ms);
+		frame_timers_log(text);
+	}
+
+	memset(frame_histograms, 0, sizeof(frame_histograms));
+	frame_count              = 0;
+	frame_report_start_ticks = frame_timer_now();
+}
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRAME_TIMERS_USE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+// CPU phases of one iteration of the frame loop. Time spent in each phase is
+// summed over the frame, then added to a rolling histogram per phase.
+enum frame_phase_t {
+	frame_phase_message_pump = 0, // Win32 messages, xrPollEvent and channel pump
+	frame_phase_wait_frame,       // xrWaitFrame
+	frame_phase_begin_frame,      // xrBeginFrame
+	frame_phase_locate_views,     // xrLocateViews
+	frame_phase_swapchain,        // xrAcquire/Wait/ReleaseSwapchainImage
+	frame_phase_render_layer,     // app_render_layer for every view
+	frame_phase_end_frame,        // xrEndFrame
+	frame_phase_spectator,        // window_present_vr_view
+	frame_phase_frame,            // The whole frame loop iteration
+	frame_phase_count,
+};
+
+extern uint32_t frame_timers_report_interval_s;
+
+// Raw timestamp, in ticks. rdtsc where available, since it costs a few
+// nanoseconds; steady_clock (QPC on Windows) everywhere else.
+inline uint64_t frame_timer_now() {
+#if FRAME_TIMERS_USE_TSC
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+void frame_timers_init();
+void frame_timers_begin_frame();
+void frame_timers_add(frame_phase_t phase, uint64_t ticks);
+// Commits this frame's phase totals to the histograms, and reports and
+// resets them once the report interval has elapsed.
+void frame_timers_end_frame();
+void frame_timers_report();
+
+struct frame_timer_scope_t {
+	frame_phase_t phase;
+	uint64_t      start;
+
+	explicit frame_timer_scope_t(frame_phase_t phase) : phase(phase), start(frame_timer_now()) {}
+	~frame_timer_scope_t() { frame_timers_add(phase, frame_timer_now() - start); }
+
+	frame_timer_scope_t(const frame_timer_scope_t&) = delete;
+	frame_timer_scope_t& operator=(const frame_timer_scope_t&) = delete;
+};
@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Drives the DynamicResolution.cpp controller with synthetic frame time
+// traces: a GPU whose cost grows with pixel count, with a little noise.
+
+#include "DynamicResolution.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static int32_t test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+static const float test_period_ms = 1000.0f / 90.0f;
+
+typedef struct test_trace_t {
+	float    full_ms;  // GPU time at scale 1
+	float    noise;    // Relative, uniform either way
+	uint32_t seed;
+	float    min_seen;
+	float    max_seen;
+	float    largest_step; // Largest relative change in area between frames
+} test_trace_t;
+
+static float test_random(uint32_t& seed) {
+	seed = seed * 1664525u + 1013904223u;
+	return (seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+}
+
+// Renders frames at the controller's scale and feeds their cost back
+static float test_run(dynres_t& dynres, test_trace_t& trace, uint32_t frames) {
+	for (uint32_t i = 0; i < frames; i++) {
+		float scale  = dynres.scale;
+		float gpu_ms = trace.full_ms * scale * scale * (1.0f + trace.noise * test_random(trace.seed));
+		float next   = dynres_update(dynres, gpu_ms, 2.0f, test_period_ms);
+		float step   = fabsf(next * next / (scale * scale) - 1.0f);
+		if (step > trace.largest_step) trace.largest_step = step;
+		if (next < trace.min_seen)     trace.min_seen     = next;
+		if (next > trace.max_seen)     trace.max_seen     = next;
+	}
+	return dynres.scale;
+}
+
+static void test_init(dynres_t& dynres, test_trace_t& trace, float full_ms) {
+	dynres = {};
+	dynres_init(dynres, dynres_default_config());
+	trace          = {};
+	trace.full_ms  = full_ms;
+	trace.noise    = 0.02f;
+	trace.seed     = 0x2545F491;
+	trace.min_seen = dynres.scale;
+	trace.max_seen = dynres.scale;
+}
+
+// Where the default config wants the frame to land
+static float test_target_ms() {
+	return test_period_ms * dynres_default_config().budget;
+}
+
+static void test_overload() {
+	dynres_t     dynres;
+	test_trace_t trace;
+
+	// 40% over budget at full size: settles where the cost meets the target
+	test_init(dynres, trace, test_target_ms() * 1.4f);
+	float scale = test_run(dynres, trace, 300);
+	float ideal = sqrtf(1.0f / 1.4f);
+	TEST_CHECK(fabsf(scale - ideal) < 0.03f);
+	TEST_CHECK(trace.largest_step <= dynres.config.max_step + 1.0e-4f);
+
+	// And stays there
+	float settled_min = trace.max_seen, settled_max = trace.min_seen;
+	for (uint32_t i = 0; i < 300; i++) {
+		test_run(dynres, trace, 1);
+		if (dynres.scale < settled_min) settled_min = dynres.scale;
+		if (dynres.scale > settled_max) settled_max = dynres.scale;
+	}
+	TEST_CHECK(settled_max - settled_min < 0.05f);
+	TEST_CHECK(dynres.stats.frames == 600);
+}
+
+static void test_pinned() {
+	dynres_t     dynres;
+	test_trace_t trace;
+
+	// 4x over budget would need a scale of 0.5, below min_scale
+	test_init(dynres, trace, test_target_ms() * 4.0f);
+	float scale = test_run(dynres, trace, 600);
+	TEST_CHECK(scale == dynres.config.min_scale);
+	TEST_CHECK(trace.min_seen >= dynres.config.min_scale);
+
+	// Pinned the whole time, so the integral has leaked away instead of
+	// winding up
+	TEST_CHECK(fabsf(dynres.integral) < 0.01f);
+
+	// The load goes away: the scale leaves the limit at once
+	trace.full_ms = test_target_ms() * 0.8f;
+	test_run(dynres, trace, 3);
+	TEST_CHECK(dynres.scale > dynres.config.min_scale);
+	test_run(dynres, trace, 300);
+	TEST_CHECK(fabsf(dynres.scale - sqrtf(1.0f / 0.8f)) < 0.03f);
+}
+
+static void test_spike() {
+	dynres_t     dynres;
+	test_trace_t trace;
+	test_init(dynres, trace, test_target_ms());
+	trace.noise = 0.0f;
+	float before = test_run(dynres, trace, 100);
+	TEST_CHECK(fabsf(before - 1.0f) < 0.02f);
+
+	// One frame at 3x cost only drops the scale by max_step in area
+	float gpu_ms = trace.full_ms * before * before * 3.0f;
+	float after  = dynres_update(dynres, gpu_ms, 2.0f, test_period_ms);
+	TEST_CHECK(after * after >= before * before * (1.0f - dynres.config.max_step) - 1.0e-4f);
+	TEST_CHECK(dynres.stats.over_budget >= 1);
+
+	// and it comes back within a second
+	test_run(dynres, trace, 90);
+	TEST_CHECK(fabsf(dynres.scale - before) < 0.03f);
+}
+
+static void test_headroom() {
+	dynres_t     dynres;
+	test_trace_t trace;
+
+	// Plenty of headroom: supersamples, up to max_scale and no further
+	test_init(dynres, trace, test_target_ms() * 0.3f);
+	float scale = test_run(dynres, trace, 300);
+	TEST_CHECK(scale == dynres.config.max_scale);
+	TEST_CHECK(trace.max_seen <= dynres.config.max_scale);
+	TEST_CHECK(fabsf(dynres.integral) < 0.01f);
+
+	// Less headroom: settles above 1 where the cost meets the target
+	test_init(dynres, trace, test_target_ms() * 0.7f);
+	scale = test_run(dynres, trace, 300);
+	TEST_CHECK(scale > 1.0f && fabsf(scale - sqrtf(1.0f / 0.7f)) < 0.03f);
+}
+
+static void test_missing_samples() {
+	dynres_t dynres = {};
+	dynres_init(dynres, dynres_default_config());
+	float target = test_target_ms();
+
+	// No measurement at all leaves everything as it was
+	float scale = dynres.scale;
+	TEST_CHECK(dynres_update(dynres, 0.0f, 0.0f, test_period_ms) == scale);
+	TEST_CHECK(dynres_update(dynres, -1.0f, 0.0f, test_period_ms) == scale);
+	TEST_CHECK(dynres_update(dynres, target * 2.0f, 1.0f, 0.0f) == scale);
+	TEST_CHECK(dynres.stats.frames == 0 && dynres.integral == 0.0f);
+
+	// Without GPU timestamps the CPU time still counts
+	TEST_CHECK(dynres_update(dynres, 0.0f, target * 2.0f, test_period_ms) < scale);
+	TEST_CHECK(dynres.stats.frames == 1 && dynres.stats.over_budget == 1);
+
+	// A run of missing GPU samples in an overloaded trace doesn't upset it
+	test_trace_t trace;
+	test_init(dynres, trace, target * 1.4f);
+	for (uint32_t i = 0; i < 300; i++) {
+		if (i % 3 == 0)
+			dynres_update(dynres, 0.0f, 0.0f, test_period_ms);
+		else
+			test_run(dynres, trace, 1);
+	}
+	TEST_CHECK(fabsf(dynres.scale - sqrtf(1.0f / 1.4f)) < 0.03f);
+	TEST_CHECK(dynres.stats.frames == 200);
+}
+
+static void test_extent() {
+	dynres_t dynres = {};
+	dynres_init(dynres, dynres_default_config());
+	int32_t width, height;
+
+	// Rounded down to even
+	dynres.scale = 0.75f;
+	dynres_extent(dynres, 1833, 1921, 4096, 4096, width, height);
+	TEST_CHECK(width == 1374 && height == 1440);
+
+	// Supersampled, clamped to the swapchain
+	dynres.scale = 1.4f;
+	dynres_extent(dynres, 2000, 2000, 2400, 4096, width, height);
+	TEST_CHECK(width == 2400 && height == 2800);
+
+	// Never below 2 pixels
+	dynres.scale = 0.6f;
+	dynres_extent(dynres, 3, 1, 4096, 4096, width, height);
+	TEST_CHECK(width == 2 && height == 2);
+}
+
+int main() {
+	test_overload();
+	test_pinned();
+	test_spike();
+	test_headroom();
+	test_missing_samples();
+	test_extent();
+	if (test_failures > 0) {
+		fprintf(stderr, "%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("dynres_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Hint parsing, filter and fovea region math of Foveation.cpp, without a
+// headset or a GPU.
+
+#include "Foveation.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int32_t test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+static bool test_near(float a, float b, float tolerance = 1.0e-4f) {
+	return fabsf(a - b) <= tolerance;
+}
+
+static foveation_hint_message_t test_hint(float x, float y, float radius) {
+	foveation_hint_message_t hint = {};
+	hint.magic         = FOVEATION_HINT_MAGIC;
+	hint.version       = FOVEATION_HINT_VERSION;
+	hint.eye_count     = 2;
+	hint.tangent[0][0] = hint.tangent[1][0] = x;
+	hint.tangent[0][1] = hint.tangent[1][1] = y;
+	hint.radius        = radius;
+	return hint;
+}
+
+static bool test_parse(const foveation_hint_message_t& message, foveation_hint_message_t& hint) {
+	uint8_t data[sizeof(foveation_hint_message_t)];
+	memcpy(data, &message, sizeof(data));
+	return foveation_parse_hint(data, sizeof(data), hint);
+}
+
+static void test_parse_hint() {
+	foveation_hint_message_t hint;
+	TEST_CHECK( test_parse(test_hint(0.1f, -0.2f, 0.3f), hint));
+	TEST_CHECK(test_near(hint.tangent[0][0], 0.1f) && test_near(hint.tangent[0][1], -0.2f) && test_near(hint.radius, 0.3f));
+
+	// Too short, wrong magic, version or eye count
+	foveation_hint_message_t message = test_hint(0, 0, 0);
+	uint8_t data[sizeof(message)];
+	memcpy(data, &message, sizeof(data));
+	TEST_CHECK(!foveation_parse_hint(data, sizeof(data) - 1, hint));
+	message.magic = 0;                          TEST_CHECK(!test_parse(message, hint));
+	message = test_hint(0, 0, 0); message.version   = 2; TEST_CHECK(!test_parse(message, hint));
+	message = test_hint(0, 0, 0); message.eye_count = 0; TEST_CHECK(!test_parse(message, hint));
+	message = test_hint(0, 0, 0); message.eye_count = 3; TEST_CHECK(!test_parse(message, hint));
+
+	// Non-finite values are rejected outright
+	TEST_CHECK(!test_parse(test_hint(NAN, 0, 0), hint));
+	TEST_CHECK(!test_parse(test_hint(0, INFINITY, 0), hint));
+	TEST_CHECK(!test_parse(test_hint(0, 0, NAN), hint));
+	TEST_CHECK(!test_parse(test_hint(0, 0, -INFINITY), hint));
+
+	// Out of range values are clamped
+	TEST_CHECK(test_parse(test_hint(1.0e20f, -1.0e20f, 1.0e20f), hint));
+	TEST_CHECK(hint.tangent[0][0] == FOVEATION_MAX_TANGENT && hint.tangent[0][1] == -FOVEATION_MAX_TANGENT);
+	TEST_CHECK(hint.radius == FOVEATION_MAX_TANGENT);
+	TEST_CHECK(test_parse(test_hint(0, 0, -1.0f), hint));
+	TEST_CHECK(hint.radius == 0.0f);
+}
+
+static void test_filter() {
+	foveation_t foveation;
+	foveation_init(foveation, foveation_default_config());
+	float x, y;
+
+	// Nothing yet, so straight ahead
+	TEST_CHECK(!foveation_predict(foveation, 0, 1.0, x, y));
+	TEST_CHECK(x == 0.0f && y == 0.0f);
+
+	// The first sample is taken as is
+	foveation_add_sample(foveation, foveation_source_eye_gaze, 0, 0.1f, 0.0f, 1.0);
+	TEST_CHECK(foveation_predict(foveation, 0, 1.0, x, y));
+	TEST_CHECK(test_near(x, 0.1f) && test_near(y, 0.0f));
+
+	// A small step is smoothed: position moves alpha of the way
+	foveation_add_sample(foveation, foveation_source_eye_gaze, 0, 0.14f, 0.0f, 1.01);
+	TEST_CHECK(foveation_predict(foveation, 0, 1.01, x, y));
+	TEST_CHECK(test_near(x, 0.1f + foveation.config.alpha * 0.04f));
+	TEST_CHECK(foveation.stats.saccades == 0);
+
+	// Prediction runs along the velocity, up to the horizon
+	float vx = foveation.eyes[0].velocity[0];
+	TEST_CHECK(vx > 0.0f);
+	float base = foveation.eyes[0].position[0];
+	TEST_CHECK(foveation_predict(foveation, 0, 1.01 + 0.02, x, y));
+	TEST_CHECK(test_near(x, base + vx * 0.02f));
+	TEST_CHECK(foveation_predict(foveation, 0, 1.01 + 0.2, x, y));
+	TEST_CHECK(test_near(x, base + vx * (float)foveation.config.max_horizon_s));
+
+	// A jump past the threshold is a saccade, taken immediately
+	foveation_add_sample(foveation, foveation_source_eye_gaze, 0, -0.5f, 0.3f, 1.02);
+	TEST_CHECK(foveation.stats.saccades == 1);
+	TEST_CHECK(foveation_predict(foveation, 0, 1.02, x, y));
+	TEST_CHECK(test_near(x, -0.5f) && test_near(y, 0.3f));
+
+	// Stale samples fall back to straight ahead
+	TEST_CHECK(!foveation_predict(foveation, 0, 1.02 + foveation.config.stale_s + 0.01, x, y));
+
+	// Fresh channel hints win over eye gaze
+	foveation_add_hint(foveation, test_hint(0.2f, 0.2f, 0), 2.0);
+	foveation_add_sample(foveation, foveation_source_eye_gaze, 1, -0.3f, -0.3f, 2.01);
+	TEST_CHECK(foveation.stats.samples[foveation_source_eye_gaze] == 3);
+	TEST_CHECK(foveation_predict(foveation, 1, 2.0, x, y));
+	TEST_CHECK(test_near(x, 0.2f) && test_near(y, 0.2f));
+}
+
+static void test_make_map() {
+	foveation_t foveation;
+	foveation_init(foveation, foveation_default_config());
+
+	// 90 degrees each way, so tangents run from -1 to 1 across the image
+	const float quarter = 0.785398163f;
+	XrFovf      fov     = { -quarter, quarter, quarter, -quarter };
+	XrRect2Di   rect    = { { 16, 32 }, { 800, 800 } };
+
+	// Centered gaze, radius 0.25: 100 pixels each way, widened to 8 pixel steps
+	foveation_add_hint(foveation, test_hint(0, 0, 0.25f), 1.0);
+	foveation_map_t map = {};
+	foveation_make_map(foveation, 0, 1.0, fov, rect, map);
+	TEST_CHECK(map.foveated);
+	TEST_CHECK(map.fovea.offset.x == 16 + 296 && map.fovea.offset.y == 32 + 296);
+	TEST_CHECK(map.fovea.extent.width == 208 && map.fovea.extent.height == 208);
+	TEST_CHECK(map.periphery_scale == foveation.config.periphery_scale);
+
+	// Gaze in the top left corner, clipped to the image
+	foveation_add_hint(foveation, test_hint(-1.0f, 1.0f, 0.25f), 2.0);
+	foveation_make_map(foveation, 0, 2.0, fov, rect, map);
+	TEST_CHECK(map.fovea.offset.x == 16 && map.fovea.offset.y == 32);
+	TEST_CHECK(map.fovea.extent.width == 104 && map.fovea.extent.height == 104);
+
+	// A fovea over most of the image isn't worth a second pass
+	foveation_add_hint(foveation, test_hint(0, 0, 1.5f), 3.0);
+	foveation_make_map(foveation, 0, 3.0, fov, rect, map);
+	TEST_CHECK(!map.foveated);
+
+	// Without gaze, centered and half again the default radius
+	foveation_make_map(foveation, 0, 10.0, fov, rect, map);
+	TEST_CHECK(map.fovea.offset.x == 16 + 248 && map.fovea.extent.width == 304);
+
+	TEST_CHECK(foveation.stats.maps == 4 && foveation.stats.foveated == 3);
+}
+
+int main() {
+	test_parse_hint();
+	test_filter();
+	test_make_map();
+	if (test_failures > 0) {
+		fprintf(stderr, "%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("foveation_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Runs the sample's -bench benchmarks on any OS.
+// Usage: headless_bench <benchmark> [limit], with the defaults the flags use.
+
+#include "Culling.h"
+#include "DrawSort.h"
+#include "MessageChannel.h"
+#include "Transforms.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Defined by main.cpp in the sample, only used once a channel is created
+XrInstance xr_instance  = XR_NULL_HANDLE;
+XrSystemId xr_system_id = 0;
+
+typedef struct headless_bench_t {
+	const char* name;
+	const char* title;
+	bool      (*run)(uint32_t limit);
+	uint32_t    limit;
+} headless_bench_t;
+
+static const headless_bench_t headless_benches[] = {
+	{ "cull",       "Culling",   cull_benchmark,           100000  },
+	{ "transforms", "Transform", transform_benchmark,      1000000 },
+	{ "draw_sort",  "Draw sort", draw_sort_benchmark,      100000  },
+	{ "channel",    "Channel",   opaque_channel_benchmark, 100000  },
+};
+
+int main(int argc, char** argv) {
+	for (size_t i = 0; argc > 1 && i < sizeof(headless_benches) / sizeof(headless_benches[0]); i++) {
+		const headless_bench_t& bench = headless_benches[i];
+		if (strcmp(argv[1], bench.name) != 0)
+			continue;
+
+		uint32_t limit  = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : bench.limit;
+		bool     passed = bench.run(limit);
+		fprintf(stderr, "%s benchmark %s\n", bench.title, passed ? "passed" : "FAILED");
+		return passed ? 0 : 1;
+	}
+
+	fputs("Usage: headless_bench <benchmark> [limit], benchmark one of:", stderr);
+	for (size_t i = 0; i < sizeof(headless_benches) / sizeof(headless_benches[0]); i++)
+		fprintf(stderr, " %s", headless_benches[i].name);
+	fputs("\n", stderr);
+	return 2;
+}
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Schedules LateLatch.cpp against a simulated runtime whose head moves
+// between the early and the late locate.
+
+#include "LateLatch.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int32_t test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+// Each locate reports the head x mm further right, views 64 mm apart
+typedef struct test_runtime_t {
+	float    head_x;       // Meters
+	float    step;         // Movement per locate
+	bool     fail_next;    // The next locate fails
+	uint32_t calls;
+	uint32_t largest_view_count;
+	XrTime   last_time;
+} test_runtime_t;
+
+static bool test_locate(void* context, XrTime display_time, XrView* views, uint32_t view_count) {
+	test_runtime_t& runtime = *(test_runtime_t*)context;
+	runtime.calls++;
+	runtime.last_time = display_time;
+	if (view_count > runtime.largest_view_count)
+		runtime.largest_view_count = view_count;
+	if (runtime.fail_next) {
+		runtime.fail_next = false;
+		return false;
+	}
+
+	runtime.head_x += runtime.step;
+	for (uint32_t i = 0; i < view_count; i++) {
+		views[i].pose.orientation = { 0, 0, 0, 1 };
+		views[i].pose.position    = { runtime.head_x + 0.064f * i, 1.6f, 0 };
+	}
+	return true;
+}
+
+static void test_init(late_latch_t& latch, test_runtime_t& runtime) {
+	latch         = {};
+	runtime       = {};
+	runtime.step  = 0.002f;
+	latch.enabled = true;
+	latch.locate  = test_locate;
+	latch.context = &runtime;
+}
+
+static bool test_near(double a, double b) {
+	return fabs(a - b) < 1.0e-3;
+}
+
+static void test_latched() {
+	late_latch_t   latch;
+	test_runtime_t runtime;
+	test_init(latch, runtime);
+
+	XrView views[2] = {};
+	TEST_CHECK(late_latch_early(latch, 1000, views, 2));
+	TEST_CHECK(test_near(views[0].pose.position.x, 0.002));
+	TEST_CHECK(late_latch_latch(latch, views));
+
+	// The fresher pose replaces the early one, at the same display time
+	TEST_CHECK(test_near(views[0].pose.position.x, 0.004) && test_near(views[1].pose.position.x, 0.068));
+	TEST_CHECK(test_near(latch.early[0].pose.position.x, 0.002));
+	TEST_CHECK(runtime.calls == 2 && runtime.last_time == 1000);
+	TEST_CHECK(latch.stats.frames == 1 && latch.stats.latched == 1 && latch.stats.compared == 1);
+	TEST_CHECK(test_near(latch.stats.translation_mm_sum, 4.0) && test_near(latch.stats.rotation_deg_sum, 0.0));
+}
+
+static void test_rejected() {
+	late_latch_t   latch;
+	test_runtime_t runtime;
+	test_init(latch, runtime);
+
+	XrView views[2] = {};
+	TEST_CHECK(late_latch_early(latch, 1000, views, 2));
+	runtime.fail_next = true;
+	TEST_CHECK(!late_latch_latch(latch, views));
+
+	// The early pose stays, and nothing counts as latched
+	TEST_CHECK(test_near(views[0].pose.position.x, 0.002) && test_near(views[1].pose.position.x, 0.066));
+	TEST_CHECK(latch.stats.rejected == 1 && latch.stats.latched == 0 && latch.stats.compared == 0);
+	TEST_CHECK(latch.stats.translation_mm_sum == 0.0);
+}
+
+static void test_invalid_early() {
+	late_latch_t   latch;
+	test_runtime_t runtime;
+	test_init(latch, runtime);
+
+	// A valid frame first, so stale early poses are around
+	XrView views[2] = {};
+	late_latch_early(latch, 1000, views, 2);
+	late_latch_latch(latch, views);
+	double translation = latch.stats.translation_mm_sum;
+
+	runtime.fail_next = true;
+	TEST_CHECK(!late_latch_early(latch, 2000, views, 2));
+	TEST_CHECK(!latch.early_valid);
+
+	// Latching still works, but there's nothing to compare it with
+	TEST_CHECK(late_latch_latch(latch, views));
+	TEST_CHECK(runtime.last_time == 2000);
+	TEST_CHECK(latch.stats.latched == 2 && latch.stats.compared == 1);
+	TEST_CHECK(latch.stats.translation_mm_sum == translation);
+}
+
+static void test_view_count() {
+	late_latch_t   latch;
+	test_runtime_t runtime;
+	test_init(latch, runtime);
+
+	// More views than fit are cut to LATE_LATCH_MAX_VIEWS, and the runtime is
+	// never asked for more
+	XrView views[LATE_LATCH_MAX_VIEWS + 2] = {};
+	views[LATE_LATCH_MAX_VIEWS].pose.position.x = -1.0f;
+	TEST_CHECK(late_latch_early(latch, 1000, views, LATE_LATCH_MAX_VIEWS + 2));
+	TEST_CHECK(latch.view_count == LATE_LATCH_MAX_VIEWS);
+	TEST_CHECK(late_latch_latch(latch, views));
+	TEST_CHECK(runtime.largest_view_count == LATE_LATCH_MAX_VIEWS);
+	TEST_CHECK(views[LATE_LATCH_MAX_VIEWS].pose.position.x == -1.0f);
+	TEST_CHECK(test_near(views[LATE_LATCH_MAX_VIEWS - 1].pose.position.x, 0.004 + 0.064 * (LATE_LATCH_MAX_VIEWS - 1)));
+}
+
+static void test_disabled() {
+	late_latch_t   latch;
+	test_runtime_t runtime;
+	test_init(latch, runtime);
+	latch.enabled = false;
+
+	// The early locate still runs, the late one never does
+	XrView views[2] = {};
+	TEST_CHECK(late_latch_early(latch, 1000, views, 2));
+	TEST_CHECK(!late_latch_latch(latch, views));
+	TEST_CHECK(runtime.calls == 1);
+	TEST_CHECK(test_near(views[0].pose.position.x, 0.002));
+	TEST_CHECK(latch.stats.frames == 1 && latch.stats.latched == 0 && latch.stats.rejected == 0);
+}
+
+int main() {
+	test_latched();
+	test_rejected();
+	test_invalid_early();
+	test_view_count();
+	test_disabled();
+	if (test_failures > 0) {
+		fprintf(stderr, "%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("late_latch_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Drives RenderBackend.cpp through the null and recording backends: redundant
+// state filtering, invalidation, and recording, replay and comparison of
+// command streams.
+
+#include "RenderBackend.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int32_t test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+// Stand-ins for resources, only ever compared
+static const int test_objects[8] = {};
+#define TEST_HANDLE(i) ((render_handle_t)&test_objects[i])
+
+// One frame of the kind of stream app_draw issues
+static void test_draw_frame(render_context_t& context) {
+	const float   clear[4] = { 0.1f, 0.2f, 0.3f, 1.0f };
+	render_rect_t rect     = { 0, 0, 1920, 1080 };
+	float         constants[4] = { 1, 2, 3, 4 };
+
+	render_clear             (context, TEST_HANDLE(0), TEST_HANDLE(1), clear);
+	render_set_targets       (context, TEST_HANDLE(0), TEST_HANDLE(1));
+	render_set_viewport      (context, rect);
+	render_set_pipeline      (context, TEST_HANDLE(2));
+	render_update_constants  (context, TEST_HANDLE(3), constants, sizeof(constants));
+	render_set_constants     (context, render_stage_vertex | render_stage_pixel, 0, TEST_HANDLE(3));
+	render_set_vertex_buffer (context, TEST_HANDLE(4), 24);
+	render_set_index_buffer  (context, TEST_HANDLE(5), 2);
+	render_set_instance_buffer(context, TEST_HANDLE(6), 64);
+	render_draw_indexed      (context, 36, 3);
+	// Second draw with the same state, every bind dropped
+	render_set_pipeline      (context, TEST_HANDLE(2));
+	render_set_vertex_buffer (context, TEST_HANDLE(4), 24);
+	render_set_index_buffer  (context, TEST_HANDLE(5), 2);
+	render_set_instance_buffer(context, TEST_HANDLE(6), 64);
+	render_draw_indexed      (context, 36, 2, 3);
+	render_end_frame(context);
+}
+
+static void test_redundant() {
+	render_context_t context;
+	render_init(context, render_null_backend());
+	test_draw_frame(context);
+	TEST_CHECK(context.stats.frames == 1);
+	TEST_CHECK(context.stats.redundant == 4);
+	TEST_CHECK(context.stats.commands[render_cmd_set_pipeline] == 1);
+	TEST_CHECK(context.stats.commands[render_cmd_draw_indexed] == 2);
+	TEST_CHECK(context.stats.constant_bytes == 16);
+
+	// The same buffer with another index size is a real change
+	render_set_index_buffer(context, TEST_HANDLE(5), 4);
+	TEST_CHECK(context.stats.commands[render_cmd_set_index_buffer] == 2);
+	render_set_index_buffer(context, TEST_HANDLE(5), 4);
+	TEST_CHECK(context.stats.commands[render_cmd_set_index_buffer] == 2);
+
+	// Likewise for strides
+	render_set_vertex_buffer(context, TEST_HANDLE(4), 32);
+	TEST_CHECK(context.stats.commands[render_cmd_set_vertex_buffer] == 2);
+
+	// Constants only send the stages that change
+	uint64_t redundant = context.stats.redundant;
+	render_set_constants(context, render_stage_vertex, 0, TEST_HANDLE(3));
+	TEST_CHECK(context.stats.redundant == redundant + 1);
+	render_set_constants(context, render_stage_vertex | render_stage_pixel, 0, TEST_HANDLE(7));
+	TEST_CHECK(context.stats.commands[render_cmd_set_constants] == 2);
+
+	// After invalidation nothing is assumed bound
+	render_invalidate(context);
+	render_set_pipeline(context, TEST_HANDLE(2));
+	render_set_index_buffer(context, TEST_HANDLE(5), 4);
+	TEST_CHECK(context.stats.commands[render_cmd_set_pipeline] == 2);
+	TEST_CHECK(context.stats.commands[render_cmd_set_index_buffer] == 3);
+
+	// Out of range slots are ignored
+	render_handle_t textures[3] = { TEST_HANDLE(0), TEST_HANDLE(1), TEST_HANDLE(2) };
+	render_set_textures(context, 0, 3, textures);
+	render_set_textures(context, RENDER_MAX_SLOTS - 1, 2, textures);
+	render_set_constants(context, render_stage_pixel, RENDER_MAX_SLOTS, TEST_HANDLE(3));
+	TEST_CHECK(context.stats.commands[render_cmd_set_textures] == 0);
+	TEST_CHECK(context.stats.commands[render_cmd_set_constants] == 2);
+}
+
+static void test_recording() {
+	render_recording_t recording = {};
+	render_context_t   context;
+	render_init(context, render_recording_backend(recording));
+	test_draw_frame(context);
+
+	TEST_CHECK(recording.commands.size() == 11);
+	TEST_CHECK(recording.data.size() == 16);
+	TEST_CHECK(render_recording_binds(recording) == 7);
+	TEST_CHECK(recording.commands[7].type == render_cmd_set_index_buffer && recording.commands[7].count == 2);
+	TEST_CHECK(recording.commands[10].type == render_cmd_draw_indexed && recording.commands[10].first == 3);
+
+	// Unset fields are zero, so streams compare equal field by field
+	const render_command_t& pipeline = recording.commands[3];
+	TEST_CHECK(pipeline.stages == 0 && pipeline.slot == 0 && pipeline.count == 0 && pipeline.handles[1] == nullptr);
+
+	// Replayed into a second recording, the stream is unchanged
+	render_recording_t copy      = {};
+	render_recording_replay(recording, render_recording_backend(copy));
+	TEST_CHECK(render_recording_equal(recording, copy));
+
+	// Forwarding records and executes each command once
+	render_recording_t forwarded = {};
+	render_recording_t outer     = {};
+	outer.forward = render_recording_backend(forwarded);
+	render_init(context, render_recording_backend(outer));
+	test_draw_frame(context);
+	TEST_CHECK(render_recording_equal(recording, outer) && render_recording_equal(recording, forwarded));
+
+	// A different constant upload makes the streams differ
+	copy.data[0] ^= 1;
+	TEST_CHECK(!render_recording_equal(recording, copy));
+
+	render_recording_clear(copy);
+	TEST_CHECK(copy.commands.empty() && copy.data.empty());
+}
+
+int main() {
+	test_redundant();
+	test_recording();
+	if (test_failures > 0) {
+		fprintf(stderr, "%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("render_backend_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Core masks of ThreadPolicy.cpp for made up topologies and for this machine,
+// read back from each role's thread, and the timer resolution ref-count.
+
+#include "ThreadPolicy.h"
+
+#include <stdio.h>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static int32_t test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+static uint64_t test_mask(thread_role_t role) {
+	return thread_policy_table[role].core_mask;
+}
+
+// Render and frame each own a whole core, which no other role may use
+static void test_check_pinned(const uint64_t* core_masks, uint32_t core_count) {
+	uint64_t render = test_mask(thread_role_render);
+	uint64_t frame  = test_mask(thread_role_frame);
+	uint64_t others = test_mask(thread_role_channel_io) | test_mask(thread_role_worker) | test_mask(thread_role_logger);
+	TEST_CHECK(render != 0 && frame != 0);
+	TEST_CHECK((render & frame) == 0);
+	TEST_CHECK(((render | frame) & others) == 0);
+
+	// Every sibling of a core the render or frame thread touches is theirs
+	for (uint32_t core = 0; core < core_count; core++) {
+		if (core_masks[core] & render) TEST_CHECK((core_masks[core] & render) == core_masks[core]);
+		if (core_masks[core] & frame)  TEST_CHECK((core_masks[core] & frame)  == core_masks[core]);
+	}
+}
+
+static void test_topologies() {
+	// 8 cores with 2 way SMT, siblings numbered n and n + 8 as on most x86
+	uint64_t smt[8];
+	for (uint32_t core = 0; core < 8; core++)
+		smt[core] = (1ull << core) | (1ull << (core + 8));
+	thread_policy_init_cores(smt, 8, 16);
+	test_check_pinned(smt, 8);
+	TEST_CHECK(test_mask(thread_role_render) == smt[1]);
+	TEST_CHECK(test_mask(thread_role_frame)  == smt[2]);
+	TEST_CHECK(test_mask(thread_role_channel_io) == smt[7] && test_mask(thread_role_logger) == smt[7]);
+	TEST_CHECK(test_mask(thread_role_worker) == (0xffffull & ~(smt[1] | smt[2])));
+
+	// Adjacent siblings, and no SMT at all
+	uint64_t adjacent[4] = { 0x3, 0xc, 0x30, 0xc0 };
+	thread_policy_init_cores(adjacent, 4, 8);
+	test_check_pinned(adjacent, 4);
+	uint64_t single[4] = { 0x1, 0x2, 0x4, 0x8 };
+	thread_policy_init_cores(single, 4, 4);
+	test_check_pinned(single, 4);
+
+	// Fewer than 4 cores, or no topology, leaves affinity to the OS
+	uint64_t few[3] = { 0x3, 0xc, 0x30 };
+	thread_policy_init_cores(few, 3, 6);
+	for (int32_t role = 0; role < thread_role_count; role++)
+		TEST_CHECK(test_mask((thread_role_t)role) == 0);
+	thread_policy_init_cores(nullptr, 0, 16);
+	for (int32_t role = 0; role < thread_role_count; role++)
+		TEST_CHECK(test_mask((thread_role_t)role) == 0);
+}
+
+#ifdef __linux__
+static uint64_t test_thread_affinity() {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+		return 0;
+	uint64_t mask = 0;
+	for (int32_t i = 0; i < 64 && i < CPU_SETSIZE; i++) {
+		if (CPU_ISSET(i, &set))
+			mask |= 1ull << i;
+	}
+	return mask;
+}
+
+// Applies each role of this machine's policy on its own thread, as the
+// sample does, and reads the affinity back
+static void test_apply() {
+	thread_policy_init();
+	uint64_t process = test_thread_affinity();
+	uint64_t applied[thread_role_count];
+	for (int32_t role = 0; role < thread_role_count; role++) {
+		std::thread thread([&applied, role]() {
+			thread_policy_apply((thread_role_t)role);
+			applied[role] = test_thread_affinity();
+		});
+		thread.join();
+	}
+
+	for (int32_t role = 0; role < thread_role_count; role++) {
+		uint64_t mask = test_mask((thread_role_t)role);
+		TEST_CHECK(applied[role] == (mask != 0 ? mask : process));
+	}
+	if (test_mask(thread_role_render) != 0) {
+		TEST_CHECK((applied[thread_role_render] & applied[thread_role_frame]) == 0);
+		TEST_CHECK(((applied[thread_role_render] | applied[thread_role_frame]) & (applied[thread_role_channel_io] | applied[thread_role_worker])) == 0);
+	}
+
+	// Disabled, a thread keeps the affinity it started with
+	thread_policy_enabled = false;
+	uint64_t unchanged = 0;
+	std::thread thread([&unchanged]() {
+		thread_policy_apply(thread_role_render);
+		unchanged = test_thread_affinity();
+	});
+	thread.join();
+	TEST_CHECK(unchanged == process);
+	thread_policy_enabled = true;
+}
+#endif
+
+static void test_timer() {
+	TEST_CHECK(thread_policy_timer_held() == 0);
+	thread_policy_timer_acquire();
+	thread_policy_timer_acquire();
+	TEST_CHECK(thread_policy_timer_held() == 2);
+	thread_policy_timer_release();
+	TEST_CHECK(thread_policy_timer_held() == 1);
+	thread_policy_timer_release();
+	TEST_CHECK(thread_policy_timer_held() == 0);
+
+	// An unmatched release is ignored rather than going negative
+	thread_policy_timer_release();
+	TEST_CHECK(thread_policy_timer_held() == 0);
+	thread_policy_timer_acquire();
+	TEST_CHECK(thread_policy_timer_held() == 1);
+	thread_policy_timer_release();
+}
+
+int main() {
+	test_topologies();
+#ifdef __linux__
+	test_apply();
+#endif
+	test_timer();
+	if (test_failures > 0) {
+		fprintf(stderr, "%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("thread_policy_test: all checks passed\n");
+	return 0;
+}
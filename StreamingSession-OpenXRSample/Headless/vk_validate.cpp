@@ -0,0 +1,223 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+// Renders a grid of the sample's cubes through vk_validate, with the sample's
+// SPIR-V, pipeline layout and push constants, on whatever device the Vulkan
+// loader finds. CMake points it at lavapipe when that is installed.
+//
+//   vk_validate <directory with cube.vert.spv and cube.frag.spv> [frames]
+
+#include "VulkanBackend.h"
+#include "Transforms.h"
+#include "Scene.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+static int32_t test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+#define TEST_GRID       3
+#define TEST_CUBES      (TEST_GRID * TEST_GRID)
+#define TEST_CLIP_NEAR  0.1f
+#define TEST_CLIP_FAR   50.0f
+
+// Push constants, laid out as cube.vert declares them
+typedef struct test_constants_t {
+	float tint[4];
+	float viewproj[4][4];
+} test_constants_t;
+
+typedef struct test_scene_t {
+	const char*       spirv_dir;
+	render_context_t* render;
+
+	render_handle_t   pipeline;
+	render_handle_t   vertex_buffer;
+	render_handle_t   index_buffer;
+	render_handle_t   instance_buffer;
+	render_handle_t   material_constants;
+	render_handle_t   view_constants;
+	uint32_t          index_count;
+
+	transform_t       transforms;
+	uint32_t          nodes[TEST_CUBES];
+	transform_trs_t   locals[TEST_CUBES];
+	scene_instance_t  instances[TEST_CUBES];
+	uint32_t          frames;
+} test_scene_t;
+
+// The sample's cube, 1 m across, with position, color and normal per vertex
+// and four vertices per face, so each face has its own normal
+static void test_build_cube(std::vector<float>& verts, std::vector<uint16_t>& inds) {
+	for (uint32_t face = 0; face < 6; face++) {
+		uint32_t axis = face / 2;
+		float    sign = face % 2 ? -1.0f : 1.0f;
+		uint16_t base = (uint16_t)(verts.size() / 9);
+		for (uint32_t corner = 0; corner < 4; corner++) {
+			float vert[9] = {};
+			vert[axis]           = 0.5f * sign;
+			vert[(axis + 1) % 3] = (corner == 1 || corner == 2 ? 0.5f : -0.5f) * sign;
+			vert[(axis + 2) % 3] = corner >= 2 ? 0.5f : -0.5f;
+			vert[3] = vert[4] = vert[5] = 0.95f;
+			vert[6 + axis] = sign;
+			verts.insert(verts.end(), vert, vert + 9);
+		}
+		const uint16_t quad[] = { 0, 1, 2, 0, 2, 3 };
+		for (uint16_t index : quad)
+			inds.push_back((uint16_t)(base + index));
+	}
+}
+
+// Right handed off center projection times the view, for row vectors, and
+// stored transposed like every matrix the shaders read. The view only
+// translates, vk_validate's pose doesn't rotate.
+static void test_view_proj(const XrCompositionLayerProjectionView& view, float viewproj[4][4]) {
+	const float n = TEST_CLIP_NEAR, f = TEST_CLIP_FAR;
+	const float l = n * tanf(view.fov.angleLeft),  r = n * tanf(view.fov.angleRight);
+	const float b = n * tanf(view.fov.angleDown),  t = n * tanf(view.fov.angleUp);
+	const float proj[4][4] = {
+		{ 2 * n / (r - l),   0,                 0,               0  },
+		{ 0,                 2 * n / (t - b),   0,               0  },
+		{ (r + l) / (r - l), (t + b) / (t - b), f / (n - f),     -1 },
+		{ 0,                 0,                 n * f / (n - f), 0  },
+	};
+	const float eye[3] = { view.pose.position.x, view.pose.position.y, view.pose.position.z };
+	for (uint32_t c = 0; c < 4; c++) {
+		for (uint32_t row = 0; row < 3; row++)
+			viewproj[c][row] = proj[row][c];
+		viewproj[c][3] = proj[3][c] - eye[0] * proj[0][c] - eye[1] * proj[1][c] - eye[2] * proj[2][c];
+	}
+}
+
+static bool test_init(void* context) {
+	test_scene_t& scene = *(test_scene_t*)context;
+
+	std::string dir = scene.spirv_dir;
+	std::vector<uint32_t> vert_code, frag_code;
+	if (!vk_load_spirv((dir + "/cube.vert.spv").c_str(), vert_code) || !vk_load_spirv((dir + "/cube.frag.spv").c_str(), frag_code))
+		return false;
+
+	// The same layout as app_init_vk
+	vk_pipeline_desc_t desc = {};
+	desc.vertex_code     = vert_code.data();
+	desc.vertex_size     = vert_code.size() * sizeof(uint32_t);
+	desc.fragment_code   = frag_code.data();
+	desc.fragment_size   = frag_code.size() * sizeof(uint32_t);
+	desc.vertex_stride   = sizeof(float) * 9;
+	desc.attributes[0]   = VK_FORMAT_R32G32B32_SFLOAT;
+	desc.attributes[1]   = VK_FORMAT_R32G32B32_SFLOAT;
+	desc.attributes[2]   = VK_FORMAT_R32G32B32_SFLOAT;
+	desc.attribute_count = 3;
+	desc.depth_test      = true;
+	desc.instance_stride = sizeof(scene_instance_t);
+	for (uint32_t i = 0; i < 4; i++)
+		desc.instance_attributes[i] = VK_FORMAT_R32G32B32A32_SFLOAT;
+	desc.instance_attribute_count = 4;
+	scene.pipeline = vk_create_pipeline(desc);
+
+	std::vector<float>    verts;
+	std::vector<uint16_t> inds;
+	test_build_cube(verts, inds);
+	scene.index_count        = (uint32_t)inds.size();
+	scene.vertex_buffer      = vk_create_buffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, verts.data(), verts.size() * sizeof(float));
+	scene.index_buffer       = vk_create_buffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT,  inds.data(),  inds.size()  * sizeof(uint16_t));
+	scene.instance_buffer    = vk_create_dynamic_buffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(scene.instances));
+	scene.material_constants = vk_create_push_constants(0, sizeof(test_constants_t::tint));
+	scene.view_constants     = vk_create_push_constants(sizeof(test_constants_t::tint), sizeof(test_constants_t::viewproj));
+
+	// A grid of cubes 1.2 m apart, centered where the sample puts its hero
+	transform_init(scene.transforms, transform_best_mode());
+	for (uint32_t i = 0; i < TEST_CUBES; i++) {
+		scene.locals[i] = transform_identity();
+		scene.locals[i].position[0] = ((float)(i % TEST_GRID) - (TEST_GRID - 1) * 0.5f) * 1.2f;
+		scene.locals[i].position[1] = ((float)(i / TEST_GRID) - (TEST_GRID - 1) * 0.5f) * 1.2f - 0.6f;
+		scene.locals[i].position[2] = -2.0f;
+		scene.locals[i].scale[0] = scene.locals[i].scale[1] = scene.locals[i].scale[2] = 0.7f;
+		scene.nodes[i] = transform_add(scene.transforms, TRANSFORM_NONE, scene.locals[i]);
+	}
+
+	return scene.pipeline && scene.vertex_buffer && scene.index_buffer && scene.instance_buffer &&
+		scene.material_constants && scene.view_constants;
+}
+
+static void test_frame(void* context, XrCompositionLayerProjectionView& view, render_handle_t target, XrTime display_time) {
+	test_scene_t&     scene  = *(test_scene_t*)context;
+	render_context_t& render = *scene.render;
+
+	// Each cube spins about y at its own rate
+	double seconds = (double)display_time / 1.0e9;
+	for (uint32_t i = 0; i < TEST_CUBES; i++) {
+		float angle = (float)fmod(seconds * (0.5 + 0.25 * i), 6.283185307179586);
+		scene.locals[i].rotation[1] = sinf(angle * 0.5f);
+		scene.locals[i].rotation[3] = cosf(angle * 0.5f);
+		transform_set_local(scene.transforms, scene.nodes[i], scene.locals[i]);
+	}
+	transform_update(scene.transforms);
+	for (uint32_t i = 0; i < TEST_CUBES; i++)
+		transform_get_world(scene.transforms, scene.nodes[i], scene.instances[i].world);
+
+	const XrRect2Di& rect    = view.subImage.imageRect;
+	const float      clear[] = { 0.098f, 0.137f, 0.294f, 1.0f };
+	render_set_viewport(render, { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height });
+	render_clear(render, target, target, clear);
+	render_set_targets(render, target, target);
+
+	test_constants_t constants = { { 1.0f, 1.0f, 1.0f, 1.0f } };
+	test_view_proj(view, constants.viewproj);
+	render_update_buffer(render, scene.instance_buffer, scene.instances, sizeof(scene.instances));
+	render_set_constants(render, render_stage_vertex, 0, scene.material_constants);
+	render_set_constants(render, render_stage_vertex, 1, scene.view_constants);
+	render_update_constants(render, scene.material_constants, constants.tint,     sizeof(constants.tint));
+	render_update_constants(render, scene.view_constants,     constants.viewproj, sizeof(constants.viewproj));
+
+	render_set_pipeline       (render, scene.pipeline);
+	render_set_vertex_buffer  (render, scene.vertex_buffer, sizeof(float) * 9);
+	render_set_index_buffer   (render, scene.index_buffer, sizeof(uint16_t));
+	render_set_instance_buffer(render, scene.instance_buffer, sizeof(scene_instance_t));
+	render_draw_indexed       (render, scene.index_count, TEST_CUBES);
+	scene.frames++;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: vk_validate <SPIR-V directory> [frames]\n");
+		return 1;
+	}
+	uint32_t frames = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 90;
+
+	render_context_t render = {};
+	test_scene_t*    scene  = new test_scene_t();
+	scene->spirv_dir = argv[1];
+	scene->render    = &render;
+
+	vk_validate_scene_t validate_scene = { scene, test_init, test_frame };
+	TEST_CHECK(vk_validate(render, validate_scene, frames, 1024));
+	TEST_CHECK(scene->frames == frames);
+	TEST_CHECK(render.stats.frames == frames);
+	TEST_CHECK(render.stats.commands[render_cmd_draw_indexed] == frames);
+	delete scene;
+
+	if (test_failures > 0) {
+		fprintf(stderr, "%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("vk_validate: all checks passed\n");
+	return 0;
+}
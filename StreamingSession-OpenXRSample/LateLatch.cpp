@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "LateLatch.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void late_latch_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static double late_latch_rotation_deg(const XrQuaternionf& a, const XrQuaternionf& b) {
+	double d = fabs((double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z + (double)a.w * b.w);
+	if (d > 1.0) d = 1.0;
+	return 2.0 * acos(d) * (180.0 / 3.14159265358979323846);
+}
+
+static double late_latch_translation_mm(const XrVector3f& a, const XrVector3f& b) {
+	double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+	return sqrt(dx * dx + dy * dy + dz * dz) * 1000.0;
+}
+
+bool late_latch_early(late_latch_t& latch, XrTime display_time, XrView* views, uint32_t view_count) {
+	latch.display_time = display_time;
+	latch.view_count   = view_count < LATE_LATCH_MAX_VIEWS ? view_count : LATE_LATCH_MAX_VIEWS;
+	latch.early_valid  = false;
+	latch.stats.frames++;
+
+	if (!latch.locate(latch.context, display_time, views, latch.view_count))
+		return false;
+	memcpy(latch.early, views, sizeof(XrView) * latch.view_count);
+	latch.early_valid = true;
+	return true;
+}
+
+bool late_latch_latch(late_latch_t& latch, XrView* views) {
+	if (!latch.enabled)
+		return false;
+
+	XrView latched[LATE_LATCH_MAX_VIEWS];
+	memcpy(latched, latch.early, sizeof(XrView) * latch.view_count);
+	if (!latch.locate(latch.context, latch.display_time, latched, latch.view_count)) {
+		latch.stats.rejected++;
+		return false;
+	}
+
+	// Without a valid early pose there's nothing this frame to measure the
+	// correction against
+	for (uint32_t i = 0; latch.early_valid && i < latch.view_count; i++) {
+		latch.stats.rotation_deg_sum   += late_latch_rotation_deg  (latch.early[i].pose.orientation, latched[i].pose.orientation);
+		latch.stats.translation_mm_sum += late_latch_translation_mm(latch.early[i].pose.position,    latched[i].pose.position);
+	}
+	memcpy(views, latched, sizeof(XrView) * latch.view_count);
+	latch.stats.latched++;
+	if (latch.early_valid) latch.stats.compared++;
+	return true;
+}
+
+void late_latch_report(const late_latch_t& latch) {
+	if (!latch.enabled)
+		return;
+
+	const late_latch_stats_t& stats = latch.stats;
+	double samples = (double)stats.compared * (latch.view_count ? latch.view_count : 1);
+
+	char text[256];
+	snprintf(text, sizeof(text), "Late latch: %llu of %llu frames latched, %llu rejected, avg correction %.3f deg %.2f mm per view\n",
+		(unsigned long long)stats.latched, (unsigned long long)stats.frames, (unsigned long long)stats.rejected,
+		samples > 0 ? stats.rotation_deg_sum   / samples : 0.0,
+		samples > 0 ? stats.translation_mm_sum / samples : 0.0);
+	late_latch_log(text);
+}
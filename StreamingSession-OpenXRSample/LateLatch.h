@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <openxr/openxr.h>
+#include <stdint.h>
+
+// Late-latched view poses. Views are located once early in the frame, for
+// anything that must be set up before rendering. They are located again right
+// before the draws are submitted, and the render and the submitted
+// XrCompositionLayerProjectionView both use that second, fresher pose.
+//
+// The runtime is reached through late_latch_locate_fn, so the scheduling can
+// be driven by a simulated runtime as well as by xrLocateViews.
+
+#define LATE_LATCH_MAX_VIEWS 4
+
+// Fills views[0..view_count) for display_time. Returns false if the runtime
+// couldn't provide valid poses, in which case views must not be used.
+typedef bool (*late_latch_locate_fn)(void* context, XrTime display_time, XrView* views, uint32_t view_count);
+
+typedef struct late_latch_stats_t {
+	uint64_t frames;
+	uint64_t latched;
+	uint64_t rejected;          // Late locate failed, early pose was kept
+	uint64_t compared;          // Latched frames that had a valid early pose to compare with
+	double   rotation_deg_sum;  // How far the latched pose moved from the early one
+	double   translation_mm_sum;
+} late_latch_stats_t;
+
+typedef struct late_latch_t {
+	bool                 enabled;
+	late_latch_locate_fn locate;
+	void*                context;
+	XrTime               display_time;
+	uint32_t             view_count;
+	bool                 early_valid; // False when this frame's early locate failed
+	XrView               early[LATE_LATCH_MAX_VIEWS];
+	late_latch_stats_t   stats;
+} late_latch_t;
+
+// Locates the early poses into views. Returns false if they are invalid.
+// view_count is at most LATE_LATCH_MAX_VIEWS.
+bool late_latch_early(late_latch_t& latch, XrTime display_time, XrView* views, uint32_t view_count);
+
+// Locates again and overwrites views with the latched poses. If late
+// latching is disabled or the late locate fails, views keep the early poses
+// and false is returned.
+bool late_latch_latch(late_latch_t& latch, XrView* views);
+
+void late_latch_report(const late_latch_t& latch);
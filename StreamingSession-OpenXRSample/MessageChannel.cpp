@@ -1,263 +1,705 @@
-//===----------------------------------------------------------------------===//
-// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
-//
-// Licensed under the MIT license (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// StreamingSession/LICENSE.txt
-//
-//===----------------------------------------------------------------------===//
-
-#include "MessageChannel.h"
-
-#include <openxr/openxr.h>
-#include <openxr/openxr_platform.h>
-#include <thread>
-#include <vector>
-#include <algorithm>
-#include <atomic>
-#include <windows.h>
-
-using namespace std;
-
-PFN_xrCreateOpaqueDataChannelNV       ext_xrCreateOpaqueDataChannelNV       = nullptr;
-PFN_xrDestroyOpaqueDataChannelNV      ext_xrDestroyOpaqueDataChannelNV      = nullptr;
-PFN_xrGetOpaqueDataChannelStateNV     ext_xrGetOpaqueDataChannelStateNV     = nullptr;
-PFN_xrShutdownOpaqueDataChannelNV     ext_xrShutdownOpaqueDataChannelNV     = nullptr;
-PFN_xrSendOpaqueDataChannelNV         ext_xrSendOpaqueDataChannelNV         = nullptr;
-PFN_xrReceiveOpaqueDataChannelNV      ext_xrReceiveOpaqueDataChannelNV      = nullptr;
-
-XrOpaqueDataChannelNV xr_opaque_channel = XR_NULL_HANDLE;
-std::atomic<bool>     xr_opaque_running{false};
-std::atomic<bool>     xr_opaque_connected{false};
-std::atomic<bool>     xr_opaque_connecting{false};
-std::thread           xr_opaque_thread;
-std::thread           xr_opaque_connection_thread;
-
-bool opaque_channel_init() {
-	if (!ext_xrCreateOpaqueDataChannelNV) {
-		OutputDebugStringA("Opaque data channel functions not loaded\n");
-		return false;
-	}
-
-	// Create a unique UUID for the channel
-	XrGuid myUuid = {
-		0x12345678, 0x1234, 0x1234,
-		{0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0}
-	};
-
-	XrOpaqueDataChannelCreateInfoNV createInfo = {
-		XR_TYPE_OPAQUE_DATA_CHANNEL_CREATE_INFO_NV,
-		nullptr,
-		xr_system_id,
-		myUuid
-	};
-
-	XrResult result = ext_xrCreateOpaqueDataChannelNV(xr_instance, &createInfo, &xr_opaque_channel);
-	if (result != XR_SUCCESS) {
-		char msg[256];
-		sprintf_s(msg, "Failed to create opaque data channel: %d\n", result);
-		OutputDebugStringA(msg);
-		return false;
-	}
-
-	OutputDebugStringA("Opaque data channel created successfully\n");
-	printf("Opaque data channel created successfully\n");
-	return true;
-}
-
-
-bool opaque_channel_wait_connection() {
-	XrOpaqueDataChannelStateNV state = {
-		XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV,
-		nullptr
-	};
-
-	auto startTime = std::chrono::steady_clock::now();
-	const int timeoutMs = 30000; // 30 seconds
-
-	OutputDebugStringA("Waiting for CloudXR client to connect...\n");
-
-	while (true) {
-		XrResult result = ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
-		if (result != XR_SUCCESS) {
-			char msg[256];
-			sprintf_s(msg, "Failed to get channel state: %d\n", result);
-			OutputDebugStringA(msg);
-			return false;
-		}
-
-		switch (state.state) {
-		case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV:
-			OutputDebugStringA("Opaque data channel connected!\n");
-			return true;
-
-		case XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV:
-			OutputDebugStringA("Channel disconnected during connection attempt\n");
-			return false;
-
-		case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTING_NV:
-			// Still connecting, continue waiting
-			break;
-
-		default:
-			char msg[256];
-			sprintf_s(msg, "Unexpected channel state: %d\n", state.state);
-			OutputDebugStringA(msg);
-			break;
-		}
-
-		// Check timeout
-		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-			std::chrono::steady_clock::now() - startTime).count();
-		if (elapsed > timeoutMs) {
-			OutputDebugStringA("Connection timeout\n");
-			return false;
-		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
-}
-
-void opaque_channel_connect_async() {
-	xr_opaque_connecting = true;
-
-	OutputDebugStringA("Starting async connection to CloudXR client...\n");
-
-	XrOpaqueDataChannelStateNV state = {
-		XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV,
-		nullptr
-	};
-
-	auto startTime = std::chrono::steady_clock::now();
-	const int timeoutMs = 30000; // 30 seconds
-
-	while (xr_opaque_connecting && !xr_opaque_connected) {
-		XrResult result = ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
-		if (result != XR_SUCCESS) {
-			char msg[256];
-			sprintf_s(msg, "Failed to get channel state: %d\n", result);
-			OutputDebugStringA(msg);
-			break;
-		}
-
-		switch (state.state) {
-		case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV:
-		{
-			OutputDebugStringA("Opaque data channel connected!\n");
-			xr_opaque_connected = true;
-			xr_opaque_running = true;
-
-			// Start receive loop
-			xr_opaque_thread = std::thread(opaque_channel_receive_loop);
-
-			// Send initial test data
-			const uint8_t testData[] = { 0x01, 0x02, 0x03, 0x04, 0x05 };
-			opaque_channel_send_data(testData, sizeof(testData));
-			return;
-		}
-
-		case XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV:
-			OutputDebugStringA("Channel disconnected during connection attempt\n");
-			break;
-
-		case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTING_NV:
-			// Still connecting, continue waiting
-			break;
-		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
-
-	xr_opaque_connecting = false;
-	OutputDebugStringA("Connection thread ended\n");
-}
-
-void opaque_channel_receive_loop() {
-	uint8_t buffer[4096];
-
-	OutputDebugStringA("Started opaque data channel receive loop\n");
-
-	while (xr_opaque_running) {
-		uint32_t receivedBytes = 0;
-		XrResult result = ext_xrReceiveOpaqueDataChannelNV(xr_opaque_channel, sizeof(buffer),
-			&receivedBytes, buffer);
-
-		if (result == XR_SUCCESS && receivedBytes > 0) {
-			char msg[256];
-			sprintf_s(msg, "Received %u bytes from CloudXR client\n", receivedBytes);
-			OutputDebugStringA(msg);
-
-			// Process received data here
-			// Example: Print first few bytes
-			OutputDebugStringA("Data: ");
-			for (uint32_t i = 0; i < min(receivedBytes, 16u); i++) {
-				char hex[8];
-				sprintf_s(hex, "%02X ", buffer[i]);
-				OutputDebugStringA(hex);
-			}
-			OutputDebugStringA("\n");
-		}
-
-		// Check channel state
-		XrOpaqueDataChannelStateNV state = {
-			XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV,
-			nullptr
-		};
-
-		ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
-
-		if (state.state == XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV) {
-			OutputDebugStringA("Channel disconnected, stopping receive loop\n");
-			break;
-		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	}
-
-	OutputDebugStringA("Opaque data channel receive loop ended\n");
-}
-
-bool opaque_channel_send_data(const uint8_t* data, size_t size) {
-
-	if (!ext_xrSendOpaqueDataChannelNV || xr_opaque_channel == XR_NULL_HANDLE) {
-		return false;
-	}
-
-	XrResult result = ext_xrSendOpaqueDataChannelNV(xr_opaque_channel, (uint32_t)size, data);
-	if (result == XR_SUCCESS) {
-		char msg[256];
-		sprintf_s(msg, "Sent %zu bytes to CloudXR client\n", size);
-		OutputDebugStringA(msg);
-		return true;
-	}
-	else {
-		char msg[256];
-		sprintf_s(msg, "Failed to send data: %d\n", result);
-		OutputDebugStringA(msg);
-		return false;
-	}
-}
-
-void opaque_channel_shutdown() {
-	xr_opaque_connecting = false; // Stop connection attempts
-	xr_opaque_running = false;    // Stop receive loop
-
-	if (xr_opaque_connection_thread.joinable()) {
-		xr_opaque_connection_thread.join();
-	}
-
-	if (xr_opaque_thread.joinable()) {
-		xr_opaque_thread.join();
-	}
-
-	if (xr_opaque_channel != XR_NULL_HANDLE && ext_xrShutdownOpaqueDataChannelNV) {
-		ext_xrShutdownOpaqueDataChannelNV(xr_opaque_channel);
-	}
-
-	if (xr_opaque_channel != XR_NULL_HANDLE && ext_xrDestroyOpaqueDataChannelNV) {
-		ext_xrDestroyOpaqueDataChannelNV(xr_opaque_channel);
-		xr_opaque_channel = XR_NULL_HANDLE;
-	}
-}
\ No newline at end of file
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "MessageChannel.h"
+#include "ThreadPolicy.h"
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace std;
+
+PFN_xrCreateOpaqueDataChannelNV       ext_xrCreateOpaqueDataChannelNV       = nullptr;
+PFN_xrDestroyOpaqueDataChannelNV      ext_xrDestroyOpaqueDataChannelNV      = nullptr;
+PFN_xrGetOpaqueDataChannelStateNV     ext_xrGetOpaqueDataChannelStateNV     = nullptr;
+PFN_xrShutdownOpaqueDataChannelNV     ext_xrShutdownOpaqueDataChannelNV     = nullptr;
+PFN_xrSendOpaqueDataChannelNV         ext_xrSendOpaqueDataChannelNV         = nullptr;
+PFN_xrReceiveOpaqueDataChannelNV      ext_xrReceiveOpaqueDataChannelNV      = nullptr;
+
+XrOpaqueDataChannelNV xr_opaque_channel = XR_NULL_HANDLE;
+std::atomic<bool>     xr_opaque_running{false};
+std::atomic<bool>     xr_opaque_connected{false};
+std::atomic<bool>     xr_opaque_connecting{false};
+std::thread           xr_opaque_thread;
+std::thread           xr_opaque_connection_thread;
+
+void*    opaque_channel_wakeup_event   = nullptr;
+bool     opaque_channel_pump_mode      = false;
+uint32_t opaque_channel_pump_budget_us = 500;
+opaque_channel_handler_fn opaque_channel_message_handler = nullptr;
+
+uint32_t               opaque_channel_state_check_interval_ms = 20;
+uint32_t               opaque_channel_max_batch_messages      = 64;
+opaque_channel_stats_t opaque_channel_stats                   = {};
+
+// Largest message a single receive call can return
+static const uint32_t opaque_channel_message_capacity = 4096;
+
+// Off while benchmarking, which would otherwise log thousands of batches
+static bool opaque_channel_log_batches = true;
+
+// Only one of the receive thread or the pump services the channel, so a
+// single batch is shared between them.
+static opaque_channel_batch_t opaque_channel_batch;
+
+static std::mutex                     opaque_channel_event_lock;
+static deque<opaque_channel_event_t>  opaque_channel_events;
+
+// Pump mode send queue: payloads are packed back to back in send_bytes, with
+// their lengths in send_sizes. Both keep their capacity between frames.
+static vector<uint8_t>  opaque_channel_send_bytes;
+static vector<uint32_t> opaque_channel_send_sizes;
+static std::chrono::steady_clock::time_point opaque_channel_pump_last_state_check;
+
+typedef enum opaque_channel_connect_status_t {
+	opaque_channel_connect_pending = 0,
+	opaque_channel_connect_done,
+	opaque_channel_connect_failed,
+} opaque_channel_connect_status_t;
+
+static bool opaque_channel_send_now(const uint8_t* data, size_t size);
+
+static void opaque_channel_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+// Signals the wakeup event, if the frame loop has one to sleep on
+static void opaque_channel_signal() {
+#ifdef _WIN32
+	if (opaque_channel_wakeup_event) SetEvent((HANDLE)opaque_channel_wakeup_event);
+#endif
+}
+
+// Wakes an idle frame loop for events queued by the channel threads.
+// Received batches are handled on the receive thread and leave the frame
+// loop nothing to do, so they don't wake it. In pump mode the frame loop
+// does the work itself, in the same iteration, so only work the pump had to
+// leave for the next frame signals.
+static void opaque_channel_wake() {
+	if (!opaque_channel_pump_mode) opaque_channel_signal();
+}
+
+static void opaque_channel_push_event(opaque_channel_event_t event) {
+	{
+		std::lock_guard<std::mutex> lock(opaque_channel_event_lock);
+		opaque_channel_events.push_back(event);
+	}
+	opaque_channel_wake();
+}
+
+bool opaque_channel_poll_event(opaque_channel_event_t& event) {
+	std::lock_guard<std::mutex> lock(opaque_channel_event_lock);
+	if (opaque_channel_events.empty())
+		return false;
+	event = opaque_channel_events.front();
+	opaque_channel_events.pop_front();
+	return true;
+}
+
+static void opaque_channel_process_message(const uint8_t* data, uint32_t size) {
+	if (opaque_channel_message_handler && opaque_channel_message_handler(data, size))
+		return;
+
+	// Process received data here
+	// Example: Print first few bytes
+	opaque_channel_log("Data: ");
+	for (uint32_t i = 0; i < min(size, 16u); i++) {
+		char hex[8];
+		snprintf(hex, sizeof(hex), "%02X ", data[i]);
+		opaque_channel_log(hex);
+	}
+	opaque_channel_log("\n");
+}
+
+// Receive until the runtime has nothing left, the batch is full or the
+// deadline passes. Returns true when messages may still be pending.
+static bool opaque_channel_drain(opaque_channel_batch_t& batch, std::chrono::steady_clock::time_point deadline) {
+	using clock = std::chrono::steady_clock;
+
+	size_t required = (size_t)opaque_channel_max_batch_messages * opaque_channel_message_capacity;
+	if (batch.bytes.size() < required) {
+		batch.bytes.resize(required);
+		batch.sizes.reserve(opaque_channel_max_batch_messages);
+	}
+	batch.sizes.clear();
+
+	const clock::time_point start = clock::now();
+	size_t used = 0;
+	bool   more = false;
+	while (true) {
+		if (batch.sizes.size() >= opaque_channel_max_batch_messages) {
+			more = true;
+			break;
+		}
+
+		uint32_t receivedBytes = 0;
+		XrResult result = ext_xrReceiveOpaqueDataChannelNV(xr_opaque_channel, opaque_channel_message_capacity,
+			&receivedBytes, batch.bytes.data() + used);
+		if (result != XR_SUCCESS || receivedBytes == 0)
+			break;
+
+		batch.sizes.push_back(receivedBytes);
+		used += receivedBytes;
+
+		if (clock::now() >= deadline) {
+			more = true;
+			break;
+		}
+	}
+
+	if (!batch.sizes.empty()) {
+		opaque_channel_stats.burst_seconds += std::chrono::duration<double>(clock::now() - start).count();
+	}
+	return more;
+}
+
+void opaque_channel_dispatch_batch(const opaque_channel_batch_t& batch) {
+	uint32_t count = (uint32_t)batch.sizes.size();
+	size_t   offset = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		opaque_channel_process_message(batch.bytes.data() + offset, batch.sizes[i]);
+		offset += batch.sizes[i];
+	}
+
+	if (opaque_channel_log_batches) {
+		char msg[256];
+		snprintf(msg, sizeof(msg), "Received %u messages (%zu bytes) from CloudXR client\n", count, offset);
+		opaque_channel_log(msg);
+	}
+
+	opaque_channel_stats.messages += count;
+	opaque_channel_stats.bytes    += offset;
+	opaque_channel_stats.batches  += 1;
+	opaque_channel_stats.largest_batch = max(opaque_channel_stats.largest_batch, count);
+}
+
+void opaque_channel_report_stats() {
+	const opaque_channel_stats_t& stats = opaque_channel_stats;
+	double avg_batch  = stats.batches       > 0 ? (double)stats.messages / stats.batches       : 0.0;
+	double burst_msgs = stats.burst_seconds > 0 ? (double)stats.messages / stats.burst_seconds : 0.0;
+	double burst_mb   = stats.burst_seconds > 0 ? (double)stats.bytes / (1024.0 * 1024.0) / stats.burst_seconds : 0.0;
+
+	char msg[512];
+	snprintf(msg, sizeof(msg), "Opaque data channel: %llu messages, %llu bytes in %llu batches (avg %.1f, max %u per batch), %llu state checks\n",
+		(unsigned long long)stats.messages, (unsigned long long)stats.bytes, (unsigned long long)stats.batches,
+		avg_batch, stats.largest_batch, (unsigned long long)stats.state_checks);
+	opaque_channel_log(msg);
+	snprintf(msg, sizeof(msg), "Opaque data channel: burst throughput %.0f msg/s, %.2f MB/s\n", burst_msgs, burst_mb);
+	opaque_channel_log(msg);
+}
+
+bool opaque_channel_init() {
+	if (!ext_xrCreateOpaqueDataChannelNV) {
+		opaque_channel_log("Opaque data channel functions not loaded\n");
+		return false;
+	}
+
+	// Create a unique UUID for the channel
+	XrGuid myUuid = {
+		0x12345678, 0x1234, 0x1234,
+		{0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0}
+	};
+
+	XrOpaqueDataChannelCreateInfoNV createInfo = {
+		XR_TYPE_OPAQUE_DATA_CHANNEL_CREATE_INFO_NV,
+		nullptr,
+		xr_system_id,
+		myUuid
+	};
+
+	XrResult result = ext_xrCreateOpaqueDataChannelNV(xr_instance, &createInfo, &xr_opaque_channel);
+	if (result != XR_SUCCESS) {
+		char msg[256];
+		snprintf(msg, sizeof(msg), "Failed to create opaque data channel: %d\n", result);
+		opaque_channel_log(msg);
+		return false;
+	}
+
+#ifdef _WIN32
+	// Auto-reset, so one wait consumes one wakeup
+	opaque_channel_wakeup_event = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+#endif
+
+	opaque_channel_log("Opaque data channel created successfully\n");
+	printf("Opaque data channel created successfully\n");
+	return true;
+}
+
+
+bool opaque_channel_wait_connection() {
+	XrOpaqueDataChannelStateNV state = {
+		XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV,
+		nullptr
+	};
+
+	auto startTime = std::chrono::steady_clock::now();
+	const int timeoutMs = 30000; // 30 seconds
+
+	opaque_channel_log("Waiting for CloudXR client to connect...\n");
+
+	while (true) {
+		XrResult result = ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
+		if (result != XR_SUCCESS) {
+			char msg[256];
+			snprintf(msg, sizeof(msg), "Failed to get channel state: %d\n", result);
+			opaque_channel_log(msg);
+			return false;
+		}
+
+		switch (state.state) {
+		case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV:
+			opaque_channel_log("Opaque data channel connected!\n");
+			return true;
+
+		case XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV:
+			opaque_channel_log("Channel disconnected during connection attempt\n");
+			return false;
+
+		case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTING_NV:
+			// Still connecting, continue waiting
+			break;
+
+		default:
+			char msg[256];
+			snprintf(msg, sizeof(msg), "Unexpected channel state: %d\n", state.state);
+			opaque_channel_log(msg);
+			break;
+		}
+
+		// Check timeout
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - startTime).count();
+		if (elapsed > timeoutMs) {
+			opaque_channel_log("Connection timeout\n");
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
+
+// One connection state check, shared by the connection thread and the pump
+// so both follow the same policy: keep polling while the runtime reports
+// CONNECTING, and give up for good on DISCONNECTED or a failed query. Either
+// outcome is queued as a channel event.
+static opaque_channel_connect_status_t opaque_channel_poll_connection() {
+	XrOpaqueDataChannelStateNV state = {
+		XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV,
+		nullptr
+	};
+
+	XrResult result = ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
+	if (result != XR_SUCCESS) {
+		char msg[256];
+		snprintf(msg, sizeof(msg), "Failed to get channel state: %d\n", result);
+		opaque_channel_log(msg);
+		xr_opaque_connecting = false;
+		return opaque_channel_connect_failed;
+	}
+
+	switch (state.state) {
+	case XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV:
+		opaque_channel_log("Opaque data channel connected!\n");
+		xr_opaque_connecting = false;
+		xr_opaque_connected  = true;
+		xr_opaque_running    = true;
+		opaque_channel_push_event(opaque_channel_event_connected);
+		return opaque_channel_connect_done;
+
+	case XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV:
+		opaque_channel_log("Channel disconnected during connection attempt\n");
+		xr_opaque_connecting = false;
+		opaque_channel_push_event(opaque_channel_event_disconnected);
+		return opaque_channel_connect_failed;
+
+	default:
+		// Still connecting, continue waiting
+		return opaque_channel_connect_pending;
+	}
+}
+
+void opaque_channel_connect_async() {
+	thread_policy_apply(thread_role_channel_io);
+	xr_opaque_connecting = true;
+
+	opaque_channel_log("Starting async connection to CloudXR client...\n");
+
+	while (xr_opaque_connecting && !xr_opaque_connected) {
+		opaque_channel_connect_status_t status = opaque_channel_poll_connection();
+		if (status == opaque_channel_connect_failed)
+			break;
+		if (status == opaque_channel_connect_done) {
+			// Start receive loop
+			xr_opaque_thread = std::thread(opaque_channel_receive_loop);
+
+			// Send initial test data
+			const uint8_t testData[] = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+			opaque_channel_send_data(testData, sizeof(testData));
+			return;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	xr_opaque_connecting = false;
+	opaque_channel_log("Connection thread ended\n");
+}
+
+void opaque_channel_receive_loop() {
+	using clock = std::chrono::steady_clock;
+
+	thread_policy_apply(thread_role_channel_io);
+	opaque_channel_log("Started opaque data channel receive loop\n");
+
+	clock::time_point last_state_check = clock::now();
+	while (xr_opaque_running) {
+		bool more = opaque_channel_drain(opaque_channel_batch, clock::time_point::max());
+		if (!opaque_channel_batch.sizes.empty()) {
+			opaque_channel_dispatch_batch(opaque_channel_batch);
+		}
+
+		// Check channel state
+		clock::time_point now = clock::now();
+		if (now - last_state_check >= std::chrono::milliseconds(opaque_channel_state_check_interval_ms)) {
+			last_state_check = now;
+
+			XrOpaqueDataChannelStateNV state = {
+				XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV,
+				nullptr
+			};
+
+			ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
+			opaque_channel_stats.state_checks++;
+
+			if (state.state == XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV) {
+				opaque_channel_log("Channel disconnected, stopping receive loop\n");
+				xr_opaque_connected = false;
+				opaque_channel_push_event(opaque_channel_event_disconnected);
+				break;
+			}
+		}
+
+		// Only back off once the runtime has been drained
+		if (!more) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	opaque_channel_log("Opaque data channel receive loop ended\n");
+}
+
+bool opaque_channel_send_data(const uint8_t* data, size_t size) {
+
+	if (!ext_xrSendOpaqueDataChannelNV || xr_opaque_channel == XR_NULL_HANDLE) {
+		return false;
+	}
+
+	// In pump mode, sends are flushed from the frame loop by opaque_channel_pump
+	if (opaque_channel_pump_mode) {
+		opaque_channel_send_bytes.insert(opaque_channel_send_bytes.end(), data, data + size);
+		opaque_channel_send_sizes.push_back((uint32_t)size);
+		return true;
+	}
+
+	return opaque_channel_send_now(data, size);
+}
+
+static bool opaque_channel_send_now(const uint8_t* data, size_t size) {
+	XrResult result = ext_xrSendOpaqueDataChannelNV(xr_opaque_channel, (uint32_t)size, data);
+	if (result == XR_SUCCESS) {
+		char msg[256];
+		snprintf(msg, sizeof(msg), "Sent %zu bytes to CloudXR client\n", size);
+		opaque_channel_log(msg);
+		return true;
+	}
+	else {
+		char msg[256];
+		snprintf(msg, sizeof(msg), "Failed to send data: %d\n", result);
+		opaque_channel_log(msg);
+		return false;
+	}
+}
+
+bool opaque_channel_pump(uint32_t budget_us) {
+	if (xr_opaque_channel == XR_NULL_HANDLE || !ext_xrGetOpaqueDataChannelStateNV)
+		return false;
+
+	using clock = std::chrono::steady_clock;
+	const clock::time_point start    = clock::now();
+	const clock::time_point deadline = start + std::chrono::microseconds(budget_us);
+
+	// Connect-state polling. While connecting, this matches the 100 ms cadence
+	// of opaque_channel_connect_async. Once connected, the state is checked
+	// at opaque_channel_state_check_interval_ms like the receive thread.
+	if (!xr_opaque_connected) {
+		if (!xr_opaque_connecting || start - opaque_channel_pump_last_state_check < std::chrono::milliseconds(100))
+			return false;
+		opaque_channel_pump_last_state_check = start;
+
+		opaque_channel_connect_status_t status = opaque_channel_poll_connection();
+		if (status == opaque_channel_connect_pending)
+			return false;
+		if (status == opaque_channel_connect_failed)
+			return true;
+
+		// Send initial test data
+		const uint8_t testData[] = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+		opaque_channel_send_data(testData, sizeof(testData));
+	}
+
+	// Drain received messages until the runtime has nothing left or the
+	// budget runs out. Anything left over is picked up next frame.
+	bool more     = opaque_channel_drain(opaque_channel_batch, deadline);
+	bool activity = !opaque_channel_batch.sizes.empty();
+	if (activity) {
+		opaque_channel_dispatch_batch(opaque_channel_batch);
+	}
+
+	// Flush queued sends. The first send always goes out so a tight budget
+	// can't starve the queue.
+	size_t sent_count = 0;
+	size_t sent_bytes = 0;
+	while (sent_count < opaque_channel_send_sizes.size()) {
+		if (sent_count > 0 && clock::now() >= deadline)
+			break;
+		uint32_t size = opaque_channel_send_sizes[sent_count];
+		opaque_channel_send_now(opaque_channel_send_bytes.data() + sent_bytes, size);
+		sent_bytes += size;
+		sent_count++;
+	}
+	opaque_channel_send_sizes.erase(opaque_channel_send_sizes.begin(), opaque_channel_send_sizes.begin() + sent_count);
+	opaque_channel_send_bytes.erase(opaque_channel_send_bytes.begin(), opaque_channel_send_bytes.begin() + sent_bytes);
+
+	// Out of budget with work left over. Nothing else will signal while the
+	// frame loop sleeps, so keep an idle wait from sleeping on it.
+	if (more || !opaque_channel_send_sizes.empty())
+		opaque_channel_signal();
+
+	if (start - opaque_channel_pump_last_state_check < std::chrono::milliseconds(opaque_channel_state_check_interval_ms))
+		return activity;
+	opaque_channel_pump_last_state_check = start;
+
+	XrOpaqueDataChannelStateNV state = { XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV, nullptr };
+	ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
+	opaque_channel_stats.state_checks++;
+	if (state.state == XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV) {
+		opaque_channel_log("Channel disconnected\n");
+		xr_opaque_connected = false;
+		xr_opaque_running   = false;
+		opaque_channel_send_bytes.clear();
+		opaque_channel_send_sizes.clear();
+		opaque_channel_push_event(opaque_channel_event_disconnected);
+		activity = true;
+	}
+	return activity;
+}
+
+void opaque_channel_shutdown() {
+	xr_opaque_connecting = false; // Stop connection attempts
+	xr_opaque_running = false;    // Stop receive loop
+
+	if (xr_opaque_connection_thread.joinable()) {
+		xr_opaque_connection_thread.join();
+	}
+
+	if (xr_opaque_thread.joinable()) {
+		xr_opaque_thread.join();
+	}
+
+	opaque_channel_report_stats();
+
+	if (xr_opaque_channel != XR_NULL_HANDLE && ext_xrShutdownOpaqueDataChannelNV) {
+		ext_xrShutdownOpaqueDataChannelNV(xr_opaque_channel);
+	}
+
+	if (xr_opaque_channel != XR_NULL_HANDLE && ext_xrDestroyOpaqueDataChannelNV) {
+		ext_xrDestroyOpaqueDataChannelNV(xr_opaque_channel);
+		xr_opaque_channel = XR_NULL_HANDLE;
+	}
+
+#ifdef _WIN32
+	if (opaque_channel_wakeup_event) {
+		CloseHandle((HANDLE)opaque_channel_wakeup_event);
+		opaque_channel_wakeup_event = nullptr;
+	}
+#endif
+}
+///////////////////////////////////////////
+// Benchmark
+///////////////////////////////////////////
+
+// An in-process stand-in for the runtime, holding one queued burst.
+// Message i is sizes[i] bytes, every byte (uint8_t)i.
+static vector<uint32_t> opaque_channel_bench_sizes;
+static uint32_t         opaque_channel_bench_next;      // Next message the stub returns
+static uint32_t         opaque_channel_bench_handled;   // Messages the handler has seen
+static uint64_t         opaque_channel_bench_bytes;
+static bool             opaque_channel_bench_ordered;   // Every message arrived whole and in order
+static std::chrono::steady_clock::time_point opaque_channel_bench_last; // When the last one was handled
+
+static XrResult XRAPI_PTR opaque_channel_bench_receive(XrOpaqueDataChannelNV, uint32_t capacity, uint32_t* count, uint8_t* data) {
+	*count = 0;
+	if (opaque_channel_bench_next == opaque_channel_bench_sizes.size())
+		return XR_SUCCESS;
+	uint32_t size = opaque_channel_bench_sizes[opaque_channel_bench_next];
+	if (size > capacity)
+		return XR_ERROR_CHANNEL_NOT_CONNECTED_NV;
+	memset(data, (uint8_t)opaque_channel_bench_next, size);
+	opaque_channel_bench_next++;
+	*count = size;
+	return XR_SUCCESS;
+}
+
+// Connected while the burst lasts, so both loops end once it's received
+static XrResult XRAPI_PTR opaque_channel_bench_state(XrOpaqueDataChannelNV, XrOpaqueDataChannelStateNV* state) {
+	state->state = opaque_channel_bench_next < opaque_channel_bench_sizes.size()
+		? XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV
+		: XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV;
+	return XR_SUCCESS;
+}
+
+static bool opaque_channel_bench_handler(const uint8_t* data, uint32_t size) {
+	uint32_t index = opaque_channel_bench_handled++;
+	if (index >= opaque_channel_bench_sizes.size() || size != opaque_channel_bench_sizes[index] ||
+		data[0] != (uint8_t)index || data[size - 1] != (uint8_t)index)
+		opaque_channel_bench_ordered = false;
+	opaque_channel_bench_bytes += size;
+	opaque_channel_bench_last   = std::chrono::steady_clock::now();
+	return true;
+}
+
+static void opaque_channel_bench_reset() {
+	opaque_channel_bench_next    = 0;
+	opaque_channel_bench_handled = 0;
+	opaque_channel_bench_bytes   = 0;
+	opaque_channel_bench_ordered = true;
+	opaque_channel_stats         = {};
+}
+
+// The receive loop as it was before bursts were drained: one receive and
+// one state check per iteration, then a 1 ms sleep. The sleep is counted
+// rather than slept, or the burst would take a millisecond per message.
+static uint32_t opaque_channel_bench_single() {
+	uint8_t  buffer[opaque_channel_message_capacity];
+	uint32_t sleeps = 0;
+	while (true) {
+		uint32_t receivedBytes = 0;
+		XrResult result = ext_xrReceiveOpaqueDataChannelNV(xr_opaque_channel, sizeof(buffer), &receivedBytes, buffer);
+		if (result == XR_SUCCESS && receivedBytes > 0)
+			opaque_channel_process_message(buffer, receivedBytes);
+
+		XrOpaqueDataChannelStateNV state = { XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV, nullptr };
+		ext_xrGetOpaqueDataChannelStateNV(xr_opaque_channel, &state);
+		opaque_channel_stats.state_checks++;
+		if (state.state == XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV)
+			break;
+		sleeps++;
+	}
+	return sleeps;
+}
+
+bool opaque_channel_benchmark(uint32_t max_messages) {
+	using clock = std::chrono::steady_clock;
+
+	// Everything the benchmark swaps out, put back at the end
+	PFN_xrReceiveOpaqueDataChannelNV  receive = ext_xrReceiveOpaqueDataChannelNV;
+	PFN_xrGetOpaqueDataChannelStateNV state   = ext_xrGetOpaqueDataChannelStateNV;
+	XrOpaqueDataChannelNV             channel = xr_opaque_channel;
+	opaque_channel_handler_fn         handler = opaque_channel_message_handler;
+	opaque_channel_stats_t            stats   = opaque_channel_stats;
+	ext_xrReceiveOpaqueDataChannelNV  = opaque_channel_bench_receive;
+	ext_xrGetOpaqueDataChannelStateNV = opaque_channel_bench_state;
+	xr_opaque_channel                 = (XrOpaqueDataChannelNV)&opaque_channel_bench_sizes;
+	opaque_channel_message_handler    = opaque_channel_bench_handler;
+	opaque_channel_log_batches        = false;
+
+	char text[384];
+	snprintf(text, sizeof(text), "Channel benchmark, state checked every %u ms, up to %u messages per batch\n",
+		opaque_channel_state_check_interval_ms, opaque_channel_max_batch_messages);
+	opaque_channel_log(text);
+
+	bool passed = true;
+	for (uint32_t message_count = 1000; message_count <= max_messages; message_count *= 10) {
+		// Mostly small input and pose sized messages, with the odd large one
+		uint32_t seed = 0x2545F491;
+		opaque_channel_bench_sizes.resize(message_count);
+		for (uint32_t i = 0; i < message_count; i++) {
+			seed = seed * 1664525u + 1013904223u;
+			opaque_channel_bench_sizes[i] = (seed >> 8) % 16 == 0 ? 1024 + (seed >> 16) % 3072 : 16 + (seed >> 16) % 240;
+		}
+
+		// One message per iteration
+		opaque_channel_bench_reset();
+		clock::time_point start  = clock::now();
+		uint32_t          sleeps = opaque_channel_bench_single();
+		double            single_busy_s = std::chrono::duration<double>(clock::now() - start).count();
+		double            single_s      = single_busy_s + sleeps * 0.001;
+		uint64_t          single_checks = opaque_channel_stats.state_checks;
+		bool              single_ok     = opaque_channel_bench_ordered && opaque_channel_bench_handled == message_count;
+
+		// The receive thread as it runs in the sample, timed to the last
+		// message handled
+		opaque_channel_bench_reset();
+		xr_opaque_running = true;
+		start = clock::now();
+		std::thread thread(opaque_channel_receive_loop);
+		thread.join();
+		xr_opaque_running = false;
+		double drained_s = std::chrono::duration<double>(opaque_channel_bench_last - start).count();
+		bool   drained_ok = opaque_channel_bench_ordered && opaque_channel_bench_handled == message_count;
+		const opaque_channel_stats_t& drained = opaque_channel_stats;
+
+		double mb = opaque_channel_bench_bytes / (1024.0 * 1024.0);
+		snprintf(text, sizeof(text), "  %7u messages, %.1f MB: one per iteration %.0f msg/s (%.0f without sleeping), %.2f MB/s, %.2f state checks/msg; drained %.0f msg/s, %.2f MB/s, %.1f per batch (max %u), %.4f state checks/msg\n",
+			message_count, mb,
+			message_count / single_s, message_count / single_busy_s, mb / single_s, (double)single_checks / message_count,
+			message_count / drained_s, mb / drained_s, (double)drained.messages / std::max<uint64_t>(drained.batches, 1),
+			drained.largest_batch, (double)drained.state_checks / message_count);
+		opaque_channel_log(text);
+
+		if (!single_ok || !drained_ok || drained.messages != message_count) {
+			snprintf(text, sizeof(text), "  %u messages: %s loop lost or reordered messages\n", message_count, single_ok ? "drained" : "single receive");
+			opaque_channel_log(text);
+			passed = false;
+		}
+	}
+
+	// The receive loop queues a disconnect each time the burst ends
+	opaque_channel_event_t event;
+	while (opaque_channel_poll_event(event)) {}
+	xr_opaque_connected = false;
+
+	ext_xrReceiveOpaqueDataChannelNV  = receive;
+	ext_xrGetOpaqueDataChannelStateNV = state;
+	xr_opaque_channel                 = channel;
+	opaque_channel_message_handler    = handler;
+	opaque_channel_stats              = stats;
+	opaque_channel_log_batches        = true;
+	opaque_channel_bench_sizes.clear();
+	return passed;
+}
@@ -1,119 +1,179 @@
-//===----------------------------------------------------------------------===//
-// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
-//
-// Licensed under the MIT license (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// StreamingSession/LICENSE.txt
-//
-//===----------------------------------------------------------------------===//
-
-#pragma once
-#include <openxr/openxr.h>
-#include <openxr/openxr_platform.h>
-#include <thread>
-#include <vector>
-#include <algorithm>
-#include <atomic>
-
-// Handle type
-XR_DEFINE_HANDLE(XrOpaqueDataChannelNV)
-
-// Structure type constants
-#define XR_TYPE_OPAQUE_DATA_CHANNEL_CREATE_INFO_NV ((XrStructureType)1000500000)
-#define XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV ((XrStructureType)1000500001)
-
-// Status enum
-typedef enum XrOpaqueDataChannelStatusNV {
-	XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTING_NV = 0,
-	XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV = 1,
-	XR_OPAQUE_DATA_CHANNEL_STATUS_SHUTTING_NV = 2,
-	XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV = 3,
-} XrOpaqueDataChannelStatusNV;
-
-// GUID structure (if not already defined)
-#ifndef XrGuid
-typedef struct XrGuid {
-	uint32_t data1;
-	uint16_t data2;
-	uint16_t data3;
-	uint8_t data4[8];
-} XrGuid;
-#endif
-
-// Structure definitions
-typedef struct XrOpaqueDataChannelCreateInfoNV {
-	XrStructureType type;
-	const void* next;
-	XrSystemId systemId;
-	XrGuid uuid;
-} XrOpaqueDataChannelCreateInfoNV;
-
-typedef struct XrOpaqueDataChannelStateNV {
-	XrStructureType type;
-	void* next;
-	XrOpaqueDataChannelStatusNV state;
-} XrOpaqueDataChannelStateNV;
-
-extern XrSystemId     xr_system_id;
-extern XrInstance     xr_instance;
-
-extern std::atomic<bool> xr_opaque_connected;
-extern std::atomic<bool> xr_opaque_connecting;
-extern std::thread xr_opaque_connection_thread;
-extern XrOpaqueDataChannelNV  xr_opaque_channel;
-extern std::atomic<bool>      xr_opaque_running;
-extern std::thread            xr_opaque_thread;
-
-// FUNCTION POINTER TYPE DEFINITIONS
-typedef XrResult(XRAPI_PTR* PFN_xrCreateOpaqueDataChannelNV)(
-	XrInstance instance,
-	const XrOpaqueDataChannelCreateInfoNV* createInfo,
-	XrOpaqueDataChannelNV* opaqueDataChannel);
-
-typedef XrResult(XRAPI_PTR* PFN_xrDestroyOpaqueDataChannelNV)(
-	XrOpaqueDataChannelNV opaqueDataChannel);
-
-typedef XrResult(XRAPI_PTR* PFN_xrGetOpaqueDataChannelStateNV)(
-	XrOpaqueDataChannelNV opaqueDataChannel,
-	XrOpaqueDataChannelStateNV* state);
-
-typedef XrResult(XRAPI_PTR* PFN_xrShutdownOpaqueDataChannelNV)(
-	XrOpaqueDataChannelNV opaqueDataChannel);
-
-typedef XrResult(XRAPI_PTR* PFN_xrSendOpaqueDataChannelNV)(
-	XrOpaqueDataChannelNV opaqueDataChannel,
-	uint32_t opaqueDataInputCount,
-	const uint8_t* opaqueDatas);
-
-typedef XrResult(XRAPI_PTR* PFN_xrReceiveOpaqueDataChannelNV)(
-	XrOpaqueDataChannelNV opaqueDataChannel,
-	uint32_t opaqueDataCapacityInput,
-	uint32_t* opaqueDataCountOutput,
-	uint8_t* opaqueDatas);
-
-// Error codes
-#define XR_ERROR_CHANNEL_ALREADY_CREATED_NV ((XrResult)-1000500000)
-#define XR_ERROR_CHANNEL_NOT_CONNECTED_NV ((XrResult)-1000500001)
-
-// Opaque data channel APIs
-extern PFN_xrCreateOpaqueDataChannelNV       ext_xrCreateOpaqueDataChannelNV;
-extern PFN_xrDestroyOpaqueDataChannelNV      ext_xrDestroyOpaqueDataChannelNV;
-extern PFN_xrGetOpaqueDataChannelStateNV     ext_xrGetOpaqueDataChannelStateNV;
-extern PFN_xrShutdownOpaqueDataChannelNV     ext_xrShutdownOpaqueDataChannelNV;
-extern PFN_xrSendOpaqueDataChannelNV         ext_xrSendOpaqueDataChannelNV;
-extern PFN_xrReceiveOpaqueDataChannelNV      ext_xrReceiveOpaqueDataChannelNV;
-
-bool opaque_channel_init();
-bool opaque_channel_wait_connection();
-void opaque_channel_connect_async();
-void opaque_channel_receive_loop();
-bool opaque_channel_send_data(const uint8_t* data, size_t size);
-void opaque_channel_shutdown();
-void opaque_channel_receive_loop();
-bool opaque_channel_send_data(const uint8_t* data, size_t size);
-
-
-
-
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+
+// Handle type
+XR_DEFINE_HANDLE(XrOpaqueDataChannelNV)
+
+// Structure type constants
+#define XR_TYPE_OPAQUE_DATA_CHANNEL_CREATE_INFO_NV ((XrStructureType)1000500000)
+#define XR_TYPE_OPAQUE_DATA_CHANNEL_STATE_NV ((XrStructureType)1000500001)
+
+// Status enum
+typedef enum XrOpaqueDataChannelStatusNV {
+	XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTING_NV = 0,
+	XR_OPAQUE_DATA_CHANNEL_STATUS_CONNECTED_NV = 1,
+	XR_OPAQUE_DATA_CHANNEL_STATUS_SHUTTING_NV = 2,
+	XR_OPAQUE_DATA_CHANNEL_STATUS_DISCONNECTED_NV = 3,
+} XrOpaqueDataChannelStatusNV;
+
+// GUID structure (if not already defined)
+#ifndef XrGuid
+typedef struct XrGuid {
+	uint32_t data1;
+	uint16_t data2;
+	uint16_t data3;
+	uint8_t data4[8];
+} XrGuid;
+#endif
+
+// Structure definitions
+typedef struct XrOpaqueDataChannelCreateInfoNV {
+	XrStructureType type;
+	const void* next;
+	XrSystemId systemId;
+	XrGuid uuid;
+} XrOpaqueDataChannelCreateInfoNV;
+
+typedef struct XrOpaqueDataChannelStateNV {
+	XrStructureType type;
+	void* next;
+	XrOpaqueDataChannelStatusNV state;
+} XrOpaqueDataChannelStateNV;
+
+extern XrSystemId     xr_system_id;
+extern XrInstance     xr_instance;
+
+extern std::atomic<bool> xr_opaque_connected;
+extern std::atomic<bool> xr_opaque_connecting;
+extern std::thread xr_opaque_connection_thread;
+extern XrOpaqueDataChannelNV  xr_opaque_channel;
+extern std::atomic<bool>      xr_opaque_running;
+extern std::thread            xr_opaque_thread;
+
+// FUNCTION POINTER TYPE DEFINITIONS
+typedef XrResult(XRAPI_PTR* PFN_xrCreateOpaqueDataChannelNV)(
+	XrInstance instance,
+	const XrOpaqueDataChannelCreateInfoNV* createInfo,
+	XrOpaqueDataChannelNV* opaqueDataChannel);
+
+typedef XrResult(XRAPI_PTR* PFN_xrDestroyOpaqueDataChannelNV)(
+	XrOpaqueDataChannelNV opaqueDataChannel);
+
+typedef XrResult(XRAPI_PTR* PFN_xrGetOpaqueDataChannelStateNV)(
+	XrOpaqueDataChannelNV opaqueDataChannel,
+	XrOpaqueDataChannelStateNV* state);
+
+typedef XrResult(XRAPI_PTR* PFN_xrShutdownOpaqueDataChannelNV)(
+	XrOpaqueDataChannelNV opaqueDataChannel);
+
+typedef XrResult(XRAPI_PTR* PFN_xrSendOpaqueDataChannelNV)(
+	XrOpaqueDataChannelNV opaqueDataChannel,
+	uint32_t opaqueDataInputCount,
+	const uint8_t* opaqueDatas);
+
+typedef XrResult(XRAPI_PTR* PFN_xrReceiveOpaqueDataChannelNV)(
+	XrOpaqueDataChannelNV opaqueDataChannel,
+	uint32_t opaqueDataCapacityInput,
+	uint32_t* opaqueDataCountOutput,
+	uint8_t* opaqueDatas);
+
+// Error codes
+#define XR_ERROR_CHANNEL_ALREADY_CREATED_NV ((XrResult)-1000500000)
+#define XR_ERROR_CHANNEL_NOT_CONNECTED_NV ((XrResult)-1000500001)
+
+// Opaque data channel APIs
+extern PFN_xrCreateOpaqueDataChannelNV       ext_xrCreateOpaqueDataChannelNV;
+extern PFN_xrDestroyOpaqueDataChannelNV      ext_xrDestroyOpaqueDataChannelNV;
+extern PFN_xrGetOpaqueDataChannelStateNV     ext_xrGetOpaqueDataChannelStateNV;
+extern PFN_xrShutdownOpaqueDataChannelNV     ext_xrShutdownOpaqueDataChannelNV;
+extern PFN_xrSendOpaqueDataChannelNV         ext_xrSendOpaqueDataChannelNV;
+extern PFN_xrReceiveOpaqueDataChannelNV      ext_xrReceiveOpaqueDataChannelNV;
+
+// Connection state changes, surfaced to the frame loop next to OpenXR events
+typedef enum opaque_channel_event_t {
+	opaque_channel_event_connected = 0,
+	opaque_channel_event_disconnected = 1,
+} opaque_channel_event_t;
+
+// Messages drained from the runtime in one burst. Payloads are packed back to
+// back in bytes, and sizes holds the length of each message in order.
+typedef struct opaque_channel_batch_t {
+	std::vector<uint8_t>  bytes;
+	std::vector<uint32_t> sizes;
+} opaque_channel_batch_t;
+
+typedef struct opaque_channel_stats_t {
+	uint64_t messages;
+	uint64_t bytes;
+	uint64_t batches;
+	uint64_t state_checks;
+	uint32_t largest_batch;
+	double   burst_seconds; // Time spent draining non-empty bursts
+} opaque_channel_stats_t;
+
+// Channel state is queried at most once per interval while messages are
+// flowing, instead of once per received message.
+extern uint32_t               opaque_channel_state_check_interval_ms;
+extern uint32_t               opaque_channel_max_batch_messages;
+extern opaque_channel_stats_t opaque_channel_stats;
+
+// Win32 event HANDLE, signaled whenever a channel thread queues an event, so
+// an idle frame loop can sleep on it. Batches of messages are handled on the
+// receive thread and don't signal it. In pump mode it is signaled when the
+// pump leaves work for the next frame. The
+// frame loop resets it before checking for work, so a signal for work it has
+// already done can't cut the next idle wait short.
+extern void* opaque_channel_wakeup_event;
+
+// When true, no channel threads are started. The frame loop calls
+// opaque_channel_pump once per frame instead, and sends are queued until
+// the next pump.
+extern bool     opaque_channel_pump_mode;
+extern uint32_t opaque_channel_pump_budget_us;
+
+// Called for every received message, on whichever thread dispatches the
+// batch. Returns true if it consumed the message; anything it doesn't
+// consume gets the default hex dump.
+typedef bool (*opaque_channel_handler_fn)(const uint8_t* data, uint32_t size);
+extern opaque_channel_handler_fn opaque_channel_message_handler;
+
+bool opaque_channel_init();
+bool opaque_channel_wait_connection();
+void opaque_channel_connect_async();
+void opaque_channel_receive_loop();
+bool opaque_channel_send_data(const uint8_t* data, size_t size);
+void opaque_channel_shutdown();
+// Returns true if anything was received or the connection state changed
+bool opaque_channel_pump(uint32_t budget_us);
+void opaque_channel_dispatch_batch(const opaque_channel_batch_t& batch);
+void opaque_channel_report_stats();
+bool opaque_channel_poll_event(opaque_channel_event_t& event);
+
+// Receives bursts of 1k messages up to max_messages from an in-process stand
+// in for the runtime, once with the old one-receive-per-iteration loop and
+// once with the receive thread, and logs throughput, batch sizes and state
+// checks per message for both. Needs neither OpenXR nor a headset. Returns
+// false if either loop lost or reordered a message.
+bool opaque_channel_benchmark(uint32_t max_messages);
+void opaque_channel_receive_loop();
+bool opaque_channel_send_data(const uint8_t* data, size_t size);
+
+
+
+
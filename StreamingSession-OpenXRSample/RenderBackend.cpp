@@ -0,0 +1,376 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "RenderBackend.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void render_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+// Cached state that matches nothing, so the next set always goes through
+static const render_handle_t render_unknown      = (render_handle_t)(uintptr_t)-1;
+static const render_rect_t   render_unknown_rect = { 0, 0, -1, -1 };
+
+static const char* render_cmd_names[render_cmd_count] = {
+	"set_pipeline", "set_targets", "set_viewport", "set_scissor", "set_vertex_buffer", "set_index_buffer",
+	"set_instance_buffer", "set_constants", "set_textures", "update_constants", "update_buffer", "clear", "draw", "draw_indexed",
+};
+
+void render_init(render_context_t& context, const render_backend_t& backend) {
+	context         = {};
+	context.backend = backend;
+	render_invalidate(context);
+}
+
+void render_invalidate(render_context_t& context) {
+	context.pipeline        = render_unknown;
+	context.targets[0]      = render_unknown;
+	context.targets[1]      = render_unknown;
+	context.viewport        = render_unknown_rect;
+	context.scissor         = render_unknown_rect;
+	context.vertex_buffer   = render_unknown;
+	context.vertex_stride   = 0;
+	context.index_buffer    = render_unknown;
+	context.index_size      = 0;
+	context.instance_buffer = render_unknown;
+	context.instance_stride = 0;
+	for (int32_t slot = 0; slot < RENDER_MAX_SLOTS; slot++) {
+		context.constants[0][slot] = render_unknown;
+		context.constants[1][slot] = render_unknown;
+		context.textures[slot]     = render_unknown;
+	}
+}
+
+// Every other field zeroed, as the backends expect
+static render_command_t render_command(render_cmd_t type) {
+	render_command_t command = {};
+	command.type = type;
+	return command;
+}
+
+static void render_submit(render_context_t& context, const render_command_t& command, const void* data = nullptr) {
+	context.stats.commands[command.type]++;
+	if (context.backend.execute)
+		context.backend.execute(context.backend.context, command, data);
+}
+
+static bool render_rect_equal(const render_rect_t& a, const render_rect_t& b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+void render_set_pipeline(render_context_t& context, render_handle_t pipeline) {
+	if (context.pipeline == pipeline) {
+		context.stats.redundant++;
+		return;
+	}
+	context.pipeline = pipeline;
+
+	render_command_t command = render_command(render_cmd_set_pipeline);
+	command.handles[0] = pipeline;
+	render_submit(context, command);
+}
+
+void render_set_targets(render_context_t& context, render_handle_t color, render_handle_t depth) {
+	if (context.targets[0] == color && context.targets[1] == depth) {
+		context.stats.redundant++;
+		return;
+	}
+	context.targets[0] = color;
+	context.targets[1] = depth;
+
+	render_command_t command = render_command(render_cmd_set_targets);
+	command.handles[0] = color;
+	command.handles[1] = depth;
+	render_submit(context, command);
+}
+
+void render_set_viewport(render_context_t& context, const render_rect_t& rect) {
+	if (render_rect_equal(context.viewport, rect)) {
+		context.stats.redundant++;
+		return;
+	}
+	context.viewport = rect;
+
+	render_command_t command = render_command(render_cmd_set_viewport);
+	command.rect = rect;
+	render_submit(context, command);
+}
+
+void render_set_scissor(render_context_t& context, const render_rect_t& rect) {
+	if (render_rect_equal(context.scissor, rect)) {
+		context.stats.redundant++;
+		return;
+	}
+	context.scissor = rect;
+
+	render_command_t command = render_command(render_cmd_set_scissor);
+	command.rect = rect;
+	render_submit(context, command);
+}
+
+void render_set_vertex_buffer(render_context_t& context, render_handle_t buffer, uint32_t stride) {
+	if (context.vertex_buffer == buffer && context.vertex_stride == stride) {
+		context.stats.redundant++;
+		return;
+	}
+	context.vertex_buffer = buffer;
+	context.vertex_stride = stride;
+
+	render_command_t command = render_command(render_cmd_set_vertex_buffer);
+	command.handles[0] = buffer;
+	command.count      = stride;
+	render_submit(context, command);
+}
+
+void render_set_index_buffer(render_context_t& context, render_handle_t buffer, uint32_t index_size) {
+	if (context.index_buffer == buffer && context.index_size == index_size) {
+		context.stats.redundant++;
+		return;
+	}
+	context.index_buffer = buffer;
+	context.index_size   = index_size;
+
+	render_command_t command = render_command(render_cmd_set_index_buffer);
+	command.handles[0] = buffer;
+	command.count      = index_size;
+	render_submit(context, command);
+}
+
+void render_set_instance_buffer(render_context_t& context, render_handle_t buffer, uint32_t stride) {
+	if (context.instance_buffer == buffer && context.instance_stride == stride) {
+		context.stats.redundant++;
+		return;
+	}
+	context.instance_buffer = buffer;
+	context.instance_stride = stride;
+
+	render_command_t command = render_command(render_cmd_set_instance_buffer);
+	command.handles[0] = buffer;
+	command.count      = stride;
+	render_submit(context, command);
+}
+
+void render_set_constants(render_context_t& context, uint32_t stages, uint32_t slot, render_handle_t buffer) {
+	if (slot >= RENDER_MAX_SLOTS)
+		return;
+
+	// Only the stages that actually change are sent
+	uint32_t changed = 0;
+	if ((stages & render_stage_vertex) && context.constants[0][slot] != buffer) changed |= render_stage_vertex;
+	if ((stages & render_stage_pixel)  && context.constants[1][slot] != buffer) changed |= render_stage_pixel;
+	if (changed == 0) {
+		context.stats.redundant++;
+		return;
+	}
+	if (changed & render_stage_vertex) context.constants[0][slot] = buffer;
+	if (changed & render_stage_pixel)  context.constants[1][slot] = buffer;
+
+	render_command_t command = render_command(render_cmd_set_constants);
+	command.stages     = changed;
+	command.slot       = slot;
+	command.handles[0] = buffer;
+	render_submit(context, command);
+}
+
+void render_set_textures(render_context_t& context, uint32_t slot, uint32_t count, const render_handle_t* textures) {
+	if (count > 2 || slot + count > RENDER_MAX_SLOTS)
+		return;
+
+	bool same = true;
+	for (uint32_t i = 0; i < count; i++)
+		same = same && context.textures[slot + i] == textures[i];
+	if (same) {
+		context.stats.redundant++;
+		return;
+	}
+
+	render_command_t command = render_command(render_cmd_set_textures);
+	command.slot  = slot;
+	command.count = count;
+	for (uint32_t i = 0; i < count; i++) {
+		context.textures[slot + i] = textures[i];
+		command.handles[i]         = textures[i];
+	}
+	render_submit(context, command);
+}
+
+void render_update_constants(render_context_t& context, render_handle_t buffer, const void* data, uint32_t size) {
+	context.stats.constant_bytes += size;
+
+	render_command_t command = render_command(render_cmd_update_constants);
+	command.handles[0] = buffer;
+	command.count      = size;
+	render_submit(context, command, data);
+}
+
+void render_update_buffer(render_context_t& context, render_handle_t buffer, const void* data, uint32_t size) {
+	context.stats.buffer_bytes += size;
+
+	render_command_t command = render_command(render_cmd_update_buffer);
+	command.handles[0] = buffer;
+	command.count      = size;
+	render_submit(context, command, data);
+}
+
+void render_clear(render_context_t& context, render_handle_t color, render_handle_t depth, const float clear_color[4]) {
+	render_command_t command = render_command(render_cmd_clear);
+	command.handles[0] = color;
+	command.handles[1] = depth;
+	memcpy(command.color, clear_color, sizeof(command.color));
+	render_submit(context, command);
+}
+
+void render_draw(render_context_t& context, uint32_t vertex_count, uint32_t instance_count) {
+	render_command_t command = render_command(render_cmd_draw);
+	command.count     = vertex_count;
+	command.instances = instance_count;
+	render_submit(context, command);
+}
+
+void render_draw_indexed(render_context_t& context, uint32_t index_count, uint32_t instance_count, uint32_t first_instance) {
+	render_command_t command = render_command(render_cmd_draw_indexed);
+	command.count     = index_count;
+	command.instances = instance_count;
+	command.first     = first_instance;
+	render_submit(context, command);
+}
+
+void render_end_frame(render_context_t& context) {
+	context.stats.frames++;
+}
+
+void render_report(const render_context_t& context) {
+	const render_stats_t& stats = context.stats;
+	if (stats.frames == 0)
+		return;
+
+	uint64_t commands = 0;
+	uint64_t changes  = 0;
+	for (int32_t i = 0; i < render_cmd_count; i++) {
+		commands += stats.commands[i];
+		if (i < render_cmd_update_constants)
+			changes += stats.commands[i];
+	}
+	double frames = (double)stats.frames;
+	char   text[256];
+	snprintf(text, sizeof(text), "Render commands (%s backend), per frame: %.1f commands, %.1f draws, %.1f state changes, %.1f redundant changes dropped, %.0f constant bytes, %.0f buffer bytes\n",
+		context.backend.name ? context.backend.name : "no",
+		commands / frames, (stats.commands[render_cmd_draw] + stats.commands[render_cmd_draw_indexed]) / frames,
+		changes / frames, stats.redundant / frames, stats.constant_bytes / frames, stats.buffer_bytes / frames);
+	render_log(text);
+}
+
+static void render_null_execute(void*, const render_command_t&, const void*) {
+}
+
+render_backend_t render_null_backend() {
+	render_backend_t backend = { "null", render_null_execute, nullptr };
+	return backend;
+}
+
+static void render_recording_execute(void* context, const render_command_t& command, const void* data) {
+	render_recording_t& recording = *(render_recording_t*)context;
+
+	render_command_t recorded = command;
+	if ((command.type == render_cmd_update_constants || command.type == render_cmd_update_buffer) && data != nullptr) {
+		recorded.data = recording.data.size();
+		recording.data.insert(recording.data.end(), (const uint8_t*)data, (const uint8_t*)data + command.count);
+	}
+	recording.commands.push_back(recorded);
+
+	if (recording.forward.execute)
+		recording.forward.execute(recording.forward.context, command, data);
+}
+
+render_backend_t render_recording_backend(render_recording_t& recording) {
+	render_backend_t backend = { "recording", render_recording_execute, &recording };
+	return backend;
+}
+
+void render_recording_clear(render_recording_t& recording) {
+	recording.commands.clear();
+	recording.data.clear();
+}
+
+void render_recording_replay(const render_recording_t& recording, const render_backend_t& backend) {
+	if (!backend.execute)
+		return;
+	for (size_t i = 0; i < recording.commands.size(); i++) {
+		const render_command_t& command = recording.commands[i];
+		const void*             data    = nullptr;
+		if (command.type == render_cmd_update_constants || command.type == render_cmd_update_buffer)
+			data = recording.data.data() + command.data;
+		backend.execute(backend.context, command, data);
+	}
+}
+
+// The same commands render_report counts as state changes
+uint32_t render_recording_binds(const render_recording_t& recording) {
+	uint32_t binds = 0;
+	for (const render_command_t& command : recording.commands)
+		binds += command.type < render_cmd_update_constants ? 1 : 0;
+	return binds;
+}
+
+bool render_recording_equal(const render_recording_t& a, const render_recording_t& b) {
+	if (a.commands.size() != b.commands.size())
+		return false;
+
+	for (size_t i = 0; i < a.commands.size(); i++) {
+		const render_command_t& ca = a.commands[i];
+		const render_command_t& cb = b.commands[i];
+		if (ca.type != cb.type || ca.stages != cb.stages || ca.slot != cb.slot || ca.count != cb.count || ca.instances != cb.instances || ca.first != cb.first ||
+			ca.handles[0] != cb.handles[0] || ca.handles[1] != cb.handles[1] ||
+			!render_rect_equal(ca.rect, cb.rect) || memcmp(ca.color, cb.color, sizeof(ca.color)) != 0)
+			return false;
+		if ((ca.type == render_cmd_update_constants || ca.type == render_cmd_update_buffer) &&
+			memcmp(a.data.data() + ca.data, b.data.data() + cb.data, ca.count) != 0)
+			return false;
+	}
+	return true;
+}
+
+void render_recording_dump(const render_recording_t& recording) {
+	char text[256];
+	snprintf(text, sizeof(text), "Recorded %zu render commands, %zu bytes of constants and buffer updates:\n", recording.commands.size(), recording.data.size());
+	render_log(text);
+
+	for (size_t i = 0; i < recording.commands.size(); i++) {
+		const render_command_t& command = recording.commands[i];
+		switch (command.type) {
+		case render_cmd_set_viewport:
+		case render_cmd_set_scissor:
+			snprintf(text, sizeof(text), "  %4zu %-19s %.0f, %.0f  %.0f x %.0f\n", i, render_cmd_names[command.type],
+				command.rect.x, command.rect.y, command.rect.width, command.rect.height);
+			break;
+		case render_cmd_draw:
+		case render_cmd_draw_indexed:
+			snprintf(text, sizeof(text), "  %4zu %-19s %u x %u from %u\n", i, render_cmd_names[command.type], command.count, command.instances, command.first);
+			break;
+		default:
+			snprintf(text, sizeof(text), "  %4zu %-19s stages %u slot %u count %u  %p %p\n", i, render_cmd_names[command.type],
+				command.stages, command.slot, command.count, command.handles[0], command.handles[1]);
+			break;
+		}
+		render_log(text);
+	}
+}
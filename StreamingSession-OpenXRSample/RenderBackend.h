@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Thin command interface for the render path. Drawing code issues commands
+// through a render_context_t, which drops redundant state changes, counts
+// what is left and hands each command to a backend:
+//   - D3D11 (d3d_execute in main.cpp) runs them on the immediate context,
+//     or on the deferred context given as the backend's context.
+//   - Null discards them, so the CPU cost of the render path can be measured
+//     on its own.
+//   - Recording captures the command stream, optionally forwarding every
+//     command to another backend too. A captured stream can be replayed to
+//     any backend later, which is how chunks recorded on worker threads
+//     reach the GPU (RenderWorkers.h).
+// Resources are created and owned outside this interface and are passed
+// around as opaque handles. Null and recording have no platform dependencies,
+// so command streams can be captured, compared and benchmarked anywhere.
+
+#define RENDER_MAX_SLOTS 4
+
+typedef const void* render_handle_t;
+
+enum render_cmd_t {
+	render_cmd_set_pipeline = 0,
+	render_cmd_set_targets,
+	render_cmd_set_viewport,
+	render_cmd_set_scissor,
+	render_cmd_set_vertex_buffer,
+	render_cmd_set_index_buffer,
+	render_cmd_set_instance_buffer,
+	render_cmd_set_constants,
+	render_cmd_set_textures,
+	render_cmd_update_constants,
+	render_cmd_update_buffer,
+	render_cmd_clear,
+	render_cmd_draw,
+	render_cmd_draw_indexed,
+	render_cmd_count,
+};
+
+// Shader stages for render_cmd_set_constants
+enum render_stage_t {
+	render_stage_vertex = 1 << 0,
+	render_stage_pixel  = 1 << 1,
+};
+
+typedef struct render_rect_t {
+	float x;
+	float y;
+	float width;
+	float height;
+} render_rect_t;
+
+typedef struct render_command_t {
+	render_cmd_t    type;
+	uint32_t        stages;     // render_stage_t flags, set_constants only
+	uint32_t        slot;       // Constant buffer slot, or first texture slot
+	uint32_t        count;      // Vertex or index count, vertex or instance stride, index size, texture count, constant or buffer bytes
+	uint32_t        instances;
+	uint32_t        first;      // First instance, draws only
+	render_handle_t handles[2]; // Pipeline, buffer, textures, or color and depth target
+	render_rect_t   rect;       // Viewport or scissor
+	float           color[4];   // Clear color
+	size_t          data;       // Recorded updates: offset of their bytes in render_recording_t::data
+} render_command_t;
+
+// Executes one command. data is the new contents for update_constants and
+// update_buffer, nullptr otherwise.
+typedef void (*render_execute_fn)(void* context, const render_command_t& command, const void* data);
+
+typedef struct render_backend_t {
+	const char*       name;
+	render_execute_fn execute;
+	void*             context;
+} render_backend_t;
+
+typedef struct render_stats_t {
+	uint64_t frames;
+	uint64_t commands[render_cmd_count]; // Handed to the backend, by type
+	uint64_t redundant;                  // State changes dropped because nothing changed
+	uint64_t constant_bytes;
+	uint64_t buffer_bytes;
+} render_stats_t;
+
+// Bound state, as far as this interface knows. Anything that touches the
+// backend behind its back must call render_invalidate.
+typedef struct render_context_t {
+	render_backend_t backend;
+	render_handle_t  pipeline;
+	render_handle_t  targets[2];
+	render_rect_t    viewport;
+	render_rect_t    scissor;
+	render_handle_t  vertex_buffer;
+	uint32_t         vertex_stride;
+	render_handle_t  index_buffer;
+	uint32_t         index_size;
+	render_handle_t  instance_buffer;
+	uint32_t         instance_stride;
+	render_handle_t  constants[2][RENDER_MAX_SLOTS]; // Per stage: vertex, pixel
+	render_handle_t  textures[RENDER_MAX_SLOTS];
+	render_stats_t   stats;
+} render_context_t;
+
+void render_init(render_context_t& context, const render_backend_t& backend);
+void render_invalidate(render_context_t& context);
+
+void render_set_pipeline     (render_context_t& context, render_handle_t pipeline);
+void render_set_targets      (render_context_t& context, render_handle_t color, render_handle_t depth);
+void render_set_viewport     (render_context_t& context, const render_rect_t& rect);
+void render_set_scissor      (render_context_t& context, const render_rect_t& rect);
+void render_set_vertex_buffer(render_context_t& context, render_handle_t buffer, uint32_t stride);
+void render_set_index_buffer (render_context_t& context, render_handle_t buffer, uint32_t index_size);
+// Per-instance vertex data, in the vertex input slot after the vertex buffer
+void render_set_instance_buffer(render_context_t& context, render_handle_t buffer, uint32_t stride);
+void render_set_constants    (render_context_t& context, uint32_t stages, uint32_t slot, render_handle_t buffer);
+// Up to 2 textures; nullptr entries unbind
+void render_set_textures     (render_context_t& context, uint32_t slot, uint32_t count, const render_handle_t* textures);
+void render_update_constants (render_context_t& context, render_handle_t buffer, const void* data, uint32_t size);
+// Replaces the start of a dynamic buffer, such as the instance buffer. The
+// rest of its previous contents are undefined afterwards.
+void render_update_buffer    (render_context_t& context, render_handle_t buffer, const void* data, uint32_t size);
+// Either target may be nullptr, depth is cleared to 1
+void render_clear            (render_context_t& context, render_handle_t color, render_handle_t depth, const float clear_color[4]);
+void render_draw             (render_context_t& context, uint32_t vertex_count, uint32_t instance_count = 1);
+void render_draw_indexed     (render_context_t& context, uint32_t index_count, uint32_t instance_count = 1, uint32_t first_instance = 0);
+
+void render_end_frame(render_context_t& context);
+void render_report(const render_context_t& context);
+
+render_backend_t render_null_backend();
+
+typedef struct render_recording_t {
+	std::vector<render_command_t> commands;
+	std::vector<uint8_t>          data;    // Contents of update_constants and update_buffer commands
+	render_backend_t              forward; // Also executes each command, if set
+} render_recording_t;
+
+render_backend_t render_recording_backend(render_recording_t& recording);
+void render_recording_clear(render_recording_t& recording);
+// Executes every recorded command on backend, in the order recorded
+void render_recording_replay(const render_recording_t& recording, const render_backend_t& backend);
+
+// State changes in the stream: every command that binds something
+uint32_t render_recording_binds(const render_recording_t& recording);
+// True if both streams have the same commands, arguments and constant data
+bool render_recording_equal(const render_recording_t& a, const render_recording_t& b);
+void render_recording_dump(const render_recording_t& recording);
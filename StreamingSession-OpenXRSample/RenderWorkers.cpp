@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "RenderWorkers.h"
+#include "ThreadPolicy.h"
+
+#include <stdio.h>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void render_workers_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static uint64_t render_workers_now_ns() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Takes the next chunk until there are none left
+static void render_workers_run(render_workers_t& workers) {
+	for (uint32_t c = workers.next++; c < workers.chunk_count; c = workers.next++)
+		workers.fn(workers.chunks[c].context, c, workers.user);
+}
+
+static void render_workers_loop(render_workers_t* workers) {
+	thread_policy_apply(thread_role_worker);
+
+	uint64_t seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(workers->lock);
+			workers->doorbell.wait(lock, [&]() { return !workers->running || workers->generation != seen; });
+			if (!workers->running)
+				return;
+			seen = workers->generation;
+		}
+
+		render_workers_run(*workers);
+
+		std::lock_guard<std::mutex> lock(workers->lock);
+		if (--workers->busy == 0)
+			workers->done.notify_one();
+	}
+}
+
+void render_workers_start(render_workers_t& workers, uint32_t thread_count) {
+	for (uint32_t c = 0; c < RENDER_WORKERS_MAX_CHUNKS; c++) {
+		render_chunk_t& chunk = workers.chunks[c];
+		chunk.recording.forward = {};
+		render_init(chunk.context, render_recording_backend(chunk.recording));
+		chunk.replay = true;
+	}
+	workers.stats        = {};
+	workers.generation   = 0;
+	workers.busy         = 0;
+	workers.running      = true;
+	workers.thread_count = thread_count;
+	for (uint32_t t = 0; t < thread_count; t++)
+		workers.threads.emplace_back(render_workers_loop, &workers);
+}
+
+void render_workers_stop(render_workers_t& workers) {
+	{
+		std::lock_guard<std::mutex> lock(workers.lock);
+		workers.running = false;
+	}
+	workers.doorbell.notify_all();
+	for (size_t t = 0; t < workers.threads.size(); t++)
+		workers.threads[t].join();
+	workers.threads.clear();
+}
+
+void render_workers_set_backend(render_workers_t& workers, uint32_t chunk, const render_backend_t& backend) {
+	if (chunk >= RENDER_WORKERS_MAX_CHUNKS)
+		return;
+	render_init(workers.chunks[chunk].context, backend);
+	workers.chunks[chunk].replay = false;
+}
+
+void render_workers_record(render_workers_t& workers, uint32_t chunk_count, render_chunk_fn fn, void* user) {
+	if (chunk_count > RENDER_WORKERS_MAX_CHUNKS)
+		chunk_count = RENDER_WORKERS_MAX_CHUNKS;
+
+	// Recordings keep their capacity, so after the first few frames nothing
+	// here allocates
+	for (uint32_t c = 0; c < chunk_count; c++) {
+		render_chunk_t& chunk = workers.chunks[c];
+		render_invalidate(chunk.context);
+		chunk.context.stats = {};
+		render_recording_clear(chunk.recording);
+	}
+
+	uint64_t start = render_workers_now_ns();
+	{
+		std::lock_guard<std::mutex> lock(workers.lock);
+		workers.fn          = fn;
+		workers.user        = user;
+		workers.chunk_count = chunk_count;
+		workers.next        = 0;
+		workers.busy        = (uint32_t)workers.threads.size();
+		workers.generation++;
+	}
+	workers.doorbell.notify_all();
+
+	render_workers_run(workers);
+	{
+		std::unique_lock<std::mutex> lock(workers.lock);
+		workers.done.wait(lock, [&]() { return workers.busy == 0; });
+	}
+
+	workers.stats.frames       += 1;
+	workers.stats.chunks       += chunk_count;
+	workers.stats.record_ticks += render_workers_now_ns() - start;
+}
+
+void render_workers_submit(render_workers_t& workers, uint32_t chunk_count, render_context_t& target) {
+	if (chunk_count > RENDER_WORKERS_MAX_CHUNKS)
+		chunk_count = RENDER_WORKERS_MAX_CHUNKS;
+
+	uint64_t start = render_workers_now_ns();
+	for (uint32_t c = 0; c < chunk_count; c++) {
+		const render_chunk_t& chunk = workers.chunks[c];
+		if (chunk.replay)
+			render_recording_replay(chunk.recording, target.backend);
+
+		const render_stats_t& stats = chunk.context.stats;
+		for (int32_t i = 0; i < render_cmd_count; i++)
+			target.stats.commands[i] += stats.commands[i];
+		target.stats.redundant      += stats.redundant;
+		target.stats.constant_bytes += stats.constant_bytes;
+		target.stats.buffer_bytes   += stats.buffer_bytes;
+	}
+	render_invalidate(target);
+	workers.stats.submit_ticks += render_workers_now_ns() - start;
+}
+
+void render_workers_report(const render_workers_t& workers) {
+	const render_workers_stats_t& stats = workers.stats;
+	if (stats.frames == 0)
+		return;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Parallel recording: %u threads + caller, %.1f chunks per frame, %.3f ms recording and %.3f ms submitting per frame\n",
+		workers.thread_count, (double)stats.chunks / stats.frames,
+		stats.record_ticks / 1e6 / stats.frames, stats.submit_ticks / 1e6 / stats.frames);
+	render_workers_log(text);
+}
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "RenderBackend.h"
+
+// Records a frame's draws on several threads at once. The caller splits its
+// draws into chunks, and each chunk is recorded through its own
+// render_context_t by whichever thread takes it next, the calling thread
+// included. Chunks are then submitted in chunk order, so the command stream
+// the GPU sees is the same however the recording was scheduled.
+//
+// By default a chunk's context records into its render_recording_t, which
+// render_workers_submit replays to the target context's backend. A chunk can
+// instead be given a backend of its own that is safe to use from a worker,
+// such as a D3D11 deferred context, in which case the caller submits what it
+// produced, in chunk order, before calling render_workers_submit.
+//
+// The threads are started once and sleep between frames.
+
+#define RENDER_WORKERS_MAX_CHUNKS 16
+
+typedef void (*render_chunk_fn)(render_context_t& context, uint32_t chunk, void* user);
+
+typedef struct render_chunk_t {
+	render_context_t   context;
+	render_recording_t recording;
+	bool               replay; // Recorded, rather than executed by a backend of its own
+} render_chunk_t;
+
+typedef struct render_workers_stats_t {
+	uint64_t frames;
+	uint64_t chunks;
+	uint64_t record_ticks; // steady_clock nanoseconds, from the first chunk starting to the last one done
+	uint64_t submit_ticks;
+} render_workers_stats_t;
+
+typedef struct render_workers_t {
+	std::vector<std::thread> threads;
+	uint32_t                 thread_count;
+	render_chunk_t           chunks[RENDER_WORKERS_MAX_CHUNKS];
+	render_workers_stats_t   stats;
+
+	// The batch being recorded, guarded by lock
+	std::mutex              lock;
+	std::condition_variable doorbell;
+	std::condition_variable done;
+	uint64_t                generation;
+	uint32_t                busy; // Threads still working on this generation
+	bool                    running;
+	render_chunk_fn         fn;
+	void*                   user;
+	uint32_t                chunk_count;
+	std::atomic<uint32_t>   next;
+} render_workers_t;
+
+// thread_count threads besides the caller, 0 records everything on the caller
+void render_workers_start(render_workers_t& workers, uint32_t thread_count);
+void render_workers_stop (render_workers_t& workers);
+
+// Call before recording anything into chunk
+void render_workers_set_backend(render_workers_t& workers, uint32_t chunk, const render_backend_t& backend);
+
+// Calls fn once for every chunk in [0, chunk_count), spread over the threads,
+// each with the chunk's context, reset to know nothing of the bound state.
+// Returns once every chunk is recorded.
+void render_workers_record(render_workers_t& workers, uint32_t chunk_count, render_chunk_fn fn, void* user);
+
+// Replays the recorded chunks to target's backend in chunk order, and adds
+// every chunk's command counts to target's. The backend's state is whatever
+// the last chunk left, so target is invalidated.
+void render_workers_submit(render_workers_t& workers, uint32_t chunk_count, render_context_t& target);
+
+void render_workers_report(const render_workers_t& workers);
@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "Scene.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void scene_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+uint32_t scene_add_mesh(scene_t& scene, const scene_mesh_t& mesh) {
+	scene.meshes.push_back(mesh);
+	return (uint32_t)scene.meshes.size() - 1;
+}
+
+uint32_t scene_add_material(scene_t& scene, const scene_material_t& material) {
+	scene.materials.push_back(material);
+	return (uint32_t)scene.materials.size() - 1;
+}
+
+// Translation, and the mesh's radius grown by the largest axis scale
+static void scene_update_bounds(scene_t& scene, uint32_t object) {
+	const float (*m)[4] = scene.object_world[object].world;
+	float scale = 0.0f;
+	for (int32_t axis = 0; axis < 3; axis++) {
+		float length = sqrtf(m[0][axis] * m[0][axis] + m[1][axis] * m[1][axis] + m[2][axis] * m[2][axis]);
+		scale = length > scale ? length : scale;
+	}
+	const scene_bucket_t& bucket = scene.buckets[scene.object_bucket[object]];
+	scene.bounds.x     [object] = m[0][3];
+	scene.bounds.y     [object] = m[1][3];
+	scene.bounds.z     [object] = m[2][3];
+	scene.bounds.radius[object] = scene.meshes[bucket.mesh].radius * scale;
+}
+
+uint32_t scene_add_object(scene_t& scene, uint32_t mesh, uint32_t material, const scene_instance_t& world) {
+	// Few buckets, so a linear search is fine
+	uint32_t bucket = 0;
+	while (bucket < scene.buckets.size() && (scene.buckets[bucket].mesh != mesh || scene.buckets[bucket].material != material))
+		bucket++;
+	if (bucket == scene.buckets.size()) {
+		render_handle_t pipeline = scene.materials[material].pipeline;
+		uint32_t        index    = 0;
+		while (index < scene.pipelines.size() && scene.pipelines[index] != pipeline)
+			index++;
+		if (index == scene.pipelines.size())
+			scene.pipelines.push_back(pipeline);
+
+		scene_bucket_t added = {};
+		added.mesh     = mesh;
+		added.material = material;
+		added.pipeline = index;
+		scene.buckets.push_back(added);
+		scene.cursor .push_back(0);
+		draw_list_reserve(scene.draws, (uint32_t)scene.buckets.size());
+	}
+	scene.buckets[bucket].object_count++;
+
+	uint32_t object = (uint32_t)scene.object_bucket.size();
+	scene.object_bucket.push_back(bucket);
+	scene.object_world .push_back(world);
+	cull_bounds_add(scene.bounds, 0, 0, 0, 0);
+	scene_update_bounds(scene, object);
+
+	// Everything may be visible at once
+	scene.instances.reserve(scene.object_bucket.size());
+	return object;
+}
+
+void scene_set_world(scene_t& scene, uint32_t object, const scene_instance_t& world) {
+	scene.object_world[object] = world;
+	scene_update_bounds(scene, object);
+}
+
+void scene_build_instances(scene_t& scene, const uint32_t* visible, uint32_t visible_count) {
+	uint32_t bucket_count = (uint32_t)scene.buckets.size();
+	for (uint32_t b = 0; b < bucket_count; b++)
+		scene.buckets[b].instance_count = 0;
+	for (uint32_t i = 0; i < visible_count; i++)
+		scene.buckets[scene.object_bucket[visible[i]]].instance_count++;
+
+	uint32_t first = 0;
+	for (uint32_t b = 0; b < bucket_count; b++) {
+		scene.buckets[b].first_instance = first;
+		scene.cursor[b]                 = first;
+		first += scene.buckets[b].instance_count;
+		scene.stats.buckets += scene.buckets[b].instance_count > 0 ? 1 : 0;
+	}
+
+	scene.instances.resize(visible_count);
+	for (uint32_t i = 0; i < visible_count; i++) {
+		uint32_t object = visible[i];
+		scene.instances[scene.cursor[scene.object_bucket[object]]++] = scene.object_world[object];
+	}
+
+	scene.stats.frames    += 1;
+	scene.stats.instances += visible_count;
+}
+
+void scene_build_draws(scene_t& scene, const float eye[3], float depth_range, bool sort) {
+	draw_list_clear(scene.draws);
+	for (uint32_t b = 0; b < (uint32_t)scene.buckets.size(); b++) {
+		const scene_bucket_t& bucket = scene.buckets[b];
+		if (bucket.instance_count == 0)
+			continue;
+
+		float nearest = 3.4e38f;
+		for (uint32_t i = bucket.first_instance; i < bucket.first_instance + bucket.instance_count; i++) {
+			const float (*m)[4] = scene.instances[i].world;
+			float dx = m[0][3] - eye[0], dy = m[1][3] - eye[1], dz = m[2][3] - eye[2];
+			float distance = dx * dx + dy * dy + dz * dz;
+			nearest = distance < nearest ? distance : nearest;
+		}
+
+		const scene_material_t& material = scene.materials[bucket.material];
+		uint64_t key = draw_key(material.layer, material.pass, bucket.pipeline, bucket.material, bucket.mesh, sqrtf(nearest), depth_range);
+		draw_list_add(scene.draws, key, b);
+	}
+	if (sort)
+		draw_list_sort(scene.draws);
+}
+
+void scene_report(const scene_t& scene) {
+	const scene_stats_t& stats = scene.stats;
+	if (stats.frames == 0)
+		return;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Scene: %zu objects, %zu meshes, %zu materials in %zu buckets; per build %.1f instances in %.1f instanced draws\n",
+		scene.object_bucket.size(), scene.meshes.size(), scene.materials.size(), scene.buckets.size(),
+		(double)stats.instances / stats.frames, (double)stats.buckets / stats.frames);
+	scene_log(text);
+}
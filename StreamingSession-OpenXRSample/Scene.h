@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "RenderBackend.h"
+#include "Culling.h"
+#include "DrawSort.h"
+
+// Scene of objects that share meshes and materials. Each object is one
+// instance of a mesh drawn with a material. Objects with the same mesh and
+// material form a bucket, and a bucket is drawn with one instanced draw.
+//
+// Each frame, scene_build_instances takes the visible list from culling and
+// packs the world matrices of the visible objects into one array, bucket
+// after bucket, which is uploaded as the frame's instance buffer in one go.
+// A bucket then draws instances [first_instance, first_instance + instance_count)
+// of that buffer. scene_build_draws lists the buckets with anything visible
+// in sort key order (DrawSort.h), which is the order they are drawn in.
+//
+// Objects are kept as structure of arrays, and their culling bounds are
+// kept in step with their world matrices, so the scene is culled as is.
+
+// Per-instance vertex data. Stored transposed, the same as matrices in the
+// constant buffers.
+typedef struct scene_instance_t {
+	float world[4][4];
+} scene_instance_t;
+
+typedef struct scene_mesh_t {
+	render_handle_t vertex_buffer;
+	render_handle_t index_buffer;
+	uint32_t        vertex_stride;
+	uint32_t        index_size;
+	uint32_t        index_count;
+	float           radius; // Bounding sphere around the mesh's origin
+} scene_mesh_t;
+
+typedef struct scene_material_t {
+	render_handle_t pipeline;
+	render_handle_t stereo_pipeline; // Single pass stereo, nullptr if unavailable
+	float           tint[4];         // Multiplies the vertex color
+	uint32_t        layer;           // Drawn after every lower layer
+	draw_pass_t     pass;
+} scene_material_t;
+
+typedef struct scene_bucket_t {
+	uint32_t mesh;
+	uint32_t material;
+	uint32_t pipeline; // Index into scene_t::pipelines
+	uint32_t object_count;
+	uint32_t first_instance; // Visible instances, from the last scene_build_instances
+	uint32_t instance_count;
+} scene_bucket_t;
+
+typedef struct scene_stats_t {
+	uint64_t frames;
+	uint64_t instances;
+	uint64_t buckets; // Buckets with anything visible
+} scene_stats_t;
+
+typedef struct scene_t {
+	std::vector<scene_mesh_t>     meshes;
+	std::vector<scene_material_t> materials;
+	std::vector<scene_bucket_t>   buckets;
+	std::vector<render_handle_t>  pipelines; // Distinct material pipelines, numbered for the sort keys
+
+	// Objects
+	std::vector<uint32_t>         object_bucket;
+	std::vector<scene_instance_t> object_world;
+	cull_bounds_t                 bounds;
+
+	std::vector<scene_instance_t> instances; // Visible objects' world matrices, grouped by bucket
+	std::vector<uint32_t>         cursor;    // Scratch for scene_build_instances
+	draw_list_t                   draws;     // Buckets with anything visible, from scene_build_draws
+	scene_stats_t                 stats;
+} scene_t;
+
+uint32_t scene_add_mesh    (scene_t& scene, const scene_mesh_t& mesh);
+uint32_t scene_add_material(scene_t& scene, const scene_material_t& material);
+uint32_t scene_add_object  (scene_t& scene, uint32_t mesh, uint32_t material, const scene_instance_t& world);
+void     scene_set_world   (scene_t& scene, uint32_t object, const scene_instance_t& world);
+
+// Counting sort of visible objects into their buckets, no allocations once
+// every object has been added
+void scene_build_instances(scene_t& scene, const uint32_t* visible, uint32_t visible_count);
+
+// Lists the buckets with visible instances in draws, after
+// scene_build_instances. A bucket's depth is that of its nearest instance
+// from eye. Unsorted, they are listed in bucket order.
+void scene_build_draws(scene_t& scene, const float eye[3], float depth_range, bool sort);
+
+void scene_report(const scene_t& scene);
@@ -0,0 +1,311 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "ShaderCache.h"
+#include "ThreadPolicy.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <shlobj.h>
+#pragma comment(lib, "Shell32.lib")
+#pragma comment(lib, "Ole32.lib")
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Bump when the file layout or the key changes, old files then simply miss
+static const uint32_t shader_cache_magic   = 0x43485353; // 'SSHC'
+static const uint32_t shader_cache_version = 2;
+
+typedef struct shader_cache_file_t {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+	uint64_t size;
+} shader_cache_file_t;
+
+typedef struct shader_cache_stats_t {
+	uint32_t embedded;
+	uint32_t disk;
+	uint32_t compiled;
+	uint32_t failed;
+	double   lookup_ms;
+	double   compile_ms;
+} shader_cache_stats_t;
+
+static std::string          shader_cache_dir;
+static uint64_t             shader_cache_seed    = 0xcbf29ce484222325ull; // FNV offset basis, then the compiler hashed in
+static shader_compile_fn    shader_cache_compile = nullptr;
+static shader_cache_stats_t shader_cache_stats   = {};
+
+static const shader_embedded_t* shader_cache_embedded = nullptr;
+static std::vector<uint64_t>    shader_cache_embedded_keys;
+
+static void shader_cache_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static FILE* shader_cache_open(const char* path, const char* mode) {
+#ifdef _WIN32
+	FILE* file = nullptr;
+	return fopen_s(&file, path, mode) == 0 ? file : nullptr;
+#else
+	return fopen(path, mode);
+#endif
+}
+
+static uint64_t shader_fnv1a(uint64_t hash, const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+uint64_t shader_cache_key(const shader_desc_t& desc) {
+	// The terminators keep "ab"+"c" and "a"+"bc" from hashing the same
+	uint64_t hash = shader_cache_seed;
+	hash = shader_fnv1a(hash, desc.source, strlen(desc.source) + 1);
+	hash = shader_fnv1a(hash, desc.entry,  strlen(desc.entry)  + 1);
+	hash = shader_fnv1a(hash, desc.target, strlen(desc.target) + 1);
+	hash = shader_fnv1a(hash, &desc.flags, sizeof(desc.flags));
+	return hash;
+}
+
+static std::string shader_cache_path(uint64_t key) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+	return shader_cache_dir + "/" + name;
+}
+
+std::string shader_cache_default_directory(const char* app_name) {
+	std::string base;
+#ifdef _WIN32
+	PWSTR local_app_data = nullptr;
+	if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &local_app_data))) {
+		char path[MAX_PATH];
+		if (WideCharToMultiByte(CP_UTF8, 0, local_app_data, -1, path, sizeof(path), nullptr, nullptr) > 0)
+			base = path;
+	}
+	CoTaskMemFree(local_app_data);
+	if (base.empty()) {
+		char path[MAX_PATH];
+		DWORD length = GetModuleFileNameA(nullptr, path, sizeof(path));
+		if (length == 0 || length == sizeof(path))
+			return "";
+		std::string exe = path;
+		return exe.substr(0, exe.find_last_of("\\/")) + "/ShaderCache";
+	}
+#else
+	const char* cache = getenv("XDG_CACHE_HOME");
+	const char* home  = getenv("HOME");
+	if (cache && cache[0])     base = cache;
+	else if (home && home[0])  base = std::string(home) + "/.cache";
+	else {
+		char path[4096];
+		ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+		if (length <= 0)
+			return "";
+		path[length] = 0;
+		std::string exe = path;
+		return exe.substr(0, exe.find_last_of('/')) + "/ShaderCache";
+	}
+#endif
+	return base + "/" + app_name + "/ShaderCache";
+}
+
+void shader_cache_create_directory(const std::string& path) {
+	// Parents first. Existing directories just fail to be created again.
+	for (size_t i = 1; i <= path.size(); i++) {
+		if (i < path.size() && path[i] != '/' && path[i] != '\\')
+			continue;
+		std::string part = path.substr(0, i);
+#ifdef _WIN32
+		CreateDirectoryA(part.c_str(), nullptr);
+#else
+		mkdir(part.c_str(), 0755);
+#endif
+	}
+}
+
+void shader_cache_init(const char* directory, const char* compiler, shader_compile_fn compile,
+	const shader_embedded_t* embedded, uint32_t embedded_count) {
+	shader_cache_compile = compile;
+	shader_cache_stats   = {};
+	shader_cache_seed    = 0xcbf29ce484222325ull;
+	if (compiler)
+		shader_cache_seed = shader_fnv1a(shader_cache_seed, compiler, strlen(compiler) + 1);
+
+	// Keyed once, with the seed above, like any request
+	shader_cache_embedded = embedded;
+	shader_cache_embedded_keys.resize(embedded ? embedded_count : 0);
+	for (size_t i = 0; i < shader_cache_embedded_keys.size(); i++)
+		shader_cache_embedded_keys[i] = shader_cache_key(embedded[i].desc);
+
+	shader_cache_dir     = directory ? directory : "";
+	if (shader_cache_dir.empty())
+		return;
+	shader_cache_create_directory(shader_cache_dir);
+}
+
+static bool shader_cache_find_embedded(uint64_t key, std::vector<uint8_t>& bytecode) {
+	for (size_t i = 0; i < shader_cache_embedded_keys.size(); i++) {
+		if (shader_cache_embedded_keys[i] != key || shader_cache_embedded[i].size == 0)
+			continue;
+		bytecode.assign(shader_cache_embedded[i].bytecode, shader_cache_embedded[i].bytecode + shader_cache_embedded[i].size);
+		return true;
+	}
+	return false;
+}
+
+static bool shader_cache_read(uint64_t key, std::vector<uint8_t>& bytecode) {
+	if (shader_cache_dir.empty())
+		return false;
+
+	FILE* file = shader_cache_open(shader_cache_path(key).c_str(), "rb");
+	if (file == nullptr)
+		return false;
+
+	shader_cache_file_t header = {};
+	bool ok = fread(&header, sizeof(header), 1, file) == 1
+		&& header.magic   == shader_cache_magic
+		&& header.version == shader_cache_version
+		&& header.key     == key
+		&& header.size    >  0 && header.size < (64ull << 20);
+	if (ok) {
+		bytecode.resize((size_t)header.size);
+		ok = fread(bytecode.data(), 1, bytecode.size(), file) == bytecode.size();
+	}
+	fclose(file);
+	if (!ok) bytecode.clear();
+	return ok;
+}
+
+// Writes to a temporary file and renames it, so a crash mid-write can't leave
+// a truncated blob behind for the next launch.
+static void shader_cache_write(uint64_t key, const std::vector<uint8_t>& bytecode) {
+	if (shader_cache_dir.empty())
+		return;
+
+	std::string path = shader_cache_path(key);
+	std::string temp = path + ".tmp";
+	FILE* file = shader_cache_open(temp.c_str(), "wb");
+	if (file == nullptr)
+		return;
+
+	shader_cache_file_t header = { shader_cache_magic, shader_cache_version, key, bytecode.size() };
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(bytecode.data(), 1, bytecode.size(), file) == bytecode.size();
+	ok = fclose(file) == 0 && ok;
+	if (!ok) {
+		remove(temp.c_str());
+		return;
+	}
+#ifdef _WIN32
+	MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+	rename(temp.c_str(), path.c_str());
+#endif
+}
+
+bool shader_cache_get(const shader_desc_t* descs, shader_blob_t* blobs, uint32_t count) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// Cheap lookups first, collecting whatever still needs compiling
+	std::vector<uint32_t> misses;
+	std::vector<uint64_t> keys(count);
+	for (uint32_t i = 0; i < count; i++) {
+		keys[i]         = shader_cache_key(descs[i]);
+		blobs[i].origin = shader_origin_none;
+		blobs[i].bytecode.clear();
+		if (shader_cache_find_embedded(keys[i], blobs[i].bytecode)) {
+			blobs[i].origin = shader_origin_embedded;
+			shader_cache_stats.embedded++;
+		} else if (shader_cache_read(keys[i], blobs[i].bytecode)) {
+			blobs[i].origin = shader_origin_disk;
+			shader_cache_stats.disk++;
+		} else {
+			misses.push_back(i);
+		}
+	}
+	std::chrono::steady_clock::time_point looked_up = std::chrono::steady_clock::now();
+	shader_cache_stats.lookup_ms += std::chrono::duration<double, std::milli>(looked_up - start).count();
+
+	if (misses.empty() || shader_cache_compile == nullptr)
+		return misses.empty();
+
+	// Compile misses on worker threads. Each worker takes the next shader
+	// until there are none left, and the calling thread works too.
+	std::atomic<uint32_t> next{0};
+	auto compile_worker = [&]() {
+		for (uint32_t m = next++; m < misses.size(); m = next++) {
+			uint32_t i = misses[m];
+			if (shader_cache_compile(descs[i], blobs[i].bytecode)) {
+				blobs[i].origin = shader_origin_compiled;
+				shader_cache_write(keys[i], blobs[i].bytecode);
+			}
+		}
+	};
+
+	uint32_t hardware = std::thread::hardware_concurrency();
+	uint32_t workers  = (uint32_t)misses.size() - 1;
+	if (hardware > 1 && workers > hardware - 1) workers = hardware - 1;
+	if (hardware <= 1) workers = 0;
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < workers; t++) {
+		threads.emplace_back([&]() {
+			thread_policy_apply(thread_role_worker);
+			compile_worker();
+		});
+	}
+	compile_worker();
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	bool result = true;
+	for (size_t m = 0; m < misses.size(); m++) {
+		if (blobs[misses[m]].origin == shader_origin_compiled) {
+			shader_cache_stats.compiled++;
+		} else {
+			shader_cache_stats.failed++;
+			result = false;
+		}
+	}
+	shader_cache_stats.compile_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - looked_up).count();
+	return result;
+}
+
+void shader_cache_report() {
+	const shader_cache_stats_t& stats = shader_cache_stats;
+	char text[256];
+	snprintf(text, sizeof(text), "Shader cache: %s start, %.2f ms lookup + %.2f ms compile (%u embedded, %u from disk, %u compiled, %u failed) in %s\n",
+		stats.compiled + stats.failed > 0 ? "cold" : "warm",
+		stats.lookup_ms, stats.compile_ms,
+		stats.embedded, stats.disk, stats.compiled, stats.failed,
+		shader_cache_dir.empty() ? "no directory" : shader_cache_dir.c_str());
+	shader_cache_log(text);
+}
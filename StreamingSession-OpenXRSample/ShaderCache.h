@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Shader bytecode cache. Each shader is keyed by an FNV-1a hash of the
+// compiler's identity, and of its source, entry point, target and compile
+// flags, and looked up in three places:
+//   1. The embedded table, bytecode built into the executable along with
+//      the desc it was built from. Its keys are computed from those descs,
+//      so an entry only matches a request for the same source, entry point,
+//      target and flags.
+//   2. The disk cache, one <key>.cso file per shader.
+//   3. The compiler. Misses are compiled in parallel on worker threads and
+//      then written to the disk cache.
+//
+// The compiler is reached through shader_compile_fn, so the cache itself has
+// no graphics API dependency.
+
+typedef struct shader_desc_t {
+	const char* source;
+	const char* entry;
+	const char* target;
+	uint32_t    flags;
+} shader_desc_t;
+
+enum shader_origin_t {
+	shader_origin_none = 0, // Compile failed
+	shader_origin_embedded,
+	shader_origin_disk,
+	shader_origin_compiled,
+};
+
+typedef struct shader_blob_t {
+	std::vector<uint8_t> bytecode;
+	shader_origin_t      origin;
+} shader_blob_t;
+
+// Entry of the embedded table
+typedef struct shader_embedded_t {
+	shader_desc_t  desc;
+	const uint8_t* bytecode;
+	size_t         size;
+} shader_embedded_t;
+
+// Compiles one shader. Returns false and leaves bytecode empty on failure.
+// Called from several worker threads at once.
+typedef bool (*shader_compile_fn)(const shader_desc_t& desc, std::vector<uint8_t>& bytecode);
+
+uint64_t shader_cache_key(const shader_desc_t& desc);
+
+// Per-user cache directory for app_name: under %LOCALAPPDATA% on Windows,
+// and $XDG_CACHE_HOME or ~/.cache elsewhere. Falls back to ShaderCache next
+// to the executable. Never relative to the working directory.
+std::string shader_cache_default_directory(const char* app_name);
+
+// Creates path and any missing parent directories
+void shader_cache_create_directory(const std::string& path);
+
+// directory may be nullptr to skip the disk cache. compiler identifies the
+// compiler build, for example its DLL version, and goes into every key, so
+// an updated compiler never reuses bytecode from an older one. embedded is
+// kept, not copied, and may be nullptr.
+void shader_cache_init(const char* directory, const char* compiler, shader_compile_fn compile,
+	const shader_embedded_t* embedded, uint32_t embedded_count);
+
+// Fills blobs[0..count). Returns false if any shader failed to compile.
+bool shader_cache_get(const shader_desc_t* descs, shader_blob_t* blobs, uint32_t count);
+
+void shader_cache_report();
@@ -0,0 +1,49 @@
+// Full screen blits. ps_blit upscales the foveated periphery into the
+// swapchain image, color and depth both, leaving the full resolution fovea
+// alone. ps_mirror draws the spectator mirror. Built and included like
+// screen.hlsl.
+#ifdef __cplusplus
+R"_(")
+#endif
+Texture2D<float4> source_color : register(t0);
+Texture2D<float>  source_depth : register(t1);
+SamplerState      linear_clamp    : register(s0);
+SamplerState      point_clamp     : register(s1);
+
+cbuffer BlitBuffer : register(b2) {
+	float4 fovea_rect;
+	float4 dest_rect;
+	float4 source_scale;
+};
+
+// One triangle that covers the whole viewport
+float4 vs_blit(uint id : SV_VertexID) : SV_POSITION {
+	float2 uv = float2((id << 1) & 2, id & 2);
+	return float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+}
+
+struct blitOut {
+	float4 color : SV_TARGET;
+	float  depth : SV_DEPTH;
+};
+
+blitOut ps_blit(float4 pos : SV_POSITION) {
+	if (all(pos.xy >= fovea_rect.xy) && all(pos.xy < fovea_rect.zw))
+		discard;
+
+	float2 uv = (pos.xy - dest_rect.xy) / dest_rect.zw * source_scale.xy + source_scale.zw;
+	blitOut output;
+	output.color = source_color.SampleLevel(linear_clamp, uv, 0);
+	output.depth = source_depth.SampleLevel(point_clamp,  uv, 0);
+	return output;
+}
+
+// Mipmapped, so a large eye image downsamples into a small window cleanly
+float4 ps_mirror(float4 pos : SV_POSITION) : SV_TARGET {
+	float2 uv = (pos.xy - dest_rect.xy) / dest_rect.zw * source_scale.xy + source_scale.zw;
+	return float4(source_color.Sample(linear_clamp, uv).rgb, 1);
+}
+
+#ifdef __cplusplus
+")_"
+#endif
@@ -0,0 +1,11 @@
+// Vulkan version of the cube shader in Shaders/screen.hlsl, built with:
+//   glslangValidator -V cube.frag -o cube.frag.spv
+#version 450
+
+layout(location = 0) in vec3 in_color;
+
+layout(location = 0) out vec4 out_color;
+
+void main() {
+	out_color = vec4(in_color, 1.0);
+}
@@ -0,0 +1,40 @@
+// Vulkan version of the cube shader in Shaders/screen.hlsl, built with:
+//   glslangValidator -V cube.vert -o cube.vert.spv
+#version 450
+
+// Same bytes as app_material_buffer_t and app_view_buffer_t, pushed one
+// after the other. Matrices are stored transposed, as for HLSL, which GLSL's
+// column major layout reads back as the original, so the row vector math
+// below is the same as in HLSL.
+layout(push_constant) uniform Constants {
+	vec4 tint;
+	mat4 viewproj;
+};
+
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec3 in_color;
+layout(location = 2) in vec3 in_normal;
+
+// Per instance, scene_instance_t: the transposed world matrix, one row each,
+// which as columns make the original again
+layout(location = 3) in vec4 in_world0;
+layout(location = 4) in vec4 in_world1;
+layout(location = 5) in vec4 in_world2;
+layout(location = 6) in vec4 in_world3;
+
+layout(location = 0) out vec3 out_color;
+
+void main() {
+	mat4 world  = mat4(in_world0, in_world1, in_world2, in_world3);
+	gl_Position = vec4(in_pos, 1.0) * world * viewproj;
+
+	// Lighting calculation
+	vec3 light_dir    = normalize(vec3(0.5, 0.8, 0.3)); // Light from top-front-right
+	vec3 world_normal = normalize(in_normal * mat3(world));
+
+	// Ambient + Diffuse lighting, 30% ambient + 70% diffuse
+	float diffuse  = max(dot(world_normal, light_dir), 0.0);
+	float lighting = 0.3 + diffuse * 0.7;
+
+	out_color = in_color * lighting * tint.rgb;
+}
@@ -0,0 +1,93 @@
+// Cube shader with lighting. FxCompile builds each entry point into the
+// executable, for the shader cache's embedded table. main.cpp also includes
+// this file as a string, the source the cache keys on and D3DCompile falls
+// back to: the __cplusplus lines make it a C++ raw string literal there, and
+// leave nothing behind for HLSL.
+#ifdef __cplusplus
+R"_(")
+#endif
+cbuffer MaterialBuffer : register(b0) {
+	float4 tint;
+};
+
+cbuffer ViewBuffer : register(b1) {
+	float4x4 viewproj;
+};
+
+struct vsIn {
+	float3 pos : SV_POSITION;
+	float3 color : COLOR;
+	float3 normal : NORMAL;
+	// Per instance, scene_instance_t. The rows of the transposed world matrix.
+	float4 world0 : WORLD0;
+	float4 world1 : WORLD1;
+	float4 world2 : WORLD2;
+	float4 world3 : WORLD3;
+};
+
+cbuffer StereoViewBuffer : register(b2) {
+	float4x4 stereo_viewproj[2]; // Left, right
+};
+
+struct psIn {
+	float4 pos: SV_POSITION;
+	float3 color: COLOR;
+};
+
+struct psInStereo {
+	float4 pos : SV_POSITION;
+	float3 color : COLOR;
+	uint slice : SV_RenderTargetArrayIndex;
+};
+
+psIn shade(vsIn input, float4x4 view_proj) {
+	float4x4 world = transpose(float4x4(input.world0, input.world1, input.world2, input.world3));
+
+	psIn output;
+	output.pos = mul(float4(input.pos, 1), world);
+	output.pos = mul(output.pos, view_proj);
+
+	// Lighting calculation
+	float3 lightDir = normalize(float3(0.5, 0.8, 0.3)); // Light from top-front-right
+	float3 worldNormal = mul(input.normal, (float3x3)world); // Transform normal to world space
+	worldNormal = normalize(worldNormal);
+
+	// Diffuse lighting (dot product of normal and light direction)
+	float diffuse = max(dot(worldNormal, lightDir), 0.0);
+
+	// Ambient + Diffuse lighting
+	float ambient = 0.3; // Base ambient light
+	float lighting = ambient + (diffuse * 0.7); // 30% ambient + 70% diffuse
+
+	// Apply lighting to color
+	output.color = input.color * lighting * tint.rgb;
+
+	return output;
+}
+
+psIn vs(vsIn input) {
+	return shade(input, viewproj);
+}
+
+// Single pass stereo. Instances alternate between the eyes, and each eye
+// renders into its own slice of the render target array. The input layout
+// steps the instance data every other instance, so both eyes see the same
+// world matrix.
+psInStereo vs_stereo(vsIn input, uint instance : SV_InstanceID) {
+	uint eye = instance & 1;
+	psIn shaded = shade(input, stereo_viewproj[eye]);
+
+	psInStereo output;
+	output.pos = shaded.pos;
+	output.color = shaded.color;
+	output.slice = eye;
+	return output;
+}
+
+float4 ps(psIn input) : SV_TARGET {
+    return float4(input.color, 1.0);
+}
+
+#ifdef __cplusplus
+")_"
+#endif
@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "StartupGraph.h"
+#include "ThreadPolicy.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void startup_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+int32_t startup_add(startup_graph_t& graph, const char* name, startup_task_fn run, bool required,
+	int32_t dep0, int32_t dep1, int32_t dep2, int32_t dep3) {
+	startup_task_t task = {};
+	task.name     = name;
+	task.run      = run;
+	task.required = required;
+	int32_t deps[STARTUP_MAX_DEPS] = { dep0, dep1, dep2, dep3 };
+	for (int32_t i = 0; i < STARTUP_MAX_DEPS; i++) {
+		if (deps[i] >= 0 && deps[i] < (int32_t)graph.tasks.size())
+			task.deps[task.dep_count++] = deps[i];
+	}
+	graph.tasks.push_back(task);
+	return (int32_t)graph.tasks.size() - 1;
+}
+
+static double startup_elapsed_ms(const startup_graph_t& graph) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - graph.start).count();
+}
+
+// Finds a pending task whose dependencies are all finished. Tasks behind a
+// failed dependency are marked skipped on the way. Returns -1 if none is ready.
+static int32_t startup_next_ready(startup_graph_t& graph) {
+	for (size_t i = 0; i < graph.tasks.size(); i++) {
+		startup_task_t& task = graph.tasks[i];
+		if (task.status != startup_status_pending)
+			continue;
+
+		bool ready = true;
+		for (int32_t d = 0; d < task.dep_count; d++) {
+			startup_status_t dep = graph.tasks[task.deps[d]].status;
+			if (dep == startup_status_failed || dep == startup_status_skipped) {
+				task.status = startup_status_skipped;
+				ready = false;
+				break;
+			}
+			if (dep != startup_status_done)
+				ready = false;
+		}
+		if (ready)
+			return (int32_t)i;
+	}
+	return -1;
+}
+
+static bool startup_finished(const startup_graph_t& graph) {
+	for (size_t i = 0; i < graph.tasks.size(); i++) {
+		if (graph.tasks[i].status == startup_status_pending || graph.tasks[i].status == startup_status_running)
+			return false;
+	}
+	return true;
+}
+
+bool startup_run(startup_graph_t& graph, uint32_t worker_count) {
+	std::mutex              lock;
+	std::condition_variable changed;
+	graph.start = std::chrono::steady_clock::now();
+
+	auto worker = [&](uint32_t thread) {
+		std::unique_lock<std::mutex> guard(lock);
+		while (true) {
+			int32_t id = -1;
+			changed.wait(guard, [&]() { return (id = startup_next_ready(graph)) >= 0 || startup_finished(graph); });
+			if (id < 0)
+				break;
+
+			startup_task_t& task = graph.tasks[id];
+			task.status   = startup_status_running;
+			task.thread   = thread;
+			task.start_ms = startup_elapsed_ms(graph);
+			guard.unlock();
+
+			bool ok = task.run();
+
+			guard.lock();
+			task.end_ms = startup_elapsed_ms(graph);
+			task.status = ok ? startup_status_done : startup_status_failed;
+			// A finished task may unblock several others, or end the run
+			changed.notify_all();
+		}
+		// Skipping can finish the graph without any task completing, so
+		// make sure the other workers see it
+		changed.notify_all();
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 1; t <= worker_count; t++) {
+		threads.emplace_back([&worker, t]() {
+			thread_policy_apply(thread_role_worker);
+			worker(t);
+		});
+	}
+	worker(0);
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	graph.total_ms = startup_elapsed_ms(graph);
+
+	bool result = true;
+	for (size_t i = 0; i < graph.tasks.size(); i++) {
+		if (graph.tasks[i].required && graph.tasks[i].status != startup_status_done)
+			result = false;
+	}
+	return result;
+}
+
+void startup_report(const startup_graph_t& graph) {
+	const char* status_names[] = { "pending", "running", "ok", "FAILED", "skipped" };
+
+	// Walk back from the task that finished last, always through the
+	// dependency that finished last, since that is the one it waited on.
+	std::vector<bool> critical(graph.tasks.size(), false);
+	int32_t current = -1;
+	for (size_t i = 0; i < graph.tasks.size(); i++) {
+		if (graph.tasks[i].status == startup_status_done || graph.tasks[i].status == startup_status_failed) {
+			if (current < 0 || graph.tasks[i].end_ms > graph.tasks[current].end_ms)
+				current = (int32_t)i;
+		}
+	}
+	std::vector<int32_t> path;
+	while (current >= 0) {
+		critical[current] = true;
+		path.push_back(current);
+		const startup_task_t& task = graph.tasks[current];
+		int32_t latest = -1;
+		for (int32_t d = 0; d < task.dep_count; d++) {
+			if (latest < 0 || graph.tasks[task.deps[d]].end_ms > graph.tasks[latest].end_ms)
+				latest = task.deps[d];
+		}
+		current = latest;
+	}
+
+	char text[256];
+	snprintf(text, sizeof(text), "Startup timeline, %.1f ms total:\n", graph.total_ms);
+	startup_log(text);
+	for (size_t i = 0; i < graph.tasks.size(); i++) {
+		const startup_task_t& task = graph.tasks[i];
+		snprintf(text, sizeof(text), "  %c %-20s %8.1f - %8.1f ms  (%7.1f ms) thread %u %s\n",
+			critical[i] ? '*' : ' ', task.name, task.start_ms, task.end_ms, task.end_ms - task.start_ms,
+			task.thread, status_names[task.status]);
+		startup_log(text);
+	}
+
+	std::string chain;
+	for (size_t i = path.size(); i-- > 0;) {
+		chain += graph.tasks[path[i]].name;
+		if (i > 0) chain += " -> ";
+	}
+	startup_log("  Critical path: ");
+	startup_log(chain.c_str());
+	startup_log("\n");
+}
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <chrono>
+
+// Startup task graph. Each initialization step is a task that names the
+// tasks it depends on. startup_run runs every task as soon as its
+// dependencies have finished, using a few worker threads plus the calling
+// thread. Afterwards startup_report logs a timeline and the critical path,
+// which is the chain of tasks that actually determined how long startup took.
+//
+// A task that fails skips everything that depends on it. Optional tasks may
+// fail without failing startup.
+
+#define STARTUP_MAX_DEPS 4
+
+typedef bool (*startup_task_fn)();
+
+enum startup_status_t {
+	startup_status_pending = 0,
+	startup_status_running,
+	startup_status_done,
+	startup_status_failed,
+	startup_status_skipped, // A dependency failed or was skipped
+};
+
+typedef struct startup_task_t {
+	const char*      name;
+	startup_task_fn  run;
+	bool             required;
+	int32_t          deps[STARTUP_MAX_DEPS];
+	int32_t          dep_count;
+	startup_status_t status;
+	uint32_t         thread;   // Which worker ran it, 0 is the calling thread
+	double           start_ms; // Relative to the start of startup_run
+	double           end_ms;
+} startup_task_t;
+
+typedef struct startup_graph_t {
+	std::vector<startup_task_t>           tasks;
+	std::chrono::steady_clock::time_point start;
+	double                                total_ms;
+} startup_graph_t;
+
+// Returns the task's id, for use as a dependency of later tasks. Dependencies
+// must be added before the tasks that depend on them.
+int32_t startup_add(startup_graph_t& graph, const char* name, startup_task_fn run, bool required,
+	int32_t dep0 = -1, int32_t dep1 = -1, int32_t dep2 = -1, int32_t dep3 = -1);
+
+// Returns false if a required task failed or was skipped
+bool startup_run(startup_graph_t& graph, uint32_t worker_count);
+
+void startup_report(const startup_graph_t& graph);
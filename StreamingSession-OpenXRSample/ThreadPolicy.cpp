@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "ThreadPolicy.h"
+
+#include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#pragma comment(lib, "Winmm.lib")
+#include <windows.h>
+#include <timeapi.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+bool            thread_policy_enabled = true;
+thread_policy_t thread_policy_table[thread_role_count] = {
+	{ 0, thread_priority_highest, "Render"     },
+	{ 0, thread_priority_highest, "Frame"      },
+	{ 0, thread_priority_high,    "Channel I/O"},
+	{ 0, thread_priority_normal,  "Worker"     },
+	{ 0, thread_priority_low,     "Logger"     },
+};
+
+static std::mutex thread_policy_timer_lock;
+static int        thread_policy_timer_refs = 0;
+
+static void thread_policy_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+// Fills core_masks with one mask per physical core, holding that core's
+// logical processors, and returns how many there are. SMT siblings share a
+// core's execution units, so pinning two busy threads to siblings is little
+// better than pinning them to the same logical processor. Only the first 64
+// logical processors are considered, as in the rest of the policy.
+static uint32_t thread_policy_physical_cores(uint64_t* core_masks, uint32_t max_cores) {
+	uint32_t count = 0;
+#ifdef _WIN32
+	DWORD size = 0;
+	GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &size);
+	if (size == 0)
+		return 0;
+	std::vector<uint8_t> buffer(size);
+	if (!GetLogicalProcessorInformationEx(RelationProcessorCore, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buffer.data(), &size))
+		return 0;
+	for (DWORD offset = 0; offset < size && count < max_cores; ) {
+		const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info = (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)(buffer.data() + offset);
+		offset += info->Size;
+		// Thread affinity masks only reach the calling thread's group
+		if (info->Processor.GroupCount == 0 || info->Processor.GroupMask[0].Group != 0)
+			continue;
+		if (info->Processor.GroupMask[0].Mask != 0)
+			core_masks[count++] = (uint64_t)info->Processor.GroupMask[0].Mask;
+	}
+#else
+	uint32_t logical_count = std::thread::hardware_concurrency();
+	if (logical_count > 64) logical_count = 64;
+
+	// Logical processors with the same package and core id are siblings
+	int32_t core_keys[64];
+	for (uint32_t i = 0; i < logical_count; i++) {
+		int32_t ids[2] = { -1, -1 };
+		const char* files[2] = { "physical_package_id", "core_id" };
+		for (int32_t f = 0; f < 2; f++) {
+			char path[128];
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s", i, files[f]);
+			FILE* file = fopen(path, "r");
+			if (file == nullptr)
+				return 0;
+			if (fscanf(file, "%d", &ids[f]) != 1)
+				ids[f] = -1;
+			fclose(file);
+		}
+		int32_t  key  = ids[0] * 65536 + ids[1];
+		uint32_t core = 0;
+		while (core < count && core_keys[core] != key)
+			core++;
+		if (core == count) {
+			if (count == max_cores)
+				continue;
+			core_keys[count]  = key;
+			core_masks[count] = 0;
+			count++;
+		}
+		core_masks[core] |= 1ull << i;
+	}
+#endif
+	return count;
+}
+
+void thread_policy_init() {
+	uint64_t core_masks[64];
+	uint32_t core_count = thread_policy_physical_cores(core_masks, 64);
+	thread_policy_init_cores(core_masks, core_count, std::thread::hardware_concurrency());
+}
+
+void thread_policy_init_cores(const uint64_t* core_masks, uint32_t core_count, uint32_t logical_count) {
+	uint64_t all_cores = logical_count >= 64 ? ~0ull : ((1ull << logical_count) - 1);
+
+	// With only a few cores, pinning does more harm than good. Leave affinity
+	// to the OS and only adjust priorities. The same goes for when the
+	// topology can't be read, since logical indices alone could put the
+	// render and frame threads on siblings of one core.
+	if (core_count < 4) {
+		for (int32_t i = 0; i < thread_role_count; i++)
+			thread_policy_table[i].core_mask = 0;
+	} else {
+		// Core 0 tends to service most interrupts and DPCs, so the render
+		// thread goes on physical core 1 and the frame thread on core 2,
+		// each with all of its SMT siblings, so nothing else shares their
+		// execution units. Channel I/O and logging share the last core, and
+		// workers can use everything except the render and frame cores.
+		uint64_t render_core  = core_masks[1];
+		uint64_t frame_core   = core_masks[2];
+		uint64_t channel_core = core_masks[core_count - 1];
+		thread_policy_table[thread_role_render    ].core_mask = render_core;
+		thread_policy_table[thread_role_frame     ].core_mask = frame_core;
+		thread_policy_table[thread_role_channel_io].core_mask = channel_core;
+		thread_policy_table[thread_role_worker    ].core_mask = all_cores & ~(render_core | frame_core);
+		thread_policy_table[thread_role_logger    ].core_mask = channel_core;
+	}
+
+	char msg[256];
+	snprintf(msg, sizeof(msg), "Thread policy: %u logical processors on %u physical cores, render mask 0x%llx, frame mask 0x%llx, channel mask 0x%llx, worker mask 0x%llx\n",
+		logical_count, core_count,
+		(unsigned long long)thread_policy_table[thread_role_render    ].core_mask,
+		(unsigned long long)thread_policy_table[thread_role_frame     ].core_mask,
+		(unsigned long long)thread_policy_table[thread_role_channel_io].core_mask,
+		(unsigned long long)thread_policy_table[thread_role_worker    ].core_mask);
+	thread_policy_log(msg);
+}
+
+void thread_policy_apply(thread_role_t role) {
+	if (!thread_policy_enabled || role < 0 || role >= thread_role_count)
+		return;
+
+	const thread_policy_t& policy = thread_policy_table[role];
+	bool affinity_ok = true;
+	bool priority_ok = true;
+
+#ifdef _WIN32
+	HANDLE thread = GetCurrentThread();
+	if (policy.core_mask != 0)
+		affinity_ok = SetThreadAffinityMask(thread, (DWORD_PTR)policy.core_mask) != 0;
+
+	int win_priority = THREAD_PRIORITY_NORMAL;
+	switch (policy.priority) {
+	case thread_priority_low:     win_priority = THREAD_PRIORITY_BELOW_NORMAL; break;
+	case thread_priority_normal:  win_priority = THREAD_PRIORITY_NORMAL;       break;
+	case thread_priority_high:    win_priority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+	case thread_priority_highest: win_priority = THREAD_PRIORITY_HIGHEST;      break;
+	}
+	priority_ok = SetThreadPriority(thread, win_priority) != 0;
+
+	wchar_t wide_name[64];
+	MultiByteToWideChar(CP_UTF8, 0, policy.name, -1, wide_name, _countof(wide_name));
+	SetThreadDescription(thread, wide_name);
+#else
+	if (policy.core_mask != 0) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int32_t i = 0; i < 64 && i < CPU_SETSIZE; i++) {
+			if (policy.core_mask & (1ull << i))
+				CPU_SET(i, &set);
+		}
+		affinity_ok = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+	}
+
+	// SCHED_OTHER threads are prioritized by their per-thread nice value.
+	// Raising priority needs CAP_SYS_NICE, so failure there is expected for
+	// unprivileged users and only logged.
+	int nice_value = 0;
+	switch (policy.priority) {
+	case thread_priority_low:     nice_value =  5;  break;
+	case thread_priority_normal:  nice_value =  0;  break;
+	case thread_priority_high:    nice_value = -5;  break;
+	case thread_priority_highest: nice_value = -10; break;
+	}
+	priority_ok = setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice_value) == 0;
+
+	// Linux thread names are limited to 15 characters
+	char short_name[16];
+	snprintf(short_name, sizeof(short_name), "%s", policy.name);
+	pthread_setname_np(pthread_self(), short_name);
+#endif
+
+	if (!affinity_ok || !priority_ok) {
+		char msg[256];
+		snprintf(msg, sizeof(msg), "Thread policy: failed to apply %s%s for %s thread\n",
+			affinity_ok ? "" : "affinity ",
+			priority_ok ? "" : "priority ",
+			policy.name);
+		thread_policy_log(msg);
+	}
+}
+
+void thread_policy_timer_acquire() {
+	std::lock_guard<std::mutex> lock(thread_policy_timer_lock);
+	if (thread_policy_timer_refs++ == 0) {
+#ifdef _WIN32
+		timeBeginPeriod(1);
+#endif
+		thread_policy_log("Thread policy: raised timer resolution to 1 ms\n");
+	}
+}
+
+void thread_policy_timer_release() {
+	std::lock_guard<std::mutex> lock(thread_policy_timer_lock);
+	if (thread_policy_timer_refs == 0)
+		return;
+	if (--thread_policy_timer_refs == 0) {
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+		thread_policy_log("Thread policy: restored default timer resolution\n");
+	}
+}
+
+int32_t thread_policy_timer_held() {
+	std::lock_guard<std::mutex> lock(thread_policy_timer_lock);
+	return thread_policy_timer_refs;
+}
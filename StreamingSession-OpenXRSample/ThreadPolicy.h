@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+
+// Every thread the sample creates runs under one of these roles. The role
+// decides which cores the thread may run on and its scheduling priority.
+enum thread_role_t {
+	thread_role_render = 0,  // wWinMain / frame loop, owns the D3D11 immediate context
+	thread_role_frame,       // xrWaitFrame and simulation when the frame loop is pipelined
+	thread_role_channel_io,  // Opaque data channel connection and receive threads
+	thread_role_worker,      // General purpose worker threads
+	thread_role_logger,      // Background logging
+	thread_role_count,
+};
+
+// Relative priority, mapped to THREAD_PRIORITY_* on Win32 and to a nice
+// value on Linux.
+enum thread_priority_t {
+	thread_priority_low = -1,
+	thread_priority_normal = 0,
+	thread_priority_high = 1,
+	thread_priority_highest = 2,
+};
+
+struct thread_policy_t {
+	uint64_t          core_mask; // 0 = any core
+	thread_priority_t priority;
+	const char*       name;
+};
+
+extern bool            thread_policy_enabled;
+extern thread_policy_t thread_policy_table[thread_role_count];
+
+// Build the default policy table from the processor topology. The render and
+// frame threads each get a dedicated physical core, SMT siblings included,
+// that no other role is allowed on, so channel I/O can never be scheduled
+// onto them.
+void thread_policy_init();
+
+// The same, from a given topology: one mask of logical processors per
+// physical core, out of logical_count. thread_policy_init reads the real one.
+void thread_policy_init_cores(const uint64_t* core_masks, uint32_t core_count, uint32_t logical_count);
+
+// Apply the policy for role to the calling thread.
+void thread_policy_apply(thread_role_t role);
+
+// Ref-counted request for 1 ms system timer resolution. Held only while an
+// XR session is running so we don't keep the whole system at a high timer
+// rate while idle.
+void thread_policy_timer_acquire();
+void thread_policy_timer_release();
+int32_t thread_policy_timer_held(); // Outstanding requests
@@ -0,0 +1,501 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "Transforms.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_X86
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static void transform_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static uint64_t transform_now_ns() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////
+
+transform_mode_t transform_best_mode() {
+#ifdef TRANSFORM_X86
+	return transform_mode_sse; // Every x86 CPU that runs this has SSE2
+#else
+	return transform_mode_scalar;
+#endif
+}
+
+const char* transform_mode_name(transform_mode_t mode) {
+	switch (mode) {
+	case transform_mode_scalar: return "scalar";
+	case transform_mode_sse:    return "sse";
+	default:                    return "unknown";
+	}
+}
+
+transform_trs_t transform_identity() {
+	transform_trs_t result = { { 0, 0, 0 }, { 0, 0, 0, 1 }, { 1, 1, 1 } };
+	return result;
+}
+
+void transform_init(transform_t& transforms, transform_mode_t mode) {
+	transforms      = {};
+	transforms.mode = mode;
+}
+
+uint32_t transform_add(transform_t& transforms, uint32_t parent, const transform_trs_t& local) {
+	// Appending keeps parents before children, so storage order stays
+	// topological until the next sort
+	uint32_t node     = (uint32_t)transforms.index.size();
+	uint32_t position = (uint32_t)transforms.node.size();
+	transforms.index .push_back(position);
+	transforms.node  .push_back(node);
+	transforms.parent.push_back(parent == TRANSFORM_NONE ? TRANSFORM_NONE : transforms.index[parent]);
+	transforms.dirty .push_back(0);
+	for (int32_t k = 0; k < transform_local_count; k++)
+		transforms.local[k].push_back(0.0f);
+	for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+		transforms.world[k].push_back(0.0f);
+	transforms.sorted = false;
+
+	transform_set_local(transforms, node, local);
+	return node;
+}
+
+void transform_set_local(transform_t& transforms, uint32_t node, const transform_trs_t& local) {
+	uint32_t i = transforms.index[node];
+	transforms.local[transform_px][i] = local.position[0];
+	transforms.local[transform_py][i] = local.position[1];
+	transforms.local[transform_pz][i] = local.position[2];
+	transforms.local[transform_qx][i] = local.rotation[0];
+	transforms.local[transform_qy][i] = local.rotation[1];
+	transforms.local[transform_qz][i] = local.rotation[2];
+	transforms.local[transform_qw][i] = local.rotation[3];
+	transforms.local[transform_sx][i] = local.scale[0];
+	transforms.local[transform_sy][i] = local.scale[1];
+	transforms.local[transform_sz][i] = local.scale[2];
+	if (!transforms.dirty[i]) {
+		transforms.dirty[i] = 1;
+		transforms.dirty_count++;
+		// Unsorted, the lists are built from dirty by transform_sort
+		if (transforms.sorted) {
+			uint32_t level = transforms.level[i];
+			transforms.dirty_list[transforms.level_start[level] + transforms.level_dirty[level]++] = i;
+		}
+	}
+}
+
+template <typename T>
+static void transform_permute(std::vector<T>& values, const std::vector<uint32_t>& position) {
+	std::vector<T> sorted(values.size());
+	for (size_t i = 0; i < values.size(); i++)
+		sorted[position[i]] = values[i];
+	values.swap(sorted);
+}
+
+// Parents are always stored before their children, whatever order nodes
+// were added in, so storage order is already topological. Sorting groups the
+// levels and each node's children.
+static void transform_sort(transform_t& transforms) {
+	uint32_t count = (uint32_t)transforms.node.size();
+
+	// Children of every node, in storage order
+	std::vector<uint32_t> child_start(count + 1, 0);
+	std::vector<uint32_t> children(count);
+	for (uint32_t i = 0; i < count; i++) {
+		if (transforms.parent[i] != TRANSFORM_NONE)
+			child_start[transforms.parent[i] + 1]++;
+	}
+	for (uint32_t i = 0; i < count; i++)
+		child_start[i + 1] += child_start[i];
+	std::vector<uint32_t> cursor(child_start.begin(), child_start.end() - 1);
+	for (uint32_t i = 0; i < count; i++) {
+		if (transforms.parent[i] != TRANSFORM_NONE)
+			children[cursor[transforms.parent[i]]++] = i;
+	}
+
+	// Breadth first: the roots, then each node's children after those of
+	// the node before it. A level ends where the children of the level
+	// before it end.
+	std::vector<uint32_t> order; // Storage index, by sorted position
+	order.reserve(count);
+	for (uint32_t i = 0; i < count; i++) {
+		if (transforms.parent[i] == TRANSFORM_NONE)
+			order.push_back(i);
+	}
+	transforms.level_start.assign(1, 0);
+	transforms.child_first.resize(count + 1);
+	size_t level_end = order.size();
+	for (uint32_t q = 0; q < count; q++) {
+		if (q == level_end) {
+			transforms.level_start.push_back(q);
+			level_end = order.size();
+		}
+		uint32_t i = order[q];
+		transforms.child_first[q] = (uint32_t)order.size();
+		order.insert(order.end(), children.begin() + child_start[i], children.begin() + child_start[i + 1]);
+	}
+	transforms.level_start.push_back(count);
+	transforms.child_first[count] = count;
+
+	std::vector<uint32_t> position(count);
+	for (uint32_t q = 0; q < count; q++)
+		position[order[q]] = q;
+	for (uint32_t i = 0; i < count; i++) {
+		if (transforms.parent[i] != TRANSFORM_NONE)
+			transforms.parent[i] = position[transforms.parent[i]];
+	}
+	transform_permute(transforms.parent, position);
+	transform_permute(transforms.node,   position);
+	transform_permute(transforms.dirty,  position);
+	for (int32_t k = 0; k < transform_local_count; k++)
+		transform_permute(transforms.local[k], position);
+	for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+		transform_permute(transforms.world[k], position);
+	for (uint32_t i = 0; i < count; i++)
+		transforms.index[transforms.node[i]] = i;
+
+	// Each level's list can hold every node of the level, so marking nodes
+	// never allocates
+	uint32_t levels = (uint32_t)transforms.level_start.size() - 1;
+	transforms.level.resize(count);
+	transforms.dirty_list.resize(count);
+	transforms.level_dirty.assign(levels, 0);
+	for (uint32_t level = 0; level < levels; level++) {
+		for (uint32_t i = transforms.level_start[level]; i < transforms.level_start[level + 1]; i++) {
+			transforms.level[i] = level;
+			if (transforms.dirty[i])
+				transforms.dirty_list[transforms.level_start[level] + transforms.level_dirty[level]++] = i;
+		}
+	}
+
+	// Every node may change in one update
+	transforms.changed.reserve(count);
+	transforms.sorted = true;
+}
+
+///////////////////////////////////////////
+
+// The local matrix is T * R * S for column vectors: rotation times scale in
+// the upper 3x3, translation in the last column. The world matrix is the
+// parent's world matrix times that. Both paths evaluate every term in the
+// same order.
+static void transform_update_scalar(transform_t& transforms, uint32_t first, uint32_t end) {
+	float*          w[TRANSFORM_WORLD];
+	const float*    l[transform_local_count];
+	const uint32_t* parent = transforms.parent.data();
+	for (int32_t k = 0; k < TRANSFORM_WORLD; k++)       w[k] = transforms.world[k].data();
+	for (int32_t k = 0; k < transform_local_count; k++) l[k] = transforms.local[k].data();
+
+	for (uint32_t i = first; i < end; i++) {
+		float x2 = l[transform_qx][i] + l[transform_qx][i];
+		float y2 = l[transform_qy][i] + l[transform_qy][i];
+		float z2 = l[transform_qz][i] + l[transform_qz][i];
+		float xx = l[transform_qx][i] * x2, yy = l[transform_qy][i] * y2, zz = l[transform_qz][i] * z2;
+		float xy = l[transform_qx][i] * y2, xz = l[transform_qx][i] * z2, yz = l[transform_qy][i] * z2;
+		float wx = l[transform_qw][i] * x2, wy = l[transform_qw][i] * y2, wz = l[transform_qw][i] * z2;
+		float sx = l[transform_sx][i], sy = l[transform_sy][i], sz = l[transform_sz][i];
+
+		float m[TRANSFORM_WORLD] = {
+			(1.0f - (yy + zz)) * sx, (xy - wz) * sy,          (xz + wy) * sz,          l[transform_px][i],
+			(xy + wz) * sx,          (1.0f - (xx + zz)) * sy, (yz - wx) * sz,          l[transform_py][i],
+			(xz - wy) * sx,          (yz + wx) * sy,          (1.0f - (xx + yy)) * sz, l[transform_pz][i],
+		};
+
+		uint32_t p = parent[i];
+		if (p == TRANSFORM_NONE) {
+			for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+				w[k][i] = m[k];
+			continue;
+		}
+		for (int32_t r = 0; r < 3; r++) {
+			float p0 = w[r * 4 + 0][p], p1 = w[r * 4 + 1][p], p2 = w[r * 4 + 2][p], p3 = w[r * 4 + 3][p];
+			w[r * 4 + 0][i] = (p0 * m[0] + p1 * m[4]) + p2 * m[8];
+			w[r * 4 + 1][i] = (p0 * m[1] + p1 * m[5]) + p2 * m[9];
+			w[r * 4 + 2][i] = (p0 * m[2] + p1 * m[6]) + p2 * m[10];
+			w[r * 4 + 3][i] = ((p0 * m[3] + p1 * m[7]) + p2 * m[11]) + p3;
+		}
+	}
+}
+
+#ifdef TRANSFORM_X86
+static void transform_update_sse(transform_t& transforms, uint32_t first, uint32_t end, bool roots) {
+	float*          w[TRANSFORM_WORLD];
+	const float*    l[transform_local_count];
+	const uint32_t* parent = transforms.parent.data();
+	for (int32_t k = 0; k < TRANSFORM_WORLD; k++)       w[k] = transforms.world[k].data();
+	for (int32_t k = 0; k < transform_local_count; k++) l[k] = transforms.local[k].data();
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	uint32_t     i   = first;
+	for (; i + 4 <= end; i += 4) {
+		__m128 qx = _mm_loadu_ps(l[transform_qx] + i), qy = _mm_loadu_ps(l[transform_qy] + i);
+		__m128 qz = _mm_loadu_ps(l[transform_qz] + i), qw = _mm_loadu_ps(l[transform_qw] + i);
+		__m128 sx = _mm_loadu_ps(l[transform_sx] + i), sy = _mm_loadu_ps(l[transform_sy] + i);
+		__m128 sz = _mm_loadu_ps(l[transform_sz] + i);
+		__m128 x2 = _mm_add_ps(qx, qx), y2 = _mm_add_ps(qy, qy), z2 = _mm_add_ps(qz, qz);
+		__m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+		__m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+		__m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+
+		__m128 m[TRANSFORM_WORLD] = {
+			_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_loadu_ps(l[transform_px] + i),
+			_mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_loadu_ps(l[transform_py] + i),
+			_mm_mul_ps(_mm_sub_ps(xz, wy), sx), _mm_mul_ps(_mm_add_ps(yz, wx), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), _mm_loadu_ps(l[transform_pz] + i),
+		};
+
+		// Level 0 is all roots, every other level has a parent in each lane
+		if (roots) {
+			for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+				_mm_storeu_ps(w[k] + i, m[k]);
+			continue;
+		}
+		uint32_t p0 = parent[i], p1 = parent[i + 1], p2 = parent[i + 2], p3 = parent[i + 3];
+		for (int32_t r = 0; r < 3; r++) {
+			__m128 pw[4];
+			for (int32_t c = 0; c < 4; c++) {
+				const float* column = w[r * 4 + c];
+				pw[c] = _mm_setr_ps(column[p0], column[p1], column[p2], column[p3]);
+			}
+			_mm_storeu_ps(w[r * 4 + 0] + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(pw[0], m[0]), _mm_mul_ps(pw[1], m[4])), _mm_mul_ps(pw[2], m[8])));
+			_mm_storeu_ps(w[r * 4 + 1] + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(pw[0], m[1]), _mm_mul_ps(pw[1], m[5])), _mm_mul_ps(pw[2], m[9])));
+			_mm_storeu_ps(w[r * 4 + 2] + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(pw[0], m[2]), _mm_mul_ps(pw[1], m[6])), _mm_mul_ps(pw[2], m[10])));
+			_mm_storeu_ps(w[r * 4 + 3] + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pw[0], m[3]), _mm_mul_ps(pw[1], m[7])), _mm_mul_ps(pw[2], m[11])), pw[3]));
+		}
+	}
+	transform_update_scalar(transforms, i, end);
+}
+#endif
+
+// Nodes [first, end) all belong to one level
+static void transform_update_run(transform_t& transforms, uint32_t first, uint32_t end, bool roots) {
+#ifdef TRANSFORM_X86
+	if (transforms.mode == transform_mode_sse) {
+		transform_update_sse(transforms, first, end, roots);
+		return;
+	}
+#endif
+	transform_update_scalar(transforms, first, end);
+}
+
+uint32_t transform_update(transform_t& transforms) {
+	if (!transforms.sorted)
+		transform_sort(transforms);
+
+	uint64_t start = transform_now_ns();
+	transforms.changed.clear();
+	if (transforms.dirty_count > 0) {
+		uint8_t*        dirty       = transforms.dirty.data();
+		const uint32_t* child_first = transforms.child_first.data();
+		uint32_t        levels      = (uint32_t)transforms.level_start.size() - 1;
+
+		for (uint32_t level = 0; level < levels; level++) {
+			uint32_t* list  = transforms.dirty_list.data() + transforms.level_start[level];
+			uint32_t  count = transforms.level_dirty[level];
+			if (count == 0)
+				continue;
+			transforms.level_dirty[level] = 0;
+
+			// In order, so adjacent dirty nodes form runs
+			std::sort(list, list + count);
+			uint32_t* next = level + 1 < levels ? transforms.dirty_list.data() + transforms.level_start[level + 1] : nullptr;
+			for (uint32_t d = 0; d < count;) {
+				uint32_t run = list[d];
+				uint32_t end = run;
+				for (; d < count && list[d] == end; d++, end++) {
+					// Each dirty node takes its children along into the
+					// next level's list
+					dirty[end] = 0;
+					for (uint32_t c = child_first[end]; c < child_first[end + 1]; c++) {
+						if (!dirty[c]) {
+							dirty[c] = 1;
+							next[transforms.level_dirty[level + 1]++] = c;
+						}
+					}
+					transforms.changed.push_back(transforms.node[end]);
+				}
+				transform_update_run(transforms, run, end, level == 0);
+			}
+		}
+		transforms.dirty_count = 0;
+	}
+
+	uint32_t updated = (uint32_t)transforms.changed.size();
+	transforms.stats.frames  += 1;
+	transforms.stats.updated += updated;
+	transforms.stats.ticks   += transform_now_ns() - start;
+	return updated;
+}
+
+void transform_get_world(const transform_t& transforms, uint32_t node, float world[4][4]) {
+	uint32_t i = transforms.index[node];
+	for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+		world[k / 4][k % 4] = transforms.world[k][i];
+	world[3][0] = 0.0f;
+	world[3][1] = 0.0f;
+	world[3][2] = 0.0f;
+	world[3][3] = 1.0f;
+}
+
+void transform_report(const transform_t& transforms) {
+	const transform_stats_t& stats = transforms.stats;
+	if (stats.frames == 0)
+		return;
+
+	char text[256];
+	snprintf(text, sizeof(text), "Transforms (%s): %zu nodes in %zu levels, %.1f updated per frame, %.2f us per frame\n",
+		transform_mode_name(transforms.mode), transforms.node.size(), transforms.level_start.empty() ? 0 : transforms.level_start.size() - 1,
+		(double)stats.updated / stats.frames, stats.ticks / 1000.0 / stats.frames);
+	transform_log(text);
+}
+
+///////////////////////////////////////////
+
+static uint32_t transform_random(uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static float transform_random_range(uint32_t& state, float min, float max) {
+	return min + (max - min) * (transform_random(state) & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+static transform_trs_t transform_random_trs(uint32_t& state) {
+	transform_trs_t result;
+	for (int32_t k = 0; k < 3; k++) {
+		result.position[k] = transform_random_range(state, -1.0f, 1.0f);
+		result.scale   [k] = transform_random_range(state, 0.9f, 1.1f);
+	}
+	float length = 0.0f;
+	for (int32_t k = 0; k < 4; k++) {
+		result.rotation[k] = transform_random_range(state, -1.0f, 1.0f);
+		length += result.rotation[k] * result.rotation[k];
+	}
+	length = sqrtf(std::max(length, 1e-6f));
+	for (int32_t k = 0; k < 4; k++)
+		result.rotation[k] /= length;
+	return result;
+}
+
+// Worst difference between two sets of world matrices, relative to their size
+static float transform_difference(const std::vector<float>* a, const std::vector<float>* b) {
+	float worst = 0.0f;
+	for (int32_t k = 0; k < TRANSFORM_WORLD; k++) {
+		for (size_t i = 0; i < a[k].size(); i++)
+			worst = std::max(worst, fabsf(a[k][i] - b[k][i]) / (1.0f + fabsf(a[k][i])));
+	}
+	return worst;
+}
+
+// Like transform_set_local on every node, without changing any
+static void transform_mark_all(transform_t& transforms) {
+	memset(transforms.dirty.data(), 1, transforms.dirty.size());
+	transforms.dirty_count = (uint32_t)transforms.dirty.size();
+	for (uint32_t level = 0; level + 1 < transforms.level_start.size(); level++) {
+		uint32_t first = transforms.level_start[level];
+		uint32_t end   = transforms.level_start[level + 1];
+		for (uint32_t i = first; i < end; i++)
+			transforms.dirty_list[i] = i;
+		transforms.level_dirty[level] = end - first;
+	}
+}
+
+bool transform_benchmark(uint32_t max_nodes) {
+	transform_mode_t best = transform_best_mode();
+	char text[256];
+	snprintf(text, sizeof(text), "Transform benchmark, best mode %s\n", transform_mode_name(best));
+	transform_log(text);
+
+	const float tolerance = 1e-4f;
+	bool        passed    = true;
+	for (uint32_t node_count = 1000; node_count <= max_nodes; node_count *= 10) {
+		// A forest of random trees: one node in 64 is a root, the rest hang
+		// off any node added before them
+		uint32_t    seed = 0x2545F491;
+		transform_t transforms;
+		transform_init(transforms, transform_mode_scalar);
+		for (uint32_t i = 0; i < node_count; i++) {
+			uint32_t parent = i == 0 || transform_random(seed) % 64 == 0 ? TRANSFORM_NONE : transform_random(seed) % i;
+			transform_add(transforms, parent, transform_random_trs(seed));
+		}
+		transform_update(transforms);
+
+		// Everything dirty, as on the first frame or with every node animated
+		uint32_t           repeat = std::max(1u, 4000000u / node_count);
+		double             ns_per_node[transform_mode_count] = {};
+		std::vector<float> reference[TRANSFORM_WORLD];
+		for (int32_t mode = 0; mode < transform_mode_count; mode++) {
+			if (mode > best)
+				continue;
+			transforms.mode = (transform_mode_t)mode;
+			uint64_t start  = transform_now_ns();
+			for (uint32_t r = 0; r < repeat; r++) {
+				transform_mark_all(transforms);
+				transform_update(transforms);
+			}
+			ns_per_node[mode] = (double)(transform_now_ns() - start) / ((double)repeat * node_count);
+
+			if (mode == transform_mode_scalar) {
+				for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+					reference[k] = transforms.world[k];
+			} else if (transform_difference(reference, transforms.world) > tolerance) {
+				snprintf(text, sizeof(text), "  %u nodes: %s disagrees with scalar\n", node_count, transform_mode_name((transform_mode_t)mode));
+				transform_log(text);
+				passed = false;
+			}
+		}
+
+		// A few nodes animated, each taking its subtree along
+		transforms.mode = best;
+		uint32_t moving  = std::max(1u, node_count / 1000);
+		uint64_t updated = 0;
+		uint64_t start   = transform_now_ns();
+		for (uint32_t r = 0; r < repeat; r++) {
+			for (uint32_t m = 0; m < moving; m++)
+				transform_set_local(transforms, transform_random(seed) % node_count, transform_random_trs(seed));
+			updated += transform_update(transforms);
+		}
+		double partial_us = (double)(transform_now_ns() - start) / 1000.0 / repeat;
+
+		for (int32_t k = 0; k < TRANSFORM_WORLD; k++)
+			reference[k] = transforms.world[k];
+		transform_mark_all(transforms);
+		transform_update(transforms);
+		if (transform_difference(reference, transforms.world) > tolerance) {
+			snprintf(text, sizeof(text), "  %u nodes: updating dirty nodes only differs from updating all of them\n", node_count);
+			transform_log(text);
+			passed = false;
+		}
+
+		snprintf(text, sizeof(text), "  %7u nodes in %2zu levels: all dirty, scalar %.2f, sse %.2f ns/node; %u moved, %.0f nodes updated in %.1f us/frame\n",
+			node_count, transforms.level_start.size() - 1, ns_per_node[transform_mode_scalar], ns_per_node[transform_mode_sse],
+			moving, (double)updated / repeat, partial_us);
+		transform_log(text);
+	}
+	return passed;
+}
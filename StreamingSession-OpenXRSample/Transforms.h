@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Transform hierarchy. Every node has a local translation, rotation and
+// scale relative to its parent, and transform_update turns them into world
+// matrices once per frame. Every view, and the spectator, then reads the
+// same world matrices.
+//
+// Nodes are kept as structure of arrays, each component of the local
+// transforms and of the world matrices in its own array. They are sorted
+// breadth first: one depth level after another, so parents always come
+// before their children and a level's nodes don't depend on each other, and
+// within a level each node's children next to each other.
+//
+// Only dirty nodes, those whose local transform changed and everything below
+// them, are recomputed. Each level keeps a list of its dirty nodes, so an
+// update costs in proportion to what changed, not to the size of the
+// hierarchy. A dirty node adds its children, one contiguous range, to the
+// next level's list as it is updated. Each list is sorted, and runs of
+// adjacent dirty nodes go through SSE 4 at a time, with the parents' world
+// matrices gathered per lane.
+//
+// There are no graphics dependencies here, and transform_benchmark runs
+// without OpenXR or a GPU.
+
+#define TRANSFORM_NONE 0xFFFFFFFF
+
+enum transform_mode_t {
+	transform_mode_scalar = 0,
+	transform_mode_sse,
+	transform_mode_count,
+};
+
+// Components of the local transforms, one array each
+enum transform_local_t {
+	transform_px = 0, transform_py, transform_pz,
+	transform_qx, transform_qy, transform_qz, transform_qw,
+	transform_sx, transform_sy, transform_sz,
+	transform_local_count,
+};
+
+// World matrices are the top 3 rows of a 4x4 that transforms column
+// vectors, row major, translation in the last column. That is the same
+// layout as the transposed matrices in the constant buffers.
+#define TRANSFORM_WORLD 12
+
+typedef struct transform_trs_t {
+	float position[3];
+	float rotation[4]; // Quaternion, x y z w
+	float scale[3];
+} transform_trs_t;
+
+typedef struct transform_stats_t {
+	uint64_t frames;
+	uint64_t updated; // Nodes recomputed
+	uint64_t ticks;   // steady_clock nanoseconds spent in transform_update
+} transform_stats_t;
+
+typedef struct transform_t {
+	transform_mode_t mode;
+
+	// By node id, as transform_add returned them
+	std::vector<uint32_t> index; // Position in the sorted arrays
+
+	// By sorted position
+	std::vector<uint32_t> node;        // Node id
+	std::vector<uint32_t> parent;      // Sorted position, TRANSFORM_NONE for roots
+	std::vector<uint32_t> child_first; // Children are [child_first[i], child_first[i + 1])
+	std::vector<uint8_t>  dirty;
+	std::vector<uint32_t> level;       // Depth level
+	std::vector<uint32_t> dirty_list;  // Dirty positions of each level, stored in that level's own range
+	std::vector<float>    local[transform_local_count];
+	std::vector<float>    world[TRANSFORM_WORLD];
+	std::vector<uint32_t> level_start; // First position of each depth level, then the end
+	std::vector<uint32_t> level_dirty; // Entries in each level's part of dirty_list
+
+	std::vector<uint32_t> changed; // Ids recomputed by the last transform_update
+	uint32_t              dirty_count;
+	bool                  sorted;
+	transform_stats_t     stats;
+} transform_t;
+
+// The fastest mode this CPU supports
+transform_mode_t transform_best_mode();
+const char*      transform_mode_name(transform_mode_t mode);
+
+transform_trs_t transform_identity();
+
+void transform_init(transform_t& transforms, transform_mode_t mode);
+
+// The parent has to be added before its children. Adding nodes re-sorts on
+// the next transform_update, which allocates, so add them up front.
+uint32_t transform_add      (transform_t& transforms, uint32_t parent, const transform_trs_t& local);
+void     transform_set_local(transform_t& transforms, uint32_t node, const transform_trs_t& local);
+
+// Recomputes the world matrix of every dirty node, and returns how many
+// there were. Allocates nothing once sorted.
+uint32_t transform_update(transform_t& transforms);
+
+// A node's world matrix as a full 4x4, transposed like the matrices in the
+// constant buffers
+void transform_get_world(const transform_t& transforms, uint32_t node, float world[4][4]);
+
+void transform_report(const transform_t& transforms);
+
+// Updates random hierarchies of 1k up to max_nodes, all of them and a few
+// dirty nodes at a time, with every mode. Checks the modes agree and that
+// updating only dirty nodes gives the same matrices as updating all of them.
+bool transform_benchmark(uint32_t max_nodes);
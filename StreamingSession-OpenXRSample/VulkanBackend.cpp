@@ -0,0 +1,1068 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#include "VulkanBackend.h"
+
+#ifdef XR_SAMPLE_VULKAN
+
+#include "ShaderCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "vulkan-1.lib")
+#endif
+
+// Kept next to the shader cache, it is the same kind of data
+static std::string vk_pipeline_cache_dir() {
+	return shader_cache_default_directory("StreamingSession-OpenXRSample");
+}
+
+static const VkFormat vk_depth_format = VK_FORMAT_D32_SFLOAT;
+
+typedef struct vk_pipeline_t {
+	VkPipeline pipeline;
+} vk_pipeline_t;
+
+typedef struct vk_frame_t {
+	VkCommandBuffer commands; // Allocated once, re-recorded every time the slot comes around
+	VkFence         fence;    // Signaled when the GPU is done with commands
+} vk_frame_t;
+
+typedef struct vk_state_t {
+	VkInstance       instance;
+	VkPhysicalDevice physical_device;
+	VkDevice         device;
+	uint32_t         queue_family;
+	VkQueue          queue;
+	VkCommandPool    pool;
+	vk_frame_t       frames[VK_FRAMES_IN_FLIGHT];
+	uint64_t         frame_index;
+	VkPipelineLayout layout;      // Push constants only, shared by every pipeline
+	VkPipelineCache  pipeline_cache;
+	VkFormat         color_format;
+	VkRenderPass     render_pass;
+
+	std::vector<vk_pipeline_t*> pipelines;
+	std::vector<vk_buffer_t*>   buffers;
+
+	// Between vk_begin_frame and vk_end_frame
+	VkCommandBuffer recording;
+	vk_target_t*    target;      // Render pass in progress, if any
+	bool            scissor_set; // Otherwise each render pass scissors to its whole target
+
+	// Headless with the validation layer only
+	VkDebugUtilsMessengerEXT messenger;
+
+	vk_stats_t stats;
+} vk_state_t;
+
+static vk_state_t vk = {};
+
+static void vk_log(const char* text) {
+#ifdef _WIN32
+	OutputDebugStringA(text);
+#else
+	fputs(text, stderr);
+#endif
+}
+
+static FILE* vk_open(const char* path, const char* mode) {
+#ifdef _WIN32
+	FILE* file = nullptr;
+	return fopen_s(&file, path, mode) == 0 ? file : nullptr;
+#else
+	return fopen(path, mode);
+#endif
+}
+
+static bool vk_check(VkResult result, const char* what) {
+	if (result == VK_SUCCESS)
+		return true;
+	char text[128];
+	snprintf(text, sizeof(text), "Error: %s failed, VkResult %d\n", what, (int32_t)result);
+	vk_log(text);
+	return false;
+}
+
+static bool vk_find_queue_family() {
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(vk.physical_device, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> families(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(vk.physical_device, &count, families.data());
+	for (uint32_t i = 0; i < count; i++) {
+		if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+			vk.queue_family = i;
+			return true;
+		}
+	}
+	vk_log("Error: Vulkan device has no graphics queue\n");
+	return false;
+}
+
+static void vk_load_pipeline_cache() {
+	// The driver checks the header and ignores data from another device or
+	// driver version, so a stale file is harmless
+	std::vector<uint8_t> data;
+	FILE* file = vk_open((vk_pipeline_cache_dir() + "/vulkan_pipelines.bin").c_str(), "rb");
+	if (file) {
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (size > 0) {
+			data.resize((size_t)size);
+			if (fread(data.data(), 1, data.size(), file) != data.size())
+				data.clear();
+		}
+		fclose(file);
+	}
+
+	VkPipelineCacheCreateInfo info = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	info.initialDataSize = data.size();
+	info.pInitialData    = data.empty() ? nullptr : data.data();
+	if (vkCreatePipelineCache(vk.device, &info, nullptr, &vk.pipeline_cache) != VK_SUCCESS) {
+		info.initialDataSize = 0;
+		info.pInitialData    = nullptr;
+		vkCreatePipelineCache(vk.device, &info, nullptr, &vk.pipeline_cache);
+	}
+
+	char text[128];
+	snprintf(text, sizeof(text), "Vulkan pipeline cache: %zu bytes loaded\n", data.size());
+	vk_log(text);
+}
+
+static void vk_save_pipeline_cache() {
+	size_t size = 0;
+	if (vk.pipeline_cache == VK_NULL_HANDLE || vkGetPipelineCacheData(vk.device, vk.pipeline_cache, &size, nullptr) != VK_SUCCESS || size == 0)
+		return;
+	std::vector<uint8_t> data(size);
+	if (vkGetPipelineCacheData(vk.device, vk.pipeline_cache, &size, data.data()) != VK_SUCCESS)
+		return;
+
+	std::string directory = vk_pipeline_cache_dir();
+	shader_cache_create_directory(directory);
+	FILE* file = vk_open((directory + "/vulkan_pipelines.bin").c_str(), "wb");
+	if (file == nullptr)
+		return;
+	fwrite(data.data(), 1, size, file);
+	fclose(file);
+}
+
+// Everything after instance and device creation, shared by both ways of
+// getting them
+static bool vk_init_common() {
+	vkGetDeviceQueue(vk.device, vk.queue_family, 0, &vk.queue);
+
+	VkCommandPoolCreateInfo pool_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	pool_info.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	pool_info.queueFamilyIndex = vk.queue_family;
+	if (!vk_check(vkCreateCommandPool(vk.device, &pool_info, nullptr, &vk.pool), "vkCreateCommandPool"))
+		return false;
+
+	VkCommandBuffer commands[VK_FRAMES_IN_FLIGHT];
+	VkCommandBufferAllocateInfo alloc_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	alloc_info.commandPool        = vk.pool;
+	alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	alloc_info.commandBufferCount = VK_FRAMES_IN_FLIGHT;
+	if (!vk_check(vkAllocateCommandBuffers(vk.device, &alloc_info, commands), "vkAllocateCommandBuffers"))
+		return false;
+
+	// Signaled from the start, so the first use of each slot doesn't wait
+	VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	for (uint32_t i = 0; i < VK_FRAMES_IN_FLIGHT; i++) {
+		vk.frames[i].commands = commands[i];
+		if (!vk_check(vkCreateFence(vk.device, &fence_info, nullptr, &vk.frames[i].fence), "vkCreateFence"))
+			return false;
+	}
+
+	VkPushConstantRange push_range = { VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, VK_PUSH_CONSTANT_BYTES };
+	VkPipelineLayoutCreateInfo layout_info = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+	layout_info.pushConstantRangeCount = 1;
+	layout_info.pPushConstantRanges    = &push_range;
+	if (!vk_check(vkCreatePipelineLayout(vk.device, &layout_info, nullptr, &vk.layout), "vkCreatePipelineLayout"))
+		return false;
+
+	vk_load_pipeline_cache();
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(vk.physical_device, &properties);
+	char text[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE + 64];
+	snprintf(text, sizeof(text), "Vulkan device: %s, API %u.%u\n", properties.deviceName,
+		VK_VERSION_MAJOR(properties.apiVersion), VK_VERSION_MINOR(properties.apiVersion));
+	vk_log(text);
+	return true;
+}
+
+static VkApplicationInfo vk_application_info() {
+	VkApplicationInfo info = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+	info.pApplicationName = "StreamingSession OpenXR Sample";
+	info.pEngineName      = "StreamingSession";
+	info.apiVersion       = VK_API_VERSION_1_1; // Negative viewport heights are core from 1.1
+	return info;
+}
+
+bool vk_init_xr(XrInstance instance, XrSystemId system) {
+	PFN_xrGetVulkanGraphicsRequirements2KHR ext_xrGetVulkanGraphicsRequirements2KHR = nullptr;
+	PFN_xrCreateVulkanInstanceKHR           ext_xrCreateVulkanInstanceKHR           = nullptr;
+	PFN_xrGetVulkanGraphicsDevice2KHR       ext_xrGetVulkanGraphicsDevice2KHR       = nullptr;
+	PFN_xrCreateVulkanDeviceKHR             ext_xrCreateVulkanDeviceKHR             = nullptr;
+	xrGetInstanceProcAddr(instance, "xrGetVulkanGraphicsRequirements2KHR", (PFN_xrVoidFunction*)(&ext_xrGetVulkanGraphicsRequirements2KHR));
+	xrGetInstanceProcAddr(instance, "xrCreateVulkanInstanceKHR",           (PFN_xrVoidFunction*)(&ext_xrCreateVulkanInstanceKHR));
+	xrGetInstanceProcAddr(instance, "xrGetVulkanGraphicsDevice2KHR",       (PFN_xrVoidFunction*)(&ext_xrGetVulkanGraphicsDevice2KHR));
+	xrGetInstanceProcAddr(instance, "xrCreateVulkanDeviceKHR",             (PFN_xrVoidFunction*)(&ext_xrCreateVulkanDeviceKHR));
+	if (!ext_xrGetVulkanGraphicsRequirements2KHR || !ext_xrCreateVulkanInstanceKHR || !ext_xrGetVulkanGraphicsDevice2KHR || !ext_xrCreateVulkanDeviceKHR) {
+		vk_log("Error: XR_KHR_vulkan_enable2 functions unavailable\n");
+		return false;
+	}
+
+	// The runtime requires this call before the instance is created
+	XrGraphicsRequirementsVulkan2KHR requirements = { XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN2_KHR };
+	if (XR_FAILED(ext_xrGetVulkanGraphicsRequirements2KHR(instance, system, &requirements)))
+		return false;
+	if (requirements.minApiVersionSupported > XR_MAKE_VERSION(1, 1, 0) || requirements.maxApiVersionSupported < XR_MAKE_VERSION(1, 1, 0)) {
+		vk_log("Error: runtime doesn't support Vulkan 1.1\n");
+		return false;
+	}
+
+	// The runtime adds whatever instance and device extensions it needs
+	VkApplicationInfo    app_info      = vk_application_info();
+	VkInstanceCreateInfo instance_info = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	instance_info.pApplicationInfo = &app_info;
+
+	XrVulkanInstanceCreateInfoKHR xr_instance_info = { XR_TYPE_VULKAN_INSTANCE_CREATE_INFO_KHR };
+	xr_instance_info.systemId               = system;
+	xr_instance_info.pfnGetInstanceProcAddr = vkGetInstanceProcAddr;
+	xr_instance_info.vulkanCreateInfo       = &instance_info;
+	VkResult vk_result = VK_SUCCESS;
+	if (XR_FAILED(ext_xrCreateVulkanInstanceKHR(instance, &xr_instance_info, &vk.instance, &vk_result)) || !vk_check(vk_result, "vkCreateInstance"))
+		return false;
+
+	XrVulkanGraphicsDeviceGetInfoKHR device_get_info = { XR_TYPE_VULKAN_GRAPHICS_DEVICE_GET_INFO_KHR };
+	device_get_info.systemId       = system;
+	device_get_info.vulkanInstance = vk.instance;
+	if (XR_FAILED(ext_xrGetVulkanGraphicsDevice2KHR(instance, &device_get_info, &vk.physical_device)) || !vk_find_queue_family())
+		return false;
+
+	float                   priority   = 1.0f;
+	VkDeviceQueueCreateInfo queue_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+	queue_info.queueFamilyIndex = vk.queue_family;
+	queue_info.queueCount       = 1;
+	queue_info.pQueuePriorities = &priority;
+	VkDeviceCreateInfo device_info = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	device_info.queueCreateInfoCount = 1;
+	device_info.pQueueCreateInfos    = &queue_info;
+
+	XrVulkanDeviceCreateInfoKHR xr_device_info = { XR_TYPE_VULKAN_DEVICE_CREATE_INFO_KHR };
+	xr_device_info.systemId               = system;
+	xr_device_info.pfnGetInstanceProcAddr = vkGetInstanceProcAddr;
+	xr_device_info.vulkanPhysicalDevice   = vk.physical_device;
+	xr_device_info.vulkanCreateInfo       = &device_info;
+	if (XR_FAILED(ext_xrCreateVulkanDeviceKHR(instance, &xr_device_info, &vk.device, &vk_result)) || !vk_check(vk_result, "vkCreateDevice"))
+		return false;
+
+	return vk_init_common();
+}
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL vk_debug_message(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+	VkDebugUtilsMessageTypeFlagsEXT, const VkDebugUtilsMessengerCallbackDataEXT* data, void*) {
+	bool error = (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) != 0;
+	if (error)
+		vk.stats.validation_errors++;
+	char text[1024];
+	snprintf(text, sizeof(text), "Vulkan validation %s: %s\n", error ? "error" : "warning", data->pMessage);
+	vk_log(text);
+	return VK_FALSE;
+}
+
+bool vk_init_headless() {
+	VkApplicationInfo    app_info      = vk_application_info();
+	VkInstanceCreateInfo instance_info = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	instance_info.pApplicationInfo = &app_info;
+
+	// Headless runs are for checking the render path, so the validation
+	// layer is enabled whenever it is installed, along with the debug utils
+	// extension it provides to count its errors
+	static const char* validation  = "VK_LAYER_KHRONOS_validation";
+	static const char* debug_utils = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+	uint32_t           layer_count = 0;
+	vkEnumerateInstanceLayerProperties(&layer_count, nullptr);
+	std::vector<VkLayerProperties> layers(layer_count);
+	vkEnumerateInstanceLayerProperties(&layer_count, layers.data());
+	for (uint32_t i = 0; i < layer_count; i++) {
+		if (strcmp(layers[i].layerName, validation) == 0) {
+			instance_info.enabledLayerCount       = 1;
+			instance_info.ppEnabledLayerNames     = &validation;
+			instance_info.enabledExtensionCount   = 1;
+			instance_info.ppEnabledExtensionNames = &debug_utils;
+		}
+	}
+	vk_log(instance_info.enabledLayerCount ? "Vulkan validation layer enabled\n" : "Vulkan validation layer not installed\n");
+	if (!vk_check(vkCreateInstance(&instance_info, nullptr, &vk.instance), "vkCreateInstance"))
+		return false;
+
+	PFN_vkCreateDebugUtilsMessengerEXT create_messenger = instance_info.enabledLayerCount
+		? (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(vk.instance, "vkCreateDebugUtilsMessengerEXT")
+		: nullptr;
+	if (create_messenger) {
+		VkDebugUtilsMessengerCreateInfoEXT messenger_info = { VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT };
+		messenger_info.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+		messenger_info.messageType     = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
+		messenger_info.pfnUserCallback = vk_debug_message;
+		vk_check(create_messenger(vk.instance, &messenger_info, nullptr, &vk.messenger), "vkCreateDebugUtilsMessengerEXT");
+	}
+
+	uint32_t count = 0;
+	vkEnumeratePhysicalDevices(vk.instance, &count, nullptr);
+	if (count == 0) {
+		vk_log("Error: no Vulkan devices\n");
+		return false;
+	}
+	std::vector<VkPhysicalDevice> devices(count);
+	vkEnumeratePhysicalDevices(vk.instance, &count, devices.data());
+	vk.physical_device = devices[0];
+	if (!vk_find_queue_family())
+		return false;
+
+	float                   priority   = 1.0f;
+	VkDeviceQueueCreateInfo queue_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+	queue_info.queueFamilyIndex = vk.queue_family;
+	queue_info.queueCount       = 1;
+	queue_info.pQueuePriorities = &priority;
+	VkDeviceCreateInfo device_info = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	device_info.queueCreateInfoCount = 1;
+	device_info.pQueueCreateInfos    = &queue_info;
+	if (!vk_check(vkCreateDevice(vk.physical_device, &device_info, nullptr, &vk.device), "vkCreateDevice"))
+		return false;
+
+	return vk_init_common();
+}
+
+void vk_wait_idle() {
+	if (vk.device != VK_NULL_HANDLE)
+		vkDeviceWaitIdle(vk.device);
+}
+
+void vk_shutdown() {
+	if (vk.device != VK_NULL_HANDLE) {
+		vkDeviceWaitIdle(vk.device);
+		vk_save_pipeline_cache();
+
+		for (size_t i = 0; i < vk.pipelines.size(); i++) {
+			vkDestroyPipeline(vk.device, vk.pipelines[i]->pipeline, nullptr);
+			delete vk.pipelines[i];
+		}
+		for (size_t i = 0; i < vk.buffers.size(); i++) {
+			if (vk.buffers[i]->buffer != VK_NULL_HANDLE) vkDestroyBuffer(vk.device, vk.buffers[i]->buffer, nullptr);
+			if (vk.buffers[i]->memory != VK_NULL_HANDLE) vkFreeMemory   (vk.device, vk.buffers[i]->memory, nullptr);
+			delete vk.buffers[i];
+		}
+		for (uint32_t i = 0; i < VK_FRAMES_IN_FLIGHT; i++) {
+			if (vk.frames[i].fence != VK_NULL_HANDLE) vkDestroyFence(vk.device, vk.frames[i].fence, nullptr);
+		}
+		if (vk.pool           != VK_NULL_HANDLE) vkDestroyCommandPool  (vk.device, vk.pool, nullptr);
+		if (vk.render_pass    != VK_NULL_HANDLE) vkDestroyRenderPass   (vk.device, vk.render_pass, nullptr);
+		if (vk.layout         != VK_NULL_HANDLE) vkDestroyPipelineLayout(vk.device, vk.layout, nullptr);
+		if (vk.pipeline_cache != VK_NULL_HANDLE) vkDestroyPipelineCache(vk.device, vk.pipeline_cache, nullptr);
+		vkDestroyDevice(vk.device, nullptr);
+	}
+	if (vk.messenger != VK_NULL_HANDLE) {
+		PFN_vkDestroyDebugUtilsMessengerEXT destroy_messenger = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(vk.instance, "vkDestroyDebugUtilsMessengerEXT");
+		if (destroy_messenger)
+			destroy_messenger(vk.instance, vk.messenger, nullptr);
+	}
+	if (vk.instance != VK_NULL_HANDLE)
+		vkDestroyInstance(vk.instance, nullptr);
+	vk = {};
+}
+
+XrGraphicsBindingVulkan2KHR vk_graphics_binding() {
+	XrGraphicsBindingVulkan2KHR binding = { XR_TYPE_GRAPHICS_BINDING_VULKAN2_KHR };
+	binding.instance         = vk.instance;
+	binding.physicalDevice   = vk.physical_device;
+	binding.device           = vk.device;
+	binding.queueFamilyIndex = vk.queue_family;
+	binding.queueIndex       = 0;
+	return binding;
+}
+
+// Color is loaded and stored, and stays in COLOR_ATTACHMENT_OPTIMAL, the
+// layout OpenXR hands swapchain images over in and expects them back in.
+// Depth only lives for the render pass.
+static bool vk_create_render_pass(VkFormat color_format) {
+	VkAttachmentDescription attachments[2] = {};
+	attachments[0].format         = color_format;
+	attachments[0].samples        = VK_SAMPLE_COUNT_1_BIT;
+	attachments[0].loadOp         = VK_ATTACHMENT_LOAD_OP_LOAD;
+	attachments[0].storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[0].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[0].initialLayout  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	attachments[0].finalLayout    = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	attachments[1].format         = vk_depth_format;
+	attachments[1].samples        = VK_SAMPLE_COUNT_1_BIT;
+	attachments[1].loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[1].finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference color_ref = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference depth_ref = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+	VkSubpassDescription  subpass   = {};
+	subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount    = 1;
+	subpass.pColorAttachments       = &color_ref;
+	subpass.pDepthStencilAttachment = &depth_ref;
+
+	// Orders each pass after earlier writes to the same targets, this frame's
+	// or the previous frame's, since depth images are shared
+	const VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+		VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	VkSubpassDependency dependency = {};
+	dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass    = 0;
+	dependency.srcStageMask  = stages;
+	dependency.dstStageMask  = stages;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo info = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+	info.attachmentCount = 2;
+	info.pAttachments    = attachments;
+	info.subpassCount    = 1;
+	info.pSubpasses      = &subpass;
+	info.dependencyCount = 1;
+	info.pDependencies   = &dependency;
+	if (!vk_check(vkCreateRenderPass(vk.device, &info, nullptr, &vk.render_pass), "vkCreateRenderPass"))
+		return false;
+	vk.color_format = color_format;
+	return true;
+}
+
+int64_t vk_choose_format(XrSession session, const int64_t* preferred, uint32_t count) {
+	uint32_t format_count = 0;
+	xrEnumerateSwapchainFormats(session, 0, &format_count, nullptr);
+	std::vector<int64_t> formats(format_count);
+	xrEnumerateSwapchainFormats(session, format_count, &format_count, formats.data());
+
+	for (uint32_t i = 0; i < count; i++) {
+		for (uint32_t f = 0; f < format_count; f++) {
+			if (formats[f] == preferred[i])
+				return vk_create_render_pass((VkFormat)preferred[i]) ? preferred[i] : 0;
+		}
+	}
+	vk_log("Error: runtime supports none of the preferred Vulkan swapchain formats\n");
+	return 0;
+}
+
+static uint32_t vk_memory_type(uint32_t type_bits, VkMemoryPropertyFlags flags) {
+	VkPhysicalDeviceMemoryProperties properties;
+	vkGetPhysicalDeviceMemoryProperties(vk.physical_device, &properties);
+	for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+		if ((type_bits & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+			return i;
+	}
+	return UINT32_MAX;
+}
+
+static bool vk_allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags flags, VkDeviceMemory& memory) {
+	VkMemoryAllocateInfo info = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+	info.allocationSize  = requirements.size;
+	info.memoryTypeIndex = vk_memory_type(requirements.memoryTypeBits, flags);
+	if (info.memoryTypeIndex == UINT32_MAX) {
+		vk_log("Error: no suitable Vulkan memory type\n");
+		return false;
+	}
+	return vk_check(vkAllocateMemory(vk.device, &info, nullptr, &memory), "vkAllocateMemory");
+}
+
+static bool vk_create_image(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImage& image, VkDeviceMemory& memory) {
+	VkImageCreateInfo info = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	info.imageType     = VK_IMAGE_TYPE_2D;
+	info.format        = format;
+	info.extent        = { width, height, 1 };
+	info.mipLevels     = 1;
+	info.arrayLayers   = 1;
+	info.samples       = VK_SAMPLE_COUNT_1_BIT;
+	info.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	info.usage         = usage;
+	info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	if (!vk_check(vkCreateImage(vk.device, &info, nullptr, &image), "vkCreateImage"))
+		return false;
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(vk.device, image, &requirements);
+	if (!vk_allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory))
+		return false;
+	return vk_check(vkBindImageMemory(vk.device, image, memory, 0), "vkBindImageMemory");
+}
+
+static VkImageView vk_create_view(VkImage image, VkFormat format, VkImageAspectFlags aspect) {
+	VkImageViewCreateInfo info = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	info.image            = image;
+	info.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+	info.format           = format;
+	info.subresourceRange = { aspect, 0, 1, 0, 1 };
+	VkImageView view = VK_NULL_HANDLE;
+	vk_check(vkCreateImageView(vk.device, &info, nullptr, &view), "vkCreateImageView");
+	return view;
+}
+
+static bool vk_create_framebuffer(vk_target_t& target) {
+	VkImageView attachments[2] = { target.color_view, target.depth_view };
+	VkFramebufferCreateInfo info = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+	info.renderPass      = vk.render_pass;
+	info.attachmentCount = 2;
+	info.pAttachments    = attachments;
+	info.width           = target.width;
+	info.height          = target.height;
+	info.layers          = 1;
+	return vk_check(vkCreateFramebuffer(vk.device, &info, nullptr, &target.framebuffer), "vkCreateFramebuffer");
+}
+
+static bool vk_create_depth(vk_target_t& target) {
+	if (!vk_create_image(target.width, target.height, vk_depth_format, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, target.depth, target.depth_memory))
+		return false;
+	target.depth_view = vk_create_view(target.depth, vk_depth_format, VK_IMAGE_ASPECT_DEPTH_BIT);
+	return target.depth_view != VK_NULL_HANDLE;
+}
+
+bool vk_create_targets(XrSwapchain swapchain, uint32_t width, uint32_t height, std::vector<render_handle_t>& targets) {
+	if (vk.render_pass == VK_NULL_HANDLE)
+		return false;
+
+	uint32_t count = 0;
+	xrEnumerateSwapchainImages(swapchain, 0, &count, nullptr);
+	std::vector<XrSwapchainImageVulkan2KHR> images(count, { XR_TYPE_SWAPCHAIN_IMAGE_VULKAN2_KHR });
+	xrEnumerateSwapchainImages(swapchain, count, &count, (XrSwapchainImageBaseHeader*)images.data());
+
+	// One image is rendered at a time, and render passes are ordered on the
+	// queue, so every image of the swapchain can share one depth image
+	vk_target_t shared = {};
+	shared.width  = width;
+	shared.height = height;
+	if (!vk_create_depth(shared))
+		return false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		vk_target_t* target = new vk_target_t(shared);
+		target->color      = images[i].image;
+		target->color_view = vk_create_view(target->color, vk.color_format, VK_IMAGE_ASPECT_COLOR_BIT);
+		if (i > 0)
+			target->depth_memory = VK_NULL_HANDLE; // Owned by the first target
+		targets.push_back(target);
+		if (target->color_view == VK_NULL_HANDLE || !vk_create_framebuffer(*target))
+			return false;
+	}
+	return true;
+}
+
+void vk_destroy_targets(std::vector<render_handle_t>& targets) {
+	if (vk.device == VK_NULL_HANDLE)
+		return;
+	vkDeviceWaitIdle(vk.device);
+	for (size_t i = 0; i < targets.size(); i++) {
+		vk_target_t* target = (vk_target_t*)targets[i];
+		if (target->framebuffer != VK_NULL_HANDLE) vkDestroyFramebuffer(vk.device, target->framebuffer, nullptr);
+		if (target->color_view  != VK_NULL_HANDLE) vkDestroyImageView  (vk.device, target->color_view, nullptr);
+		if (target->color_memory != VK_NULL_HANDLE) {
+			vkDestroyImage(vk.device, target->color, nullptr);
+			vkFreeMemory  (vk.device, target->color_memory, nullptr);
+		}
+		if (target->depth_memory != VK_NULL_HANDLE) {
+			vkDestroyImageView(vk.device, target->depth_view, nullptr);
+			vkDestroyImage    (vk.device, target->depth, nullptr);
+			vkFreeMemory      (vk.device, target->depth_memory, nullptr);
+		}
+		delete target;
+	}
+	targets.clear();
+}
+
+// Moves a new offscreen color image into the layout the render pass expects,
+// the one swapchain images arrive in
+static bool vk_prepare_offscreen(VkImage image) {
+	VkCommandBufferAllocateInfo alloc_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	alloc_info.commandPool        = vk.pool;
+	alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	alloc_info.commandBufferCount = 1;
+	VkCommandBuffer commands = VK_NULL_HANDLE;
+	if (!vk_check(vkAllocateCommandBuffers(vk.device, &alloc_info, &commands), "vkAllocateCommandBuffers"))
+		return false;
+
+	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commands, &begin_info);
+	VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	barrier.dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image               = image;
+	barrier.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+	vkEndCommandBuffer(commands);
+
+	VkSubmitInfo submit = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submit.commandBufferCount = 1;
+	submit.pCommandBuffers    = &commands;
+	bool result = vk_check(vkQueueSubmit(vk.queue, 1, &submit, VK_NULL_HANDLE), "vkQueueSubmit");
+	vkQueueWaitIdle(vk.queue);
+	vkFreeCommandBuffers(vk.device, vk.pool, 1, &commands);
+	return result;
+}
+
+render_handle_t vk_create_offscreen_target(uint32_t width, uint32_t height) {
+	if (vk.render_pass == VK_NULL_HANDLE && !vk_create_render_pass(VK_FORMAT_R8G8B8A8_SRGB))
+		return nullptr;
+
+	std::vector<render_handle_t> targets;
+	vk_target_t* target = new vk_target_t();
+	targets.push_back(target);
+	target->width  = width;
+	target->height = height;
+	if (!vk_create_image(width, height, vk.color_format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, target->color, target->color_memory) ||
+		!vk_prepare_offscreen(target->color) ||
+		(target->color_view = vk_create_view(target->color, vk.color_format, VK_IMAGE_ASPECT_COLOR_BIT)) == VK_NULL_HANDLE ||
+		!vk_create_depth(*target) || !vk_create_framebuffer(*target)) {
+		vk_destroy_targets(targets);
+		return nullptr;
+	}
+	return target;
+}
+
+bool vk_load_spirv(const char* path, std::vector<uint32_t>& code) {
+	FILE* file = vk_open(path, "rb");
+	if (file == nullptr) {
+		char text[256];
+		snprintf(text, sizeof(text), "Error: can't open %s, build it with glslangValidator -V\n", path);
+		vk_log(text);
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	bool result = size > 0 && size % 4 == 0;
+	if (result) {
+		code.resize((size_t)size / 4);
+		result = fread(code.data(), 1, (size_t)size, file) == (size_t)size;
+	}
+	fclose(file);
+	return result;
+}
+
+static uint32_t vk_format_size(VkFormat format) {
+	switch (format) {
+	case VK_FORMAT_R32_SFLOAT:          return 4;
+	case VK_FORMAT_R32G32_SFLOAT:       return 8;
+	case VK_FORMAT_R32G32B32_SFLOAT:    return 12;
+	case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+	case VK_FORMAT_R8G8B8A8_UNORM:      return 4;
+	default:                            return 0;
+	}
+}
+
+static VkShaderModule vk_create_module(const uint32_t* code, size_t size) {
+	VkShaderModuleCreateInfo info = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	info.codeSize = size;
+	info.pCode    = code;
+	VkShaderModule module = VK_NULL_HANDLE;
+	vk_check(vkCreateShaderModule(vk.device, &info, nullptr, &module), "vkCreateShaderModule");
+	return module;
+}
+
+render_handle_t vk_create_pipeline(const vk_pipeline_desc_t& desc) {
+	if (vk.render_pass == VK_NULL_HANDLE || desc.attribute_count + desc.instance_attribute_count > VK_MAX_ATTRIBUTES)
+		return nullptr;
+
+	VkShaderModule vertex   = vk_create_module(desc.vertex_code,   desc.vertex_size);
+	VkShaderModule fragment = vk_create_module(desc.fragment_code, desc.fragment_size);
+	VkPipeline     pipeline = VK_NULL_HANDLE;
+	if (vertex != VK_NULL_HANDLE && fragment != VK_NULL_HANDLE) {
+		VkPipelineShaderStageCreateInfo stages[2] = {
+			{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO },
+			{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO } };
+		stages[0].stage  = VK_SHADER_STAGE_VERTEX_BIT;
+		stages[0].module = vertex;
+		stages[0].pName  = "main";
+		stages[1].stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
+		stages[1].module = fragment;
+		stages[1].pName  = "main";
+
+		VkVertexInputBindingDescription bindings[2] = {
+			{ 0, desc.vertex_stride,   VK_VERTEX_INPUT_RATE_VERTEX },
+			{ 1, desc.instance_stride, VK_VERTEX_INPUT_RATE_INSTANCE } };
+		VkVertexInputAttributeDescription attributes[VK_MAX_ATTRIBUTES] = {};
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < desc.attribute_count; i++) {
+			attributes[i] = { i, 0, desc.attributes[i], offset };
+			offset += vk_format_size(desc.attributes[i]);
+		}
+		offset = 0;
+		for (uint32_t i = 0; i < desc.instance_attribute_count; i++) {
+			uint32_t location = desc.attribute_count + i;
+			attributes[location] = { location, 1, desc.instance_attributes[i], offset };
+			offset += vk_format_size(desc.instance_attributes[i]);
+		}
+		VkPipelineVertexInputStateCreateInfo vertex_input = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+		vertex_input.vertexBindingDescriptionCount   = desc.instance_attribute_count > 0 ? 2 : 1;
+		vertex_input.pVertexBindingDescriptions      = bindings;
+		vertex_input.vertexAttributeDescriptionCount = desc.attribute_count + desc.instance_attribute_count;
+		vertex_input.pVertexAttributeDescriptions    = attributes;
+
+		VkPipelineInputAssemblyStateCreateInfo assembly = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+		assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+		// Viewport and scissor come from render commands
+		VkPipelineViewportStateCreateInfo viewport = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+		viewport.viewportCount = 1;
+		viewport.scissorCount  = 1;
+		VkDynamicState dynamic_states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo dynamic = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+		dynamic.dynamicStateCount = 2;
+		dynamic.pDynamicStates    = dynamic_states;
+
+		// No culling, same as the D3D11 cube
+		VkPipelineRasterizationStateCreateInfo raster = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+		raster.polygonMode = VK_POLYGON_MODE_FILL;
+		raster.cullMode    = VK_CULL_MODE_NONE;
+		raster.frontFace   = VK_FRONT_FACE_CLOCKWISE;
+		raster.lineWidth   = 1.0f;
+
+		VkPipelineMultisampleStateCreateInfo multisample = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+		multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkPipelineDepthStencilStateCreateInfo depth = { VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
+		depth.depthTestEnable  = desc.depth_test ? VK_TRUE : VK_FALSE;
+		depth.depthWriteEnable = desc.depth_test ? VK_TRUE : VK_FALSE;
+		depth.depthCompareOp   = VK_COMPARE_OP_LESS;
+
+		VkPipelineColorBlendAttachmentState blend_attachment = {};
+		blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		VkPipelineColorBlendStateCreateInfo blend = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+		blend.attachmentCount = 1;
+		blend.pAttachments    = &blend_attachment;
+
+		VkGraphicsPipelineCreateInfo info = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+		info.stageCount          = 2;
+		info.pStages             = stages;
+		info.pVertexInputState   = &vertex_input;
+		info.pInputAssemblyState = &assembly;
+		info.pViewportState      = &viewport;
+		info.pRasterizationState = &raster;
+		info.pMultisampleState   = &multisample;
+		info.pDepthStencilState  = &depth;
+		info.pColorBlendState    = &blend;
+		info.pDynamicState       = &dynamic;
+		info.layout              = vk.layout;
+		info.renderPass          = vk.render_pass;
+		info.subpass             = 0;
+		vk_check(vkCreateGraphicsPipelines(vk.device, vk.pipeline_cache, 1, &info, nullptr, &pipeline), "vkCreateGraphicsPipelines");
+	}
+	if (vertex   != VK_NULL_HANDLE) vkDestroyShaderModule(vk.device, vertex, nullptr);
+	if (fragment != VK_NULL_HANDLE) vkDestroyShaderModule(vk.device, fragment, nullptr);
+	if (pipeline == VK_NULL_HANDLE)
+		return nullptr;
+
+	vk_pipeline_t* result = new vk_pipeline_t();
+	result->pipeline = pipeline;
+	vk.pipelines.push_back(result);
+	return result;
+}
+
+// Static geometry is small, so it stays in host visible memory rather than
+// being staged into device local memory
+render_handle_t vk_create_buffer(VkBufferUsageFlags usage, const void* data, size_t size) {
+	vk_buffer_t* buffer = new vk_buffer_t();
+	vk.buffers.push_back(buffer);
+
+	VkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+	info.size        = size;
+	info.usage       = usage;
+	info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (!vk_check(vkCreateBuffer(vk.device, &info, nullptr, &buffer->buffer), "vkCreateBuffer"))
+		return nullptr;
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(vk.device, buffer->buffer, &requirements);
+	if (!vk_allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer->memory) ||
+		!vk_check(vkBindBufferMemory(vk.device, buffer->buffer, buffer->memory, 0), "vkBindBufferMemory"))
+		return nullptr;
+
+	void* mapped = nullptr;
+	if (data && vkMapMemory(vk.device, buffer->memory, 0, size, 0, &mapped) == VK_SUCCESS) {
+		memcpy(mapped, data, size);
+		vkUnmapMemory(vk.device, buffer->memory);
+	}
+	return buffer;
+}
+
+// Persistently mapped. Each frame in flight writes its own region, which
+// vk_begin_frame's fence wait has already made safe to overwrite.
+render_handle_t vk_create_dynamic_buffer(VkBufferUsageFlags usage, size_t size) {
+	vk_buffer_t* buffer = (vk_buffer_t*)vk_create_buffer(usage, nullptr, size * VK_FRAMES_IN_FLIGHT);
+	if (buffer == nullptr)
+		return nullptr;
+
+	void* mapped = nullptr;
+	if (!vk_check(vkMapMemory(vk.device, buffer->memory, 0, size * VK_FRAMES_IN_FLIGHT, 0, &mapped), "vkMapMemory"))
+		return nullptr;
+	buffer->mapped     = (uint8_t*)mapped;
+	buffer->frame_size = size;
+	return buffer;
+}
+
+render_handle_t vk_create_push_constants(uint32_t offset, uint32_t size) {
+	if (offset % 4 != 0 || size % 4 != 0 || offset + size > VK_PUSH_CONSTANT_BYTES)
+		return nullptr;
+	vk_buffer_t* buffer = new vk_buffer_t();
+	buffer->push_offset = offset;
+	buffer->push_size   = size;
+	vk.buffers.push_back(buffer);
+	return buffer;
+}
+
+bool vk_begin_frame() {
+	vk_frame_t& frame = vk.frames[vk.frame_index % VK_FRAMES_IN_FLIGHT];
+
+	// Only blocks when the GPU is a whole VK_FRAMES_IN_FLIGHT frames behind
+	if (vkGetFenceStatus(vk.device, frame.fence) == VK_NOT_READY) {
+		auto start = std::chrono::steady_clock::now();
+		vkWaitForFences(vk.device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+		vk.stats.fence_waits++;
+		vk.stats.fence_wait_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	vkResetFences(vk.device, 1, &frame.fence);
+	vkResetCommandBuffer(frame.commands, 0);
+
+	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (!vk_check(vkBeginCommandBuffer(frame.commands, &begin_info), "vkBeginCommandBuffer"))
+		return false;
+	vk.recording   = frame.commands;
+	vk.target      = nullptr;
+	vk.scissor_set = false;
+	return true;
+}
+
+static void vk_end_pass() {
+	if (vk.target == nullptr)
+		return;
+	vkCmdEndRenderPass(vk.recording);
+	vk.target = nullptr;
+}
+
+static void vk_begin_pass(vk_target_t* target) {
+	if (vk.target == target)
+		return;
+	vk_end_pass();
+	if (target == nullptr)
+		return;
+
+	VkRenderPassBeginInfo info = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	info.renderPass  = vk.render_pass;
+	info.framebuffer = target->framebuffer;
+	info.renderArea  = { { 0, 0 }, { target->width, target->height } };
+	vkCmdBeginRenderPass(vk.recording, &info, VK_SUBPASS_CONTENTS_INLINE);
+	vk.target = target;
+	vk.stats.render_passes++;
+
+	// D3D11 doesn't scissor unless asked to, and the scissor here is dynamic
+	// state that has to be set before drawing
+	if (!vk.scissor_set) {
+		VkRect2D scissor = { { 0, 0 }, { target->width, target->height } };
+		vkCmdSetScissor(vk.recording, 0, 1, &scissor);
+	}
+}
+
+bool vk_end_frame() {
+	if (vk.recording == VK_NULL_HANDLE)
+		return false;
+	vk_end_pass();
+
+	vk_frame_t& frame = vk.frames[vk.frame_index % VK_FRAMES_IN_FLIGHT];
+	vk.recording = VK_NULL_HANDLE;
+	vk.frame_index++;
+	if (!vk_check(vkEndCommandBuffer(frame.commands), "vkEndCommandBuffer"))
+		return false;
+
+	VkSubmitInfo submit = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submit.commandBufferCount = 1;
+	submit.pCommandBuffers    = &frame.commands;
+	if (!vk_check(vkQueueSubmit(vk.queue, 1, &submit, frame.fence), "vkQueueSubmit"))
+		return false;
+	vk.stats.frames++;
+	return true;
+}
+
+static void vk_clear(vk_target_t* color, vk_target_t* depth, const float clear_color[4]) {
+	vk_target_t* target = color ? color : depth;
+	if (target == nullptr)
+		return;
+	vk_begin_pass(target);
+
+	VkClearAttachment attachments[2] = {};
+	uint32_t          count          = 0;
+	if (color) {
+		attachments[count].aspectMask      = VK_IMAGE_ASPECT_COLOR_BIT;
+		attachments[count].colorAttachment = 0;
+		memcpy(attachments[count].clearValue.color.float32, clear_color, sizeof(float) * 4);
+		count++;
+	}
+	if (depth) {
+		attachments[count].aspectMask              = VK_IMAGE_ASPECT_DEPTH_BIT;
+		attachments[count].clearValue.depthStencil = { 1.0f, 0 };
+		count++;
+	}
+	VkClearRect rect = { { { 0, 0 }, { target->width, target->height } }, 0, 1 };
+	vkCmdClearAttachments(vk.recording, count, attachments, 1, &rect);
+}
+
+static void vk_execute(void* context, const render_command_t& command, const void* data) {
+	VkCommandBuffer commands = vk.recording;
+	if (commands == VK_NULL_HANDLE)
+		return;
+
+	switch (command.type) {
+	case render_cmd_set_pipeline: {
+		const vk_pipeline_t* pipeline = (const vk_pipeline_t*)command.handles[0];
+		if (pipeline) vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pipeline);
+	} break;
+	case render_cmd_set_targets:
+		vk_begin_pass((vk_target_t*)command.handles[0]);
+		break;
+	case render_cmd_set_viewport: {
+		// Negative height flips y, so clip space is the same as D3D's and the
+		// shaders share their math with the HLSL ones
+		const render_rect_t& rect     = command.rect;
+		VkViewport           viewport = { rect.x, rect.y + rect.height, rect.width, -rect.height, 0.0f, 1.0f };
+		vkCmdSetViewport(commands, 0, 1, &viewport);
+	} break;
+	case render_cmd_set_scissor: {
+		const render_rect_t& rect    = command.rect;
+		VkRect2D             scissor = { { (int32_t)rect.x, (int32_t)rect.y }, { (uint32_t)rect.width, (uint32_t)rect.height } };
+		vkCmdSetScissor(commands, 0, 1, &scissor);
+		vk.scissor_set = true;
+	} break;
+	case render_cmd_set_vertex_buffer: {
+		const vk_buffer_t* buffer = (const vk_buffer_t*)command.handles[0];
+		VkDeviceSize       offset = 0;
+		if (buffer) vkCmdBindVertexBuffers(commands, 0, 1, &buffer->buffer, &offset);
+	} break;
+	case render_cmd_set_index_buffer: {
+		const vk_buffer_t* buffer = (const vk_buffer_t*)command.handles[0];
+		if (buffer) vkCmdBindIndexBuffer(commands, buffer->buffer, 0, command.count == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+	} break;
+	case render_cmd_set_instance_buffer: {
+		// This frame's region, the one update_buffer writes
+		const vk_buffer_t* buffer = (const vk_buffer_t*)command.handles[0];
+		VkDeviceSize       offset = buffer ? buffer->frame_size * (vk.frame_index % VK_FRAMES_IN_FLIGHT) : 0;
+		if (buffer) vkCmdBindVertexBuffers(commands, 1, 1, &buffer->buffer, &offset);
+	} break;
+	case render_cmd_set_constants:
+	case render_cmd_set_textures:
+		break;
+	case render_cmd_update_constants: {
+		const vk_buffer_t* buffer = (const vk_buffer_t*)command.handles[0];
+		if (buffer && data && buffer->push_size > 0) {
+			uint32_t size = command.count < buffer->push_size ? command.count : buffer->push_size;
+			vkCmdPushConstants(commands, vk.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, buffer->push_offset, size, data);
+		}
+	} break;
+	case render_cmd_update_buffer: {
+		const vk_buffer_t* buffer = (const vk_buffer_t*)command.handles[0];
+		if (buffer && data && buffer->mapped) {
+			VkDeviceSize size = command.count < buffer->frame_size ? command.count : buffer->frame_size;
+			memcpy(buffer->mapped + buffer->frame_size * (vk.frame_index % VK_FRAMES_IN_FLIGHT), data, (size_t)size);
+		}
+	} break;
+	case render_cmd_clear:
+		vk_clear((vk_target_t*)command.handles[0], (vk_target_t*)command.handles[1], command.color);
+		break;
+	case render_cmd_draw:
+		vkCmdDraw(commands, command.count, command.instances, 0, 0);
+		break;
+	case render_cmd_draw_indexed:
+		vkCmdDrawIndexed(commands, command.count, command.instances, 0, 0, command.first);
+		break;
+	default:
+		break;
+	}
+}
+
+render_backend_t vk_backend() {
+	render_backend_t backend = { "vulkan", vk_execute, nullptr };
+	return backend;
+}
+
+void vk_report() {
+	const vk_stats_t& stats = vk.stats;
+	if (stats.frames == 0)
+		return;
+	char text[256];
+	snprintf(text, sizeof(text), "Vulkan: %llu frames, %.1f render passes per frame, %llu waited on a frame in flight (%.2f ms avg)\n",
+		(unsigned long long)stats.frames, (double)stats.render_passes / stats.frames, (unsigned long long)stats.fence_waits,
+		stats.fence_waits ? stats.fence_wait_ms / stats.fence_waits : 0.0);
+	vk_log(text);
+	if (vk.messenger != VK_NULL_HANDLE) {
+		snprintf(text, sizeof(text), "Vulkan: %llu validation errors\n", (unsigned long long)stats.validation_errors);
+		vk_log(text);
+	}
+}
+
+bool vk_validate(render_context_t& render, const vk_validate_scene_t& scene, uint32_t frames, uint32_t size) {
+	bool            passed = vk_init_headless();
+	render_handle_t target = passed ? vk_create_offscreen_target(size, size) : nullptr;
+	passed = target != nullptr && scene.init(scene.context);
+
+	// Standing back from the scene, with a typical eye buffer's field of view
+	XrCompositionLayerProjectionView view = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+	view.pose.orientation   = { 0, 0, 0, 1 };
+	view.pose.position      = { 0, -0.6f, 4.0f };
+	view.fov                = { -0.4f, 0.4f, 0.4f, -0.4f };
+	view.subImage.imageRect = { { 0, 0 }, { (int32_t)size, (int32_t)size } };
+
+	render_init(render, vk_backend());
+	for (uint32_t i = 0; passed && i < frames; i++) {
+		render_invalidate(render);
+		if (!vk_begin_frame()) {
+			passed = false;
+			break;
+		}
+		scene.frame(scene.context, view, target, (XrTime)i * 11111111); // 90 Hz
+		passed = vk_end_frame();
+		render_end_frame(render);
+	}
+	// Messages can come from anything up to the last frame's completion
+	vk_wait_idle();
+	passed = passed && vk.stats.validation_errors == 0;
+	render_report(render);
+	vk_report();
+
+	if (target) {
+		std::vector<render_handle_t> targets = { target };
+		vk_destroy_targets(targets);
+	}
+	vk_shutdown();
+	return passed;
+}
+
+#endif
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+// Vulkan render backend, an alternative to D3D11 built only when
+// XR_SAMPLE_VULKAN is defined and the Vulkan SDK is available.
+//
+// With OpenXR, the instance and device come from XR_KHR_vulkan_enable2, and
+// each swapchain image becomes a vk_target_t. Without OpenXR, vk_init_headless
+// takes any Vulkan device, a software one such as lavapipe included, and
+// renders into offscreen targets. vk_validate drives a scene that way, which
+// Headless/vk_validate.cpp runs on Linux hosts too.
+//
+// Work is recorded into one of VK_FRAMES_IN_FLIGHT persistent command
+// buffers, each guarded by a fence, so the CPU records a frame while the GPU
+// is still busy with the one before. Pipelines go through a VkPipelineCache
+// that is kept on disk between runs.
+//
+// Render commands map onto the command buffer as follows:
+//   - set_targets, and clear of a target that isn't bound, begin a render
+//     pass on that target. Depth isn't kept across render passes.
+//   - Constant buffers are push constant ranges (vk_create_push_constants),
+//     update_constants pushes them. set_constants has nothing to do.
+//   - Buffers that update_buffer writes, such as the instance buffer, come
+//     from vk_create_dynamic_buffer: one persistently mapped region per frame
+//     in flight, so the CPU never writes what the GPU may still be reading.
+//   - Textures need descriptor sets, which nothing here uses yet, so
+//     set_textures is ignored.
+
+#ifdef XR_SAMPLE_VULKAN
+
+#ifndef XR_USE_GRAPHICS_API_VULKAN
+#define XR_USE_GRAPHICS_API_VULKAN
+#endif
+#include <vulkan/vulkan.h>
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <stdint.h>
+#include <vector>
+#include "RenderBackend.h"
+
+#define VK_FRAMES_IN_FLIGHT    2
+#define VK_PUSH_CONSTANT_BYTES 128 // The minimum every device supports
+#define VK_MAX_ATTRIBUTES      8
+
+// What a render_handle_t target points to: a color image, the depth image
+// rendered with it, and the framebuffer joining them
+typedef struct vk_target_t {
+	uint32_t       width;
+	uint32_t       height;
+	VkImage        color;
+	VkImageView    color_view;
+	VkDeviceMemory color_memory; // Offscreen targets only, swapchain images belong to the runtime
+	VkImage        depth;
+	VkImageView    depth_view;
+	VkDeviceMemory depth_memory; // Only on the target that owns the depth image
+	VkFramebuffer  framebuffer;
+} vk_target_t;
+
+// What a render_handle_t buffer points to. Vertex and index buffers live in
+// host visible memory; constant buffers are a range of the push constants.
+typedef struct vk_buffer_t {
+	VkBuffer       buffer;
+	VkDeviceMemory memory;
+	uint32_t       push_offset;
+	uint32_t       push_size;
+	uint8_t*       mapped;     // Dynamic buffers only
+	VkDeviceSize   frame_size; // Dynamic buffers: bytes per frame in flight
+} vk_buffer_t;
+
+// Vertex attributes are tightly packed, in order, from binding 0. Instance
+// attributes follow them in location, from binding 1.
+typedef struct vk_pipeline_desc_t {
+	const uint32_t* vertex_code;
+	size_t          vertex_size;   // In bytes
+	const uint32_t* fragment_code;
+	size_t          fragment_size;
+	uint32_t        vertex_stride;
+	VkFormat        attributes[VK_MAX_ATTRIBUTES];
+	uint32_t        attribute_count;
+	uint32_t        instance_stride;
+	VkFormat        instance_attributes[VK_MAX_ATTRIBUTES];
+	uint32_t        instance_attribute_count;
+	bool            depth_test;
+} vk_pipeline_desc_t;
+
+typedef struct vk_stats_t {
+	uint64_t frames;
+	uint64_t render_passes;
+	uint64_t fence_waits; // Frames that found their slot's fence still unsignaled
+	double   fence_wait_ms;
+	uint64_t validation_errors; // Headless, when the validation layer is installed
+} vk_stats_t;
+
+// What vk_validate renders. init creates the scene's resources once the
+// device exists. frame records one frame, between vk_begin_frame and
+// vk_end_frame, into the render context given to vk_validate, for view,
+// whose image rect covers target.
+typedef struct vk_validate_scene_t {
+	void* context;
+	bool (*init) (void* context);
+	void (*frame)(void* context, XrCompositionLayerProjectionView& view, render_handle_t target, XrTime display_time);
+} vk_validate_scene_t;
+
+// Creates the instance and device through XR_KHR_vulkan_enable2
+bool vk_init_xr(XrInstance instance, XrSystemId system);
+// Creates the instance and device on the first device Vulkan lists, with
+// the validation layer when it is installed. Errors it reports are counted
+// in vk_stats_t::validation_errors.
+bool vk_init_headless();
+void vk_shutdown();
+
+XrGraphicsBindingVulkan2KHR vk_graphics_binding();
+
+// Picks the first format from preferred that the session supports and builds
+// the render pass for it. Returns 0 if none match.
+int64_t vk_choose_format(XrSession session, const int64_t* preferred, uint32_t count);
+
+// One target per image of swapchain, all sharing a single depth image
+bool vk_create_targets(XrSwapchain swapchain, uint32_t width, uint32_t height, std::vector<render_handle_t>& targets);
+void vk_destroy_targets(std::vector<render_handle_t>& targets);
+render_handle_t vk_create_offscreen_target(uint32_t width, uint32_t height);
+
+bool            vk_load_spirv(const char* path, std::vector<uint32_t>& code);
+render_handle_t vk_create_pipeline(const vk_pipeline_desc_t& desc);
+render_handle_t vk_create_buffer(VkBufferUsageFlags usage, const void* data, size_t size);
+// size bytes for each frame in flight, written with update_buffer
+render_handle_t vk_create_dynamic_buffer(VkBufferUsageFlags usage, size_t size);
+render_handle_t vk_create_push_constants(uint32_t offset, uint32_t size);
+
+// Commands execute between these two. vk_end_frame submits; with OpenXR it
+// has to run before the frame's swapchain images are released.
+bool vk_begin_frame();
+bool vk_end_frame();
+void vk_wait_idle();
+
+render_backend_t vk_backend();
+void vk_report();
+
+// The render path without OpenXR or a headset: a device from
+// vk_init_headless, an offscreen target size pixels square, and frames of
+// scene from a fixed pose, 90 Hz apart in display time. Fails on any Vulkan
+// error, including those the validation layer reports. Reports and shuts
+// down before returning.
+bool vk_validate(render_context_t& render, const vk_validate_scene_t& scene, uint32_t frames, uint32_t size);
+
+#endif
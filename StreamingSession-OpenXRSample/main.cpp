@@ -1,1000 +1,3065 @@
-//===----------------------------------------------------------------------===//
-// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
-//
-// Licensed under the MIT license (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// StreamingSession/LICENSE.txt
-//
-//===----------------------------------------------------------------------===//
-
-#pragma comment(lib, "D3D11.lib")
-#pragma comment(lib, "D3dcompiler.lib")
-#pragma comment(lib, "Dxgi.lib")
-
-#define XR_USE_PLATFORM_WIN32
-#define XR_USE_GRAPHICS_API_D3D11
-
-#include <dxgi1_2.h>
-#include <d3d11.h>
-#include <directxmath.h>
-#include <d3dcompiler.h>
-#include <openxr/openxr.h>
-#include <openxr/openxr_platform.h>
-
-#include <thread>
-#include <vector>
-#include <algorithm>
-#include <atomic>
-#include <windows.h>
-#include "MessageChannel.h"
-
-using namespace std;
-using namespace DirectX;
-
-struct swapchain_surfdata_t {
-	ID3D11DepthStencilView* depth_view;
-	ID3D11RenderTargetView* target_view;
-};
-
-struct swapchain_t {
-	XrSwapchain                      handle;
-	int32_t                          width;
-	int32_t                          height;
-	vector<XrSwapchainImageD3D11KHR> surface_images;
-	vector<swapchain_surfdata_t>     surface_data;
-};
-
-struct input_state_t {
-	XrActionSet actionSet;
-	XrAction    poseAction;
-	XrAction    selectAction;
-	XrPath      handSubactionPath[2];
-	XrSpace     handSpace[2];
-	XrPosef     handPose[2];
-	XrBool32    renderHand[2];
-	XrBool32    handSelect[2];
-};
-
-PFN_xrGetD3D11GraphicsRequirementsKHR ext_xrGetD3D11GraphicsRequirementsKHR = nullptr;
-PFN_xrCreateDebugUtilsMessengerEXT    ext_xrCreateDebugUtilsMessengerEXT    = nullptr;
-PFN_xrDestroyDebugUtilsMessengerEXT   ext_xrDestroyDebugUtilsMessengerEXT   = nullptr;
-
-struct app_transform_buffer_t {
-	XMFLOAT4X4 world;
-	XMFLOAT4X4 viewproj;
-};
-
-XrFormFactor            app_config_form = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
-XrViewConfigurationType app_config_view = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
-bool                    app_is_ios_mode = false;
-
-ID3D11VertexShader*    app_vshader;
-ID3D11PixelShader*     app_pshader;
-ID3D11InputLayout*     app_shader_layout;
-ID3D11Buffer*          app_constant_buffer;
-ID3D11Buffer*          app_vertex_buffer;
-ID3D11Buffer*          app_index_buffer;
-ID3D11RasterizerState* app_rasterizer_state;
-
-void app_init();
-void app_draw(XrCompositionLayerProjectionView& layerView);
-
-const XrPosef              xr_pose_identity = {{0, 0, 0, 1}, {0, 0, 0}};
-XrSession                  xr_session       = {};
-XrInstance                 xr_instance      = {};
-XrSessionState             xr_session_state = XR_SESSION_STATE_UNKNOWN;
-bool                       xr_running       = false;
-XrSpace                    xr_app_space     = {};
-input_state_t              xr_input         = {};
-XrDebugUtilsMessengerEXT   xr_debug         = {};
-XrSystemId                 xr_system_id     = XR_NULL_SYSTEM_ID;
-
-vector<XrView>                  xr_views;
-vector<XrViewConfigurationView> xr_config_views;
-vector<swapchain_t>             xr_swapchains;
-
-bool openxr_init(const char* app_name, int64_t swapchain_format);
-void openxr_shutdown();
-void openxr_poll_events(bool& exit);
-void openxr_render_frame();
-bool openxr_render_layer(XrTime predictedTime, vector<XrCompositionLayerProjectionView>& projectionViews, XrCompositionLayerProjection& layer);
-
-ID3D11Device*        d3d_device        = nullptr;
-ID3D11DeviceContext* d3d_context       = nullptr;
-int64_t              d3d_swapchain_fmt = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
-
-// Window swap chain for spectator view
-IDXGISwapChain*         window_swapchain = nullptr;
-ID3D11RenderTargetView* window_rtv        = nullptr;
-UINT                    window_width      = 0;
-UINT                    window_height     = 0;
-
-bool d3d_init(LUID& adapter_luid);
-void d3d_shutdown();
-IDXGIAdapter1* d3d_get_adapter(LUID& adapter_luid);
-swapchain_surfdata_t d3d_make_surface_data(XrBaseInStructure& swapchainImage);
-void d3d_render_layer(XrCompositionLayerProjectionView& layerView, swapchain_surfdata_t& surface);
-void d3d_swapchain_destroy(swapchain_t& swapchain);
-XMMATRIX d3d_xr_projection(XrFovf fov, float clip_near, float clip_far);
-ID3DBlob* d3d_compile_shader(const char* hlsl, const char* entrypoint, const char* target);
-bool window_swapchain_init();
-void window_present_vr_view();
-void window_handle_resize();
-
-// Cube shader with lighting
-constexpr char screen_shader_code[] = R"_(
-cbuffer TransformBuffer : register(b0) {
-	float4x4 world;
-	float4x4 viewproj;
-};
-
-struct vsIn {
-	float3 pos : SV_POSITION;
-	float3 color : COLOR;
-	float3 normal : NORMAL;
-};
-
-struct psIn {
-	float4 pos: SV_POSITION;
-	float3 color: COLOR;
-};
-
-psIn vs(vsIn input) {
-	psIn output;
-	output.pos = mul(float4(input.pos, 1), world);
-	output.pos = mul(output.pos, viewproj);
-
-	// Lighting calculation
-	float3 lightDir = normalize(float3(0.5, 0.8, 0.3)); // Light from top-front-right
-	float3 worldNormal = mul(input.normal, (float3x3)world); // Transform normal to world space
-	worldNormal = normalize(worldNormal);
-
-	// Diffuse lighting (dot product of normal and light direction)
-	float diffuse = max(dot(worldNormal, lightDir), 0.0);
-
-	// Ambient + Diffuse lighting
-	float ambient = 0.3; // Base ambient light
-	float lighting = ambient + (diffuse * 0.7); // 30% ambient + 70% diffuse
-
-	// Apply lighting to color
-	output.color = input.color * lighting;
-
-	return output;
-}
-
-float4 ps(psIn input) : SV_TARGET {
-    return float4(input.color, 1.0);
-}
-
-)_";
-
-// Cube geometry
-float screen_verts[] = {
-	// Position (x, y, z) + Color (r, g, b) + Normal (x, y, z) - White/Light gray
-	// Light gray RGB: (0.95, 0.95, 0.95) - very light gray, almost white
-	// Front face (normal pointing forward: 0, 0, 1)
-	-0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 0
-	 0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 1
-	 0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 2
-	-0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 3
-	// Back face (normal pointing backward: 0, 0, -1)
-	-0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 4
-	 0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 5
-	 0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 6
-	-0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 7
-	// Left face (normal pointing left: -1, 0, 0)
-	-0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 8
-	-0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 9
-	-0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 10
-	-0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 11
-	// Right face (normal pointing right: 1, 0, 0)
-	 0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 12
-	 0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 13
-	 0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 14
-	 0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 15
-	// Top face (normal pointing up: 0, 1, 0)
-	-0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 16
-	-0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 17
-	 0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 18
-	 0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 19
-	// Bottom face (normal pointing down: 0, -1, 0)
-	-0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 20
-	-0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 21
-	 0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 22
-	 0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 23
-};
-
-uint16_t screen_inds[] = {
-	// Front face
-	0, 1, 2,  0, 2, 3,
-	// Back face
-	5, 4, 7,  5, 7, 6,
-	// Left face
-	8, 9, 10,  8, 10, 11,
-	// Right face
-	12, 13, 14,  12, 14, 15,
-	// Top face
-	16, 17, 18,  16, 18, 19,
-	// Bottom face
-	20, 21, 22,  20, 22, 23
-};
-
-HWND g_debug_window = nullptr;
-
-LRESULT CALLBACK DebugWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-	switch (msg) {
-	case WM_PAINT: {
-		PAINTSTRUCT ps;
-		HDC hdc = BeginPaint(hwnd, &ps);
-
-		// Set text color to green
-		SetTextColor(hdc, RGB(0, 255, 0));
-		SetBkColor(hdc, RGB(30, 30, 30));
-
-		// Draw text
-		const char* text = "StreamingSession OpenXR App is running";
-		TextOutA(hdc, 20, 20, text, strlen(text));
-
-		EndPaint(hwnd, &ps);
-		break;
-	}
-	case WM_CLOSE:
-		DestroyWindow(hwnd);
-		return 0;
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		return 0;
-	}
-	return DefWindowProc(hwnd, msg, wParam, lParam);
-}
-
-void create_window() {
-	WNDCLASS wc = {};
-	wc.lpfnWndProc = DebugWindowProc;
-	wc.hInstance = GetModuleHandle(nullptr);
-	wc.lpszClassName = "DebugWindow";
-	wc.hbrBackground = CreateSolidBrush(RGB(30, 30, 30));
-	wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
-
-	RegisterClass(&wc);
-
-	g_debug_window = CreateWindowA(
-		"DebugWindow",
-		"StreamingSession OpenXR App",
-		WS_OVERLAPPEDWINDOW,
-		100, 100, 600, 600,
-		nullptr, nullptr, GetModuleHandle(nullptr), nullptr
-	);
-
-	ShowWindow(g_debug_window, SW_SHOW);
-	UpdateWindow(g_debug_window);
-}
-
-int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR cmdLine, int) {
-
-	// Parse command line arguments                                                                                                                                                                                                                         
-	if (cmdLine && wcsstr(cmdLine, L"-iOS")) {
-		app_is_ios_mode = true;
-		app_config_form = XR_FORM_FACTOR_HANDHELD_DISPLAY;
-		app_config_view = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO;
-		OutputDebugStringA("Running in iOS mode: XR_FORM_FACTOR_HANDHELD_DISPLAY + XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO\n");
-	} else {
-		OutputDebugStringA("Running in Immersive Mode: XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY + XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO\n");
-	}
-
-	create_window();
-
-	if (!openxr_init("3D Cube", d3d_swapchain_fmt)) {
-		d3d_shutdown();
-		MessageBox(nullptr, "OpenXR initialization failed\n", "Error", 1);
-		return 1;
-	}
-	app_init();
-
-	// Initialize window swap chain for spectator view
-	if (!window_swapchain_init()) {
-		OutputDebugStringA("Warning: Failed to create window swap chain\n");
-	}
-
-	// Start connection process asynchronously - NON-BLOCKING
-	if (xr_opaque_channel != XR_NULL_HANDLE) {
-		xr_opaque_connection_thread = std::thread(opaque_channel_connect_async);
-	}
-
-	bool quit = false;
-	while (!quit) {
-
-		MSG msg;
-		while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
-			if (msg.message == WM_QUIT) {
-				quit = true;
-			}
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
-		}
-
-		if (quit) break;
-		
-		openxr_poll_events(quit);
-		static int frame_counter = 0;
-		static int message_number = 0;
-
-		if (xr_running) {
-			openxr_render_frame();
-
-			// Render to window for spectator view
-			window_present_vr_view();
-
-			if (xr_session_state != XR_SESSION_STATE_VISIBLE &&
-				xr_session_state != XR_SESSION_STATE_FOCUSED) {
-				this_thread::sleep_for(chrono::milliseconds(250));
-			}
-
-			// Only send data if connected
-			frame_counter++;
-			if (xr_opaque_connected && frame_counter >= 90) {
-				char message[128];
-				sprintf_s(message, "Message #%d: OpenXR application data", message_number);
-				opaque_channel_send_data((const uint8_t*)message, strlen(message) + 1);
-				message_number++;
-			}
-		}
-	}
-
-	// Cleanup
-	xr_opaque_connecting = false;
-	if (xr_opaque_connection_thread.joinable()) {
-		xr_opaque_connection_thread.join();
-	}
-	opaque_channel_shutdown();
-	openxr_shutdown();
-	d3d_shutdown();
-	return 0;
-}
-
-bool openxr_init(const char* app_name, int64_t swapchain_format) {
-
-	SetProcessDPIAware();
-	vector<const char*> use_extensions;
-	const char* ask_extensions[] = { 
-		XR_KHR_D3D11_ENABLE_EXTENSION_NAME, // Use Direct3D11 for rendering
-		XR_EXT_DEBUG_UTILS_EXTENSION_NAME,  // Debug utils for extra info
-		"XR_NVX1_opaque_data_channel",
-	};
-
-	uint32_t ext_count = 0;
-	xrEnumerateInstanceExtensionProperties(nullptr, 0, &ext_count, nullptr);
-	vector<XrExtensionProperties> xr_exts(ext_count, { XR_TYPE_EXTENSION_PROPERTIES });
-	xrEnumerateInstanceExtensionProperties(nullptr, ext_count, &ext_count, xr_exts.data());
-
-	OutputDebugStringA("OpenXR extensions available:\n");
-	for (size_t i = 0; i < xr_exts.size(); i++) {
-		OutputDebugStringA(xr_exts[i].extensionName);
-
-		for (int32_t ask = 0; ask < _countof(ask_extensions); ask++) {
-			if (strcmp(ask_extensions[ask], xr_exts[i].extensionName) == 0) {
-				use_extensions.push_back(ask_extensions[ask]);
-				break;
-			}
-		}
-	}
-
-	if (!std::any_of(use_extensions.begin(), use_extensions.end(),
-		[](const char* ext) {
-			return strcmp(ext, XR_KHR_D3D11_ENABLE_EXTENSION_NAME) == 0;
-		}))
-		return false;
-
-	// Initialize OpenXR with the extensions we've found
-	XrInstanceCreateInfo createInfo = { XR_TYPE_INSTANCE_CREATE_INFO };
-	createInfo.enabledExtensionCount      = use_extensions.size();
-	createInfo.enabledExtensionNames      = use_extensions.data();
-	createInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
-	strcpy_s(createInfo.applicationInfo.applicationName, app_name);
-	xrCreateInstance(&createInfo, &xr_instance);
-
-	// Check if OpenXR is available on this system. If null, an OpenXR runtime
-	// must be installed and activated.
-	if (xr_instance == nullptr)
-		return false;
-
-	xrGetInstanceProcAddr(xr_instance, "xrCreateDebugUtilsMessengerEXT", (PFN_xrVoidFunction*)(&ext_xrCreateDebugUtilsMessengerEXT));
-	xrGetInstanceProcAddr(xr_instance, "xrDestroyDebugUtilsMessengerEXT", (PFN_xrVoidFunction*)(&ext_xrDestroyDebugUtilsMessengerEXT));
-	xrGetInstanceProcAddr(xr_instance, "xrGetD3D11GraphicsRequirementsKHR", (PFN_xrVoidFunction*)(&ext_xrGetD3D11GraphicsRequirementsKHR));
-
-	// Opaque data channel APIs
-	xrGetInstanceProcAddr(xr_instance, "xrCreateOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrCreateOpaqueDataChannelNV));
-	xrGetInstanceProcAddr(xr_instance, "xrDestroyOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrDestroyOpaqueDataChannelNV));
-	xrGetInstanceProcAddr(xr_instance, "xrGetOpaqueDataChannelStateNV", (PFN_xrVoidFunction*)(&ext_xrGetOpaqueDataChannelStateNV));
-	xrGetInstanceProcAddr(xr_instance, "xrShutdownOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrShutdownOpaqueDataChannelNV));
-	xrGetInstanceProcAddr(xr_instance, "xrSendOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrSendOpaqueDataChannelNV));
-	xrGetInstanceProcAddr(xr_instance, "xrReceiveOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrReceiveOpaqueDataChannelNV));
-
-	// Debug output
-	if (ext_xrCreateOpaqueDataChannelNV) {
-		OutputDebugStringA("Successfully loaded opaque data channel functions\n");
-	}
-	else {
-		OutputDebugStringA("Failed to load opaque data channel functions\n");
-	}
-
-	// Here's some extra information about the message types and severities:
-	// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#debug-message-categorization
-	XrDebugUtilsMessengerCreateInfoEXT debug_info = { XR_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT };
-	debug_info.messageTypes =
-		XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT     |
-		XR_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT  |
-		XR_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT |
-		XR_DEBUG_UTILS_MESSAGE_TYPE_CONFORMANCE_BIT_EXT;
-	debug_info.messageSeverities =
-		XR_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-		XR_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
-		XR_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-		XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-	debug_info.userCallback = [](XrDebugUtilsMessageSeverityFlagsEXT severity, XrDebugUtilsMessageTypeFlagsEXT types, const XrDebugUtilsMessengerCallbackDataEXT* msg, void* user_data) {
-		printf("%s: %s\n", msg->functionName, msg->message);
-
-		char text[512];
-		sprintf_s(text, "%s: %s", msg->functionName, msg->message);
-		OutputDebugStringA(text);
-		return (XrBool32)XR_FALSE;
-	};
-
-	if (ext_xrCreateDebugUtilsMessengerEXT)
-		ext_xrCreateDebugUtilsMessengerEXT(xr_instance, &debug_info, &xr_debug);
-	
-	// Request a form factor from the device (HMD, Handheld, etc.)
-	XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
-	systemInfo.formFactor = app_config_form;
-	xrGetSystem(xr_instance, &systemInfo, &xr_system_id);
-
-	XrGraphicsRequirementsD3D11KHR requirement = { XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR };
-	ext_xrGetD3D11GraphicsRequirementsKHR(xr_instance, xr_system_id, &requirement);
-	if (!d3d_init(requirement.adapterLuid))
-		return false;
-
-	XrGraphicsBindingD3D11KHR binding = { XR_TYPE_GRAPHICS_BINDING_D3D11_KHR };
-	binding.device = d3d_device;
-	XrSessionCreateInfo sessionInfo = { XR_TYPE_SESSION_CREATE_INFO };
-	sessionInfo.next     = &binding;
-	sessionInfo.systemId = xr_system_id;
-	xrCreateSession(xr_instance, &sessionInfo, &xr_session);
-
-	// Unable to start a session, may not have an MR device attached or ready
-	if (xr_session == nullptr)
-		return false;
-
-	XrReferenceSpaceCreateInfo ref_space = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
-	ref_space.poseInReferenceSpace = xr_pose_identity;
-	ref_space.referenceSpaceType   = XR_REFERENCE_SPACE_TYPE_LOCAL;
-	xrCreateReferenceSpace(xr_session, &ref_space, &xr_app_space);
-
-	uint32_t view_count = 0;
-	xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, app_config_view, 0, &view_count, nullptr);
-	xr_config_views.resize(view_count, { XR_TYPE_VIEW_CONFIGURATION_VIEW });
-	xr_views.resize(view_count, { XR_TYPE_VIEW });
-	xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, app_config_view, view_count, &view_count, xr_config_views.data());
-	for (uint32_t i = 0; i < view_count; i++) {
-		XrViewConfigurationView& view           = xr_config_views[i];
-		XrSwapchainCreateInfo    swapchain_info = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
-		XrSwapchain              handle;
-		swapchain_info.arraySize   = 1;
-		swapchain_info.mipCount    = 1;
-		swapchain_info.faceCount   = 1;
-		swapchain_info.format      = swapchain_format;
-		swapchain_info.width       = view.recommendedImageRectWidth;
-		swapchain_info.height      = view.recommendedImageRectHeight;
-		swapchain_info.sampleCount = view.recommendedSwapchainSampleCount;
-		swapchain_info.usageFlags  = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
-		xrCreateSwapchain(xr_session, &swapchain_info, &handle);
-
-		uint32_t surface_count = 0;
-		xrEnumerateSwapchainImages(handle, 0, &surface_count, nullptr);
-
-		swapchain_t swapchain = {};
-		swapchain.width  = swapchain_info.width;
-		swapchain.height = swapchain_info.height;
-		swapchain.handle = handle;
-		swapchain.surface_images.resize(surface_count, { XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR });
-		swapchain.surface_data.resize(surface_count);
-		xrEnumerateSwapchainImages(swapchain.handle, surface_count, &surface_count, (XrSwapchainImageBaseHeader*)swapchain.surface_images.data());
-		for (uint32_t i = 0; i < surface_count; i++) {
-			swapchain.surface_data[i] = d3d_make_surface_data((XrBaseInStructure&)swapchain.surface_images[i]);
-		}
-		xr_swapchains.push_back(swapchain);
-	}
-
-	if (!opaque_channel_init()) {
-		OutputDebugStringA("Warning: Failed to initialize opaque data channel\n");
-	}
-
-	return true;
-}
-
-void openxr_shutdown() {
-
-	for (int32_t i = 0; i < xr_swapchains.size(); i++) {
-		xrDestroySwapchain(xr_swapchains[i].handle);
-		d3d_swapchain_destroy(xr_swapchains[i]);
-	}
-	xr_swapchains.clear();
-
-	if (xr_input.actionSet != XR_NULL_HANDLE) {
-		if (xr_input.handSpace[0] != XR_NULL_HANDLE) xrDestroySpace(xr_input.handSpace[0]);
-		if (xr_input.handSpace[1] != XR_NULL_HANDLE) xrDestroySpace(xr_input.handSpace[1]);
-		xrDestroyActionSet(xr_input.actionSet);
-	}
-	if (xr_app_space != XR_NULL_HANDLE) xrDestroySpace   (xr_app_space);
-	if (xr_session   != XR_NULL_HANDLE) xrDestroySession (xr_session);
-	if (xr_debug     != XR_NULL_HANDLE) ext_xrDestroyDebugUtilsMessengerEXT(xr_debug);
-	if (xr_instance  != XR_NULL_HANDLE) xrDestroyInstance(xr_instance);
-}
-
-void openxr_poll_events(bool& exit) {
-	exit = false;
-
-	XrEventDataBuffer event_buffer = { XR_TYPE_EVENT_DATA_BUFFER };
-
-	while (xrPollEvent(xr_instance, &event_buffer) == XR_SUCCESS) {
-		switch (event_buffer.type) {
-		case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: {
-			XrEventDataSessionStateChanged* changed = (XrEventDataSessionStateChanged*)&event_buffer;
-			xr_session_state = changed->state;
-
-			// Session state change is where we can begin and end sessions, as well as find quit messages
-			switch (xr_session_state) {
-			case XR_SESSION_STATE_READY: {
-				XrSessionBeginInfo begin_info = { XR_TYPE_SESSION_BEGIN_INFO };
-				begin_info.primaryViewConfigurationType = app_config_view;
-				xrBeginSession(xr_session, &begin_info);
-				xr_running = true;
-			} break;
-			case XR_SESSION_STATE_STOPPING: {
-				xr_running = false;
-				xrEndSession(xr_session);
-			} break;
-			case XR_SESSION_STATE_EXITING: exit = true; break;
-			case XR_SESSION_STATE_LOSS_PENDING: exit = true; break;
-			}
-		} break;
-		case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING: exit = true; return;
-		}
-		event_buffer = { XR_TYPE_EVENT_DATA_BUFFER };
-	}
-}
-
-void openxr_render_frame() {
-
-	XrFrameState frame_state = { XR_TYPE_FRAME_STATE };
-	xrWaitFrame(xr_session, nullptr, &frame_state);
-	xrBeginFrame(xr_session, nullptr);
-
-	XrCompositionLayerBaseHeader* layer = nullptr;
-	XrCompositionLayerProjection layer_proj = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
-	vector<XrCompositionLayerProjectionView> views;
-	bool session_active = xr_session_state == XR_SESSION_STATE_VISIBLE || xr_session_state == XR_SESSION_STATE_FOCUSED;
-	if (session_active && openxr_render_layer(frame_state.predictedDisplayTime, views, layer_proj)) {
-		layer = (XrCompositionLayerBaseHeader*)&layer_proj;
-	}
-
-	XrFrameEndInfo end_info{ XR_TYPE_FRAME_END_INFO };
-	end_info.displayTime          = frame_state.predictedDisplayTime;
-	end_info.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
-	end_info.layerCount           = layer == nullptr ? 0 : 1;
-	end_info.layers               = &layer;
-	xrEndFrame(xr_session, &end_info);
-}
-
-bool openxr_render_layer(XrTime predictedTime, vector<XrCompositionLayerProjectionView>& views, XrCompositionLayerProjection& layer) {
-
-	// Find the state and location of each viewpoint at the predicted time
-	uint32_t         view_count  = 0;
-	XrViewState      view_state  = { XR_TYPE_VIEW_STATE };
-	XrViewLocateInfo locate_info = { XR_TYPE_VIEW_LOCATE_INFO };
-	locate_info.viewConfigurationType = app_config_view;
-	locate_info.displayTime           = predictedTime;
-	locate_info.space                 = xr_app_space;
-	xrLocateViews(xr_session, &locate_info, &view_state, (uint32_t)xr_views.size(), &view_count, xr_views.data());
-	views.resize(view_count);
-
-	for (uint32_t i = 0; i < view_count; i++) {
-
-		uint32_t img_id;
-		XrSwapchainImageAcquireInfo acquire_info = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
-		xrAcquireSwapchainImage(xr_swapchains[i].handle, &acquire_info, &img_id);
-
-		XrSwapchainImageWaitInfo wait_info = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
-		wait_info.timeout = XR_INFINITE_DURATION;
-		xrWaitSwapchainImage(xr_swapchains[i].handle, &wait_info);
-
-		// Set up rendering information for the current viewpoint
-		views[i] = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
-		views[i].pose = xr_views[i].pose;
-		views[i].fov  = xr_views[i].fov;
-		views[i].subImage.swapchain        = xr_swapchains[i].handle;
-		views[i].subImage.imageRect.offset = { 0, 0 };
-		views[i].subImage.imageRect.extent = { xr_swapchains[i].width, xr_swapchains[i].height };
-
-		d3d_render_layer(views[i], xr_swapchains[i].surface_data[img_id]);
-
-		XrSwapchainImageReleaseInfo release_info = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
-		xrReleaseSwapchainImage(xr_swapchains[i].handle, &release_info);
-	}
-
-	layer.space     = xr_app_space;
-	layer.viewCount = (uint32_t)views.size();
-	layer.views     = views.data();
-	return true;
-}
-
-bool d3d_init(LUID& adapter_luid) {
-	IDXGIAdapter1* adapter = d3d_get_adapter(adapter_luid);
-	D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0 };
-
-	if (adapter == nullptr)
-		return false;
-	if (FAILED(D3D11CreateDevice(adapter, D3D_DRIVER_TYPE_UNKNOWN, 0, 0, featureLevels, _countof(featureLevels), D3D11_SDK_VERSION, &d3d_device, nullptr, &d3d_context)))
-		return false;
-
-	adapter->Release();
-	return true;
-}
-
-bool window_swapchain_init() {
-	if (!g_debug_window || !d3d_device) {
-		return false;
-	}
-
-	// Get window dimensions
-	RECT rect;
-	GetClientRect(g_debug_window, &rect);
-	UINT width = rect.right - rect.left;
-	UINT height = rect.bottom - rect.top;
-
-	// Create DXGI factory
-	IDXGIFactory1* factory = nullptr;
-	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&factory))) {
-		return false;
-	}
-
-	// Create swap chain descriptor
-	DXGI_SWAP_CHAIN_DESC swap_desc = {};
-	swap_desc.BufferCount = 2;
-	swap_desc.BufferDesc.Width = width;
-	swap_desc.BufferDesc.Height = height;
-	swap_desc.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-	swap_desc.BufferDesc.RefreshRate.Numerator = 60;
-	swap_desc.BufferDesc.RefreshRate.Denominator = 1;
-	swap_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	swap_desc.OutputWindow = g_debug_window;
-	swap_desc.SampleDesc.Count = 1;
-	swap_desc.Windowed = TRUE;
-	swap_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-
-	// Create swap chain
-	if (FAILED(factory->CreateSwapChain(d3d_device, &swap_desc, &window_swapchain))) {
-		factory->Release();
-		return false;
-	}
-
-	factory->Release();
-
-	// Get back buffer and create render target view
-	ID3D11Texture2D* back_buffer = nullptr;
-	if (FAILED(window_swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&back_buffer))) {
-		return false;
-	}
-
-	HRESULT hr = d3d_device->CreateRenderTargetView(back_buffer, nullptr, &window_rtv);
-	back_buffer->Release();
-
-	if (FAILED(hr)) {
-		return false;
-	}
-
-	// Store dimensions
-	window_width = width;
-	window_height = height;
-
-	return true;
-}
-
-void window_handle_resize() {
-	if (!window_swapchain || !g_debug_window) {
-		return;
-	}
-
-	// Get new window dimensions
-	RECT rect;
-	GetClientRect(g_debug_window, &rect);
-	UINT new_width = rect.right - rect.left;
-	UINT new_height = rect.bottom - rect.top;
-
-	// Only resize if dimensions actually changed
-	if (new_width == window_width && new_height == window_height) {
-		return;
-	}
-
-	if (new_width == 0 || new_height == 0) {
-		return;
-	}
-
-	// Release old render target view
-	if (window_rtv) {
-		window_rtv->Release();
-		window_rtv = nullptr;
-	}
-
-	// Resize swap chain buffers
-	HRESULT hr = window_swapchain->ResizeBuffers(0, new_width, new_height, DXGI_FORMAT_UNKNOWN, 0);
-	if (FAILED(hr)) {
-		OutputDebugStringA("Failed to resize swap chain buffers\n");
-		return;
-	}
-
-	// Get new back buffer and create render target view
-	ID3D11Texture2D* back_buffer = nullptr;
-	if (FAILED(window_swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&back_buffer))) {
-		return;
-	}
-
-	hr = d3d_device->CreateRenderTargetView(back_buffer, nullptr, &window_rtv);
-	back_buffer->Release();
-
-	if (SUCCEEDED(hr)) {
-		window_width = new_width;
-		window_height = new_height;
-	}
-}
-
-void window_present_vr_view() {
-	if (!window_swapchain || !window_rtv || xr_swapchains.empty()) {
-		return;
-	}
-
-	// Handle window resize
-	window_handle_resize();
-
-	if (!window_rtv) return; // May have failed during resize
-
-	// Get window dimensions
-	RECT rect;
-	GetClientRect(g_debug_window, &rect);
-	UINT width = rect.right - rect.left;
-	UINT height = rect.bottom - rect.top;
-
-	if (width == 0 || height == 0) return;
-
-	// Calculate aspect ratio
-	float aspect = (float)width / (float)height;
-
-	// Set viewport for window
-	D3D11_VIEWPORT viewport = {};
-	viewport.Width = (float)width;
-	viewport.Height = (float)height;
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	d3d_context->RSSetViewports(1, &viewport);
-
-	float clear_color[] = { 0.098f, 0.137f, 0.294f, 1.0f };
-	d3d_context->ClearRenderTargetView(window_rtv, clear_color);
-	d3d_context->OMSetRenderTargets(1, &window_rtv, nullptr);
-
-	XrCompositionLayerProjectionView placeholder_view = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
-
-	float fov_vertical = 0.4f;
-	float fov_horizontal = 2.0f * atanf(tanf(fov_vertical / 2.0f) * aspect);
-
-	placeholder_view.fov.angleLeft = -fov_horizontal / 2.0f;
-	placeholder_view.fov.angleRight = fov_horizontal / 2.0f;
-	placeholder_view.fov.angleUp = fov_vertical / 2.0f;
-	placeholder_view.fov.angleDown = -fov_vertical / 2.0f;
-
-	placeholder_view.pose.orientation = { 0, 0, 0, 1 };
-	placeholder_view.pose.position = { 0, -0.6f, 4.0f };
-
-	app_draw(placeholder_view);
-
-	// Present to window
-	window_swapchain->Present(1, 0);
-}
-
-IDXGIAdapter1* d3d_get_adapter(LUID& adapter_luid) {
-	// Turn the LUID into a specific graphics device adapter
-	IDXGIAdapter1*     final_adapter = nullptr;
-	IDXGIAdapter1*     curr_adapter  = nullptr;
-	IDXGIFactory1*     dxgi_factory;
-	DXGI_ADAPTER_DESC1 adapter_desc;
-
-	CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)(&dxgi_factory));
-
-	int curr = 0;
-	while (dxgi_factory->EnumAdapters1(curr++, &curr_adapter) == S_OK) {
-		curr_adapter->GetDesc1(&adapter_desc);
-
-		if (memcmp(&adapter_desc.AdapterLuid, &adapter_luid, sizeof(&adapter_luid)) == 0) {
-			final_adapter = curr_adapter;
-			break;
-		}
-		curr_adapter->Release();
-		curr_adapter = nullptr;
-	}
-	dxgi_factory->Release();
-	return final_adapter;
-}
-
-void d3d_shutdown() {
-	if (window_rtv) { window_rtv->Release(); window_rtv = nullptr; }
-	if (window_swapchain) { window_swapchain->Release(); window_swapchain = nullptr; }
-	if (d3d_context) { d3d_context->Release(); d3d_context = nullptr; }
-	if (d3d_device) { d3d_device->Release(); d3d_device = nullptr; }
-}
-
-swapchain_surfdata_t d3d_make_surface_data(XrBaseInStructure& swapchain_img) {
-	swapchain_surfdata_t result = {};
-
-	// Get information about the swapchain image created by OpenXR
-	XrSwapchainImageD3D11KHR& d3d_swapchain_img = (XrSwapchainImageD3D11KHR&)swapchain_img;
-	D3D11_TEXTURE2D_DESC      color_desc;
-	d3d_swapchain_img.texture->GetDesc(&color_desc);
-
-	// Create a view resource for the swapchain image target that we can use to set up rendering.
-	D3D11_RENDER_TARGET_VIEW_DESC target_desc = {};
-	target_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-	target_desc.Format        = (DXGI_FORMAT)d3d_swapchain_fmt;
-	d3d_device->CreateRenderTargetView(d3d_swapchain_img.texture, &target_desc, &result.target_view);
-
-	// Create a depth buffer that matches the swapchain dimensions
-	ID3D11Texture2D*     depth_texture;
-	D3D11_TEXTURE2D_DESC depth_desc = {};
-	depth_desc.SampleDesc.Count = 1;
-	depth_desc.MipLevels        = 1;
-	depth_desc.Width            = color_desc.Width;
-	depth_desc.Height           = color_desc.Height;
-	depth_desc.ArraySize        = color_desc.ArraySize;
-	depth_desc.Format           = DXGI_FORMAT_R32_TYPELESS;
-	depth_desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_DEPTH_STENCIL;
-	d3d_device->CreateTexture2D(&depth_desc, nullptr, &depth_texture);
-
-	// Create a view resource for the depth buffer for rendering setup
-	D3D11_DEPTH_STENCIL_VIEW_DESC stencil_desc = {};
-	stencil_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-	stencil_desc.Format        = DXGI_FORMAT_D32_FLOAT;
-	d3d_device->CreateDepthStencilView(depth_texture, &stencil_desc, &result.depth_view);
-
-	// We don't need direct access to the ID3D11Texture2D object anymore, we only need the view
-	depth_texture->Release();
-
-	return result;
-}
-
-void d3d_render_layer(XrCompositionLayerProjectionView& view, swapchain_surfdata_t& surface) {
-	XrRect2Di&     rect     = view.subImage.imageRect;
-	D3D11_VIEWPORT viewport = CD3D11_VIEWPORT((float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height);
-	d3d_context->RSSetViewports(1, &viewport);
-
-	// Clear swapchain color and depth targets and prepare for rendering
-	// Navy blue background color
-	float clear[] = { 0.098f, 0.137f, 0.294f, 1.0f }; // R, G, B, A
-	d3d_context->ClearRenderTargetView(surface.target_view, clear);
-	d3d_context->ClearDepthStencilView(surface.depth_view, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	d3d_context->OMSetRenderTargets(1, &surface.target_view, surface.depth_view);
-
-	app_draw(view);
-}
-
-void d3d_swapchain_destroy(swapchain_t& swapchain) {
-	for (uint32_t i = 0; i < swapchain.surface_data.size(); i++) {
-		swapchain.surface_data[i].depth_view ->Release();
-		swapchain.surface_data[i].target_view->Release();
-	}
-}
-
-XMMATRIX d3d_xr_projection(XrFovf fov, float clip_near, float clip_far) {
-	const float left  = clip_near * tanf(fov.angleLeft);
-	const float right = clip_near * tanf(fov.angleRight);
-	const float down  = clip_near * tanf(fov.angleDown);
-	const float up    = clip_near * tanf(fov.angleUp);
-
-	return XMMatrixPerspectiveOffCenterRH(left, right, down, up, clip_near, clip_far);
-}
-
-ID3DBlob* d3d_compile_shader(const char* hlsl, const char* entrypoint, const char* target) {
-	DWORD flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
-#ifdef _DEBUG
-	flags |= D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_DEBUG;
-#else
-	flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-#endif
-
-	ID3DBlob* compiled;
-	ID3DBlob* errors;
-	if (FAILED(D3DCompile(hlsl, strlen(hlsl), nullptr, nullptr, nullptr, entrypoint, target, flags, 0, &compiled, &errors)))
-		printf("Error: D3DCompile failed %s", (char*)errors->GetBufferPointer());
-	if (errors) errors->Release();
-
-	return compiled;
-}
-
-void app_init() {
-	// Compile shaders (use new cube shader code)
-	ID3DBlob* vert_shader_blob = d3d_compile_shader(screen_shader_code, "vs", "vs_5_0");
-	ID3DBlob* pixel_shader_blob = d3d_compile_shader(screen_shader_code, "ps", "ps_5_0");
-
-	d3d_device->CreateVertexShader(vert_shader_blob->GetBufferPointer(), vert_shader_blob->GetBufferSize(), nullptr, &app_vshader);
-
-	d3d_device->CreatePixelShader(pixel_shader_blob->GetBufferPointer(), pixel_shader_blob->GetBufferSize(), nullptr, &app_pshader);
-
-	// Update vertex layout for color and normal coordinates
-	D3D11_INPUT_ELEMENT_DESC vert_desc[] = {
-		{"SV_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"COLOR",       0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"NORMAL",      0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-	};
-
-	d3d_device->CreateInputLayout(vert_desc, (UINT)_countof(vert_desc), vert_shader_blob->GetBufferPointer(), vert_shader_blob->GetBufferSize(), &app_shader_layout);
-	// Create GPU resources for cube
-	D3D11_SUBRESOURCE_DATA vert_buff_data = { screen_verts };
-	D3D11_SUBRESOURCE_DATA ind_buff_data = { screen_inds };
-	CD3D11_BUFFER_DESC vert_buff_desc(sizeof(screen_verts), D3D11_BIND_VERTEX_BUFFER);
-	CD3D11_BUFFER_DESC ind_buff_desc(sizeof(screen_inds), D3D11_BIND_INDEX_BUFFER);
-	CD3D11_BUFFER_DESC const_buff_desc(sizeof(app_transform_buffer_t), D3D11_BIND_CONSTANT_BUFFER);
-
-	d3d_device->CreateBuffer(&vert_buff_desc, &vert_buff_data, &app_vertex_buffer);
-	d3d_device->CreateBuffer(&ind_buff_desc, &ind_buff_data, &app_index_buffer);
-	d3d_device->CreateBuffer(&const_buff_desc, nullptr, &app_constant_buffer);
-
-	// Create rasterizer state with no culling so all cube faces are visible
-	D3D11_RASTERIZER_DESC raster_desc = {};
-	raster_desc.FillMode = D3D11_FILL_SOLID;
-	raster_desc.CullMode = D3D11_CULL_NONE;  // Disable back-face culling
-	raster_desc.FrontCounterClockwise = FALSE;
-	raster_desc.DepthClipEnable = TRUE;
-	d3d_device->CreateRasterizerState(&raster_desc, &app_rasterizer_state);
-
-}
-
-void app_draw(XrCompositionLayerProjectionView& view) {
-	static int frame_count = 0;
-	frame_count++;
-
-	// Set up camera matrices
-	// Reading camera matrices from headset via OpenXR
-	XMMATRIX mat_projection = d3d_xr_projection(view.fov, 0.05f, 100.0f);
-	XMMATRIX mat_view = XMMatrixInverse(nullptr, XMMatrixAffineTransformation(
-		DirectX::g_XMOne, DirectX::g_XMZero,
-		XMLoadFloat4((XMFLOAT4*)&view.pose.orientation),
-		XMLoadFloat3((XMFLOAT3*)&view.pose.position)));
-
-	// Set shaders and buffers
-	d3d_context->VSSetConstantBuffers(0, 1, &app_constant_buffer);
-	d3d_context->VSSetShader(app_vshader, nullptr, 0);
-	d3d_context->PSSetShader(app_pshader, nullptr, 0);
-
-	// Set rasterizer state to disable culling
-	d3d_context->RSSetState(app_rasterizer_state);
-
-	// Set up cube mesh
-	UINT strides[] = { sizeof(float) * 9 }; // pos(3) + color(3) + normal(3)
-	UINT offsets[] = { 0 };
-	d3d_context->IASetVertexBuffers(0, 1, &app_vertex_buffer, strides, offsets);
-	d3d_context->IASetIndexBuffer(app_index_buffer, DXGI_FORMAT_R16_UINT, 0);
-	d3d_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	d3d_context->IASetInputLayout(app_shader_layout);
-
-	// Add rotation animation (single axis, slow spin)
-	float angle = frame_count * 0.002f;
-	XMMATRIX mat_rotation = XMMatrixRotationY(angle);
-
-	XMMATRIX mat_model = XMMatrixScaling(0.7f, 0.7f, 0.7f) * mat_rotation * XMMatrixTranslation(0.0f, -0.6f, -2.0f);
-
-	// Update shader constants
-	app_transform_buffer_t transform_buffer;
-	XMStoreFloat4x4(&transform_buffer.world, XMMatrixTranspose(mat_model));
-	XMStoreFloat4x4(&transform_buffer.viewproj, XMMatrixTranspose(mat_view * mat_projection));
-
-	d3d_context->UpdateSubresource(app_constant_buffer, 0, nullptr, &transform_buffer, 0, 0);
-	d3d_context->DrawIndexed((UINT)_countof(screen_inds), 0, 0);
-}
\ No newline at end of file
+//===----------------------------------------------------------------------===//
+// Copyright © 2026 Apple Inc. and the StreamingSession project authors.
+//
+// Licensed under the MIT license (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// StreamingSession/LICENSE.txt
+//
+//===----------------------------------------------------------------------===//
+
+#pragma comment(lib, "D3D11.lib")
+#pragma comment(lib, "D3dcompiler.lib")
+#pragma comment(lib, "Dxgi.lib")
+#pragma comment(lib, "Version.lib")
+
+#define XR_USE_PLATFORM_WIN32
+#define XR_USE_GRAPHICS_API_D3D11
+#ifdef XR_SAMPLE_VULKAN
+#define XR_USE_GRAPHICS_API_VULKAN
+#include <vulkan/vulkan.h>
+#endif
+
+#include <dxgi1_3.h>
+#include <d3d11.h>
+#include <d3d11_3.h>
+#include <directxmath.h>
+#include <d3dcompiler.h>
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <windows.h>
+#include "MessageChannel.h"
+#include "ThreadPolicy.h"
+#include "FrameTimers.h"
+#include "FramePipeline.h"
+#include "LateLatch.h"
+#include "FrameArena.h"
+#include "DynamicResolution.h"
+#include "ShaderCache.h"
+#include "StartupGraph.h"
+#include "Foveation.h"
+#include "RenderBackend.h"
+#include "VulkanBackend.h"
+#include "Culling.h"
+#include "Scene.h"
+#include "Transforms.h"
+#include "DrawSort.h"
+#include "RenderWorkers.h"
+
+using namespace std;
+using namespace DirectX;
+
+// What a render_handle_t pipeline points to for the D3D11 backend
+struct d3d_pipeline_t {
+	ID3D11VertexShader*      vshader;
+	ID3D11PixelShader*       pshader;
+	ID3D11InputLayout*       layout;
+	ID3D11RasterizerState*   raster;
+	ID3D11DepthStencilState* depth;       // nullptr for the default depth test
+	ID3D11SamplerState*      samplers[2]; // Pixel shader s0 and s1
+	D3D11_PRIMITIVE_TOPOLOGY topology;
+};
+
+struct swapchain_surfdata_t {
+	ID3D11DepthStencilView* depth_view;  // Shared through d3d_depth_pool, not owned
+	ID3D11RenderTargetView* target_view;
+};
+
+// Depth targets are shared by every swapchain image of the same size. Only
+// one image is rendered at a time, so one depth buffer per size is enough,
+// instead of one per swapchain image.
+struct d3d_depth_target_t {
+	int32_t                 width;
+	int32_t                 height;
+	int32_t                 array_size; // Slices, 2 for single pass stereo
+	int32_t                 users; // Swapchain images using this target
+	ID3D11Texture2D*        texture;
+	ID3D11DepthStencilView* view;
+};
+
+// Low resolution color and depth for the periphery pass of foveated
+// rendering. Both are sampled when the periphery is upscaled into the
+// swapchain image, so depth is typeless like the depth pool.
+struct d3d_periphery_target_t {
+	int32_t                   width;
+	int32_t                   height;
+	ID3D11Texture2D*          color;
+	ID3D11RenderTargetView*   color_target;
+	ID3D11ShaderResourceView* color_resource;
+	ID3D11Texture2D*          depth;
+	ID3D11DepthStencilView*   depth_target;
+	ID3D11ShaderResourceView* depth_resource;
+};
+
+struct swapchain_t {
+	XrSwapchain                      handle;
+	int32_t                          width;
+	int32_t                          height;
+	int32_t                          recommended_width;  // Dynamic resolution scales relative to these,
+	int32_t                          recommended_height; // width and height are the upper limit
+	int32_t                          array_size;         // Views rendered into this swapchain, one per slice
+	vector<XrSwapchainImageD3D11KHR> surface_images;
+	vector<swapchain_surfdata_t>     surface_data;
+	// With -submitDepth, depth renders into a depth swapchain, which takes the
+	// place of the shared depth pool, and is submitted alongside color
+	XrSwapchain                      depth_handle;
+	vector<XrSwapchainImageD3D11KHR> depth_images;
+	vector<ID3D11DepthStencilView*>  depth_views;
+	d3d_periphery_target_t           periphery; // With -foveate
+	vector<render_handle_t>          vk_targets; // With -vulkan, a vk_target_t per image
+};
+
+struct input_state_t {
+	XrActionSet actionSet;
+	XrAction    poseAction;
+	XrAction    selectAction;
+	XrPath      handSubactionPath[2];
+	XrSpace     handSpace[2];
+	XrPosef     handPose[2];
+	XrBool32    renderHand[2];
+	XrBool32    handSelect[2];
+	XrAction    gazeAction; // XR_EXT_eye_gaze_interaction, for foveation
+	XrSpace     gazeSpace;
+};
+
+PFN_xrGetD3D11GraphicsRequirementsKHR ext_xrGetD3D11GraphicsRequirementsKHR = nullptr;
+PFN_xrCreateDebugUtilsMessengerEXT    ext_xrCreateDebugUtilsMessengerEXT    = nullptr;
+PFN_xrDestroyDebugUtilsMessengerEXT   ext_xrDestroyDebugUtilsMessengerEXT   = nullptr;
+
+// Per-material constants (b0) and per-view constants (b1). World matrices
+// are per instance, see Scene.h. The view buffer is written right before a
+// view's draws are submitted, which is what lets late latching patch in the
+// freshest pose.
+struct app_material_buffer_t {
+	XMFLOAT4 tint;
+};
+
+struct app_view_buffer_t {
+	XMFLOAT4X4 viewproj;
+};
+
+// Both eyes' view constants (b2) for single pass stereo
+struct app_stereo_view_buffer_t {
+	XMFLOAT4X4 viewproj[2];
+};
+
+// Constants (b2) for the full screen blits: the foveation periphery upscale
+// and the spectator mirror. Rects are in pixels of the render target, and
+// source_scale maps them to the part of the source texture being drawn.
+struct app_blit_buffer_t {
+	XMFLOAT4 fovea_rect;   // x0, y0, x1, y1, periphery upscale only
+	XMFLOAT4 dest_rect;    // x, y, width, height
+	XMFLOAT4 source_scale; // xy scale, zw offset, in texture coordinates
+};
+
+// Everything the render side needs to draw one frame. Produced by the frame
+// thread after xrWaitFrame, consumed by whichever thread submits the frame.
+struct app_frame_t {
+	XrFrameState state;
+	uint64_t     index;
+	bool         visible;    // Session state sampled on the frame thread
+	XMFLOAT4X4   cube_world;
+	uint64_t     pump_ticks; // Frame thread CPU time, handed over to the
+	uint64_t     wait_ticks; // render side's frame timers
+	bool         gaze_valid; // Eye gaze at predicted display time, if tracked
+	XrPosef      gaze;
+};
+
+XrFormFactor            app_config_form = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+XrViewConfigurationType app_config_view = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+bool                    app_is_ios_mode = false;
+
+ID3D11VertexShader*    app_vshader;
+ID3D11VertexShader*    app_stereo_vshader; // Single pass stereo, nullptr where the device can't select the slice from it
+ID3D11PixelShader*     app_pshader;
+ID3D11InputLayout*     app_shader_layout;
+ID3D11InputLayout*     app_stereo_layout;  // Each instance's world matrix used for both eyes
+ID3D11Buffer*          app_material_buffer;
+ID3D11Buffer*          app_view_buffer;
+ID3D11Buffer*          app_stereo_view_buffer;
+ID3D11Buffer*          app_vertex_buffer;
+ID3D11Buffer*          app_index_buffer;
+ID3D11Buffer*          app_instance_buffer; // Dynamic, rewritten each frame with the visible instances
+ID3D11RasterizerState* app_rasterizer_state;
+ID3D11RasterizerState* app_rasterizer_scissor; // app_rasterizer_state with scissoring, for the fovea
+
+ID3D11VertexShader*      app_blit_vshader;
+ID3D11PixelShader*       app_blit_pshader;
+ID3D11PixelShader*       app_mirror_pshader;
+ID3D11Buffer*            app_blit_buffer;
+ID3D11SamplerState*      app_blit_samplers[2]; // Linear for color, point for depth
+ID3D11DepthStencilState* app_blit_depth_state; // Always passes, and writes depth
+
+d3d_pipeline_t app_cube_pipeline;
+d3d_pipeline_t app_cube_scissor_pipeline; // Fovea pass of foveated rendering
+d3d_pipeline_t app_cube_stereo_pipeline;  // Single pass stereo
+d3d_pipeline_t app_blit_pipeline;
+d3d_pipeline_t app_mirror_pipeline;
+
+// Buffers every scene draw shares, from whichever backend renders. Meshes,
+// and materials with their pipelines, are in app_scene.
+struct app_draw_buffers_t {
+	render_handle_t material_constants;
+	render_handle_t view_constants;
+	render_handle_t stereo_view_constants;
+	render_handle_t instance_buffer;
+};
+app_draw_buffers_t app_draw_buffers = {};
+
+// The spinning cube is the hero object. With -props a floor of
+// app_prop_grid x app_prop_grid smaller cubes in a few tints surrounds it.
+scene_t        app_scene;
+uint32_t       app_hero_object = 0;
+bool           app_props       = false;
+const uint32_t app_prop_grid   = 64;
+
+// Spin of the hero cube, in radians per second. The cube used to turn 0.002
+// radians per draw, with both eyes and the spectator drawing it every frame,
+// which is 0.54 radians per second at 90 Hz.
+const double app_spin_rate = 0.54;
+
+// World matrices of the scene, updated once per frame on the frame thread.
+// The props hang off one floor node and never move, so each frame only the
+// hero's node is dirty.
+transform_t     app_transforms;
+uint32_t        app_hero_node = 0;
+transform_trs_t app_hero_local;
+
+// All drawing goes through app_render. With -nullRender nothing reaches the
+// GPU, and with -recordCommands one frame's command stream is logged.
+render_context_t   app_render          = {};
+bool               app_null_render     = false;
+bool               app_record_commands = false;
+render_recording_t app_recording;
+uint64_t           app_record_frame    = 90; // Late enough to be a steady state frame
+render_recording_t app_order_recording;      // Scratch for app_log_draw_order, reserved up front
+
+// With -vulkan, in a build with XR_SAMPLE_VULKAN, the session renders through
+// XR_KHR_vulkan_enable2 and the Vulkan backend instead of D3D11
+bool               app_vulkan          = false;
+
+// With -parallelRecord the views' draws are recorded by app_workers, split
+// into chunks by app_record_layers, see RenderWorkers.h. D3D11 records each
+// chunk into a deferred context of its own; the other backends record into
+// the chunks' streams, which are replayed to app_render.
+struct app_record_chunk_t {
+	uint32_t view;       // Into app_record_views
+	uint32_t first_draw; // Draws [first_draw, end_draw) of app_scene.draws
+	uint32_t end_draw;
+	bool     clear;      // First chunk of its view
+};
+struct app_record_view_t {
+	XrCompositionLayerProjectionView* view; // Both views with single pass stereo
+	render_handle_t                   color;
+	render_handle_t                   depth;
+};
+bool               app_parallel_record  = false;
+render_workers_t   app_workers;
+app_record_chunk_t app_record_chunks[RENDER_WORKERS_MAX_CHUNKS];
+app_record_view_t  app_record_views[LATE_LATCH_MAX_VIEWS];
+bool               app_record_stereo    = false;
+const uint32_t     app_record_min_draws = 16; // Splitting a view finer than this costs more than it saves
+
+// Clip planes for every projection. Submitted depth reports the same values,
+// so the runtime can turn depth back into distance.
+const float app_clip_near = 0.05f;
+const float app_clip_far  = 100.0f;
+shader_blob_t          app_shader_blobs[6]; // Cube and blit vertex and pixel shaders, mirror pixel shader, then stereo cube vertex shader
+
+bool app_startup();
+bool app_load_shaders();
+bool app_init();
+#ifdef XR_SAMPLE_VULKAN
+bool app_init_vk();
+bool app_vk_validate(uint32_t frames);
+#endif
+void app_update(app_frame_t& frame);
+void app_render_frame(app_frame_t& frame);
+void app_render_layer(XrCompositionLayerProjectionView& layerView, render_handle_t color, render_handle_t depth);
+void app_render_layer_stereo(XrCompositionLayerProjectionView* layerViews, render_handle_t color, render_handle_t depth);
+void app_draw(XrCompositionLayerProjectionView& layerView, render_handle_t pipeline = nullptr);
+void app_draw_stereo(XrCompositionLayerProjectionView* layerViews);
+void app_draw_buckets(render_context_t& render, const XrCompositionLayerProjectionView& layerView, render_handle_t pipeline, uint32_t first_draw, uint32_t end_draw);
+void app_draw_stereo_buckets(render_context_t& render, const XrCompositionLayerProjectionView* layerViews, uint32_t first_draw, uint32_t end_draw);
+void app_record_layers(uint32_t view_count, bool stereo);
+void app_record_chunk(render_context_t& render, uint32_t chunk, void* user);
+void app_build_scene(const scene_mesh_t& mesh, render_handle_t pipeline, render_handle_t stereo_pipeline);
+void app_prepare_scene(const XrView* views, uint32_t view_count);
+void app_log_draw_order(const XrView& view, const float eye[3]);
+XMFLOAT4X4 app_view_proj(const XrCompositionLayerProjectionView& layerView);
+bool app_poll_channel_events();
+bool app_handle_channel_message(const uint8_t* data, uint32_t size);
+double app_time_s();
+void app_idle_wait(bool activity);
+
+// Idle waits back off from 1 ms to app_idle_max_wait_ms while nothing
+// happens, and drop back to 1 ms as soon as anything does.
+uint32_t app_idle_max_wait_ms = 50;
+uint32_t app_idle_wait_ms     = 1;
+
+std::chrono::steady_clock::time_point app_launch_time;
+double                                app_first_frame_ms = -1; // Time to first frame, once there has been one
+
+// With -pipelined, wWinMain becomes the frame thread (messages, events,
+// xrWaitFrame, simulation) and app_pipeline's render thread submits frames.
+bool                          app_pipelined   = false;
+frame_pipeline_t<app_frame_t> app_pipeline;
+app_frame_t                   app_frame_state = {}; // Frame being rendered, owned by the render side
+
+// With -foveate, the area around the gaze renders at full resolution and the
+// rest at foveation_config_t::periphery_scale
+foveation_t app_foveation;
+
+// Scene bounds, culled once per frame against a frustum around every view.
+// The visible list is shared by all views.
+cull_t app_cull;
+
+const XrPosef              xr_pose_identity = {{0, 0, 0, 1}, {0, 0, 0}};
+XrSession                  xr_session       = {};
+XrInstance                 xr_instance      = {};
+XrSessionState             xr_session_state = XR_SESSION_STATE_UNKNOWN;
+bool                       xr_running       = false;
+XrSpace                    xr_app_space     = {};
+input_state_t              xr_input         = {};
+late_latch_t               xr_late_latch    = {};
+dynres_t                   xr_dynres        = {};
+bool                       xr_submit_depth  = false; // Chain XrCompositionLayerDepthInfoKHR onto each projection view
+bool                       xr_eye_gaze_ext  = false; // XR_EXT_eye_gaze_interaction is enabled
+bool                       xr_single_pass   = false; // One array swapchain for both eyes, rendered in one pass
+uint64_t                   xr_frames_rendered  = 0; // Ended with a projection layer
+uint64_t                   xr_frames_skipped   = 0; // Ended with no layers: shouldRender was false, or the session wasn't visible
+XrDebugUtilsMessengerEXT   xr_debug         = {};
+XrSystemId                 xr_system_id     = XR_NULL_SYSTEM_ID;
+
+vector<XrView>                  xr_views;
+vector<XrViewConfigurationView> xr_config_views;
+vector<swapchain_t>             xr_swapchains;
+
+bool openxr_init_instance(const char* app_name);
+bool openxr_init_device();
+bool openxr_init_session();
+bool openxr_init_swapchains(int64_t swapchain_format);
+bool openxr_init_eye_gaze();
+void openxr_shutdown();
+bool openxr_poll_events(bool& exit);
+void openxr_wait_frame(app_frame_t& frame);
+bool openxr_render_frame(app_frame_t& frame);
+bool openxr_render_layer(XrTime predictedTime, frame_vector<XrCompositionLayerProjectionView>& projectionViews, XrCompositionLayerProjection& layer, std::chrono::steady_clock::time_point& render_start);
+void openxr_release_images(const swapchain_t& swapchain);
+bool openxr_locate_views(void* context, XrTime display_time, XrView* views, uint32_t view_count);
+
+ID3D11Device*        d3d_device        = nullptr;
+ID3D11DeviceContext* d3d_context       = nullptr;
+
+// Deferred contexts for -parallelRecord, one per chunk, and the command list
+// each chunk finished with this frame
+ID3D11DeviceContext* d3d_deferred     [RENDER_WORKERS_MAX_CHUNKS] = {};
+ID3D11CommandList*   d3d_command_lists[RENDER_WORKERS_MAX_CHUNKS] = {};
+int64_t              d3d_swapchain_fmt = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+// GPU frame time for dynamic resolution. Timestamp queries are read back a
+// few frames later with DONOTFLUSH, so the CPU never waits on the GPU.
+#define D3D_GPU_TIMER_LATENCY 4
+struct d3d_gpu_timer_t {
+	ID3D11Query* disjoint[D3D_GPU_TIMER_LATENCY];
+	ID3D11Query* start   [D3D_GPU_TIMER_LATENCY];
+	ID3D11Query* end     [D3D_GPU_TIMER_LATENCY];
+	uint64_t     issued; // Frames timed so far
+	uint64_t     read;   // Frames read back or dropped so far
+};
+d3d_gpu_timer_t d3d_gpu_timer = {};
+
+vector<d3d_depth_target_t> d3d_depth_pool;
+
+// Window swap chain for spectator view
+IDXGISwapChain*         window_swapchain = nullptr;
+ID3D11RenderTargetView* window_rtv        = nullptr;
+UINT                    window_width      = 0;
+UINT                    window_height     = 0;
+
+// The spectator either mirrors the left eye, or with -spectatorCamera renders
+// the scene again from its own camera, only every window_camera_interval
+// rendered frames since that is a whole extra scene render.
+enum window_mode_t {
+	window_mode_mirror = 0,
+	window_mode_camera,
+};
+window_mode_t             window_mode            = window_mode_mirror;
+uint32_t                  window_camera_interval = 3;
+uint64_t                  window_frames          = 0;
+
+// Copy of the last left eye image, taken before its swapchain image is
+// released. Typeless, so it can be read back without the sRGB conversion the
+// eye image was written with, and mipmapped for downsampling.
+ID3D11Texture2D*          window_mirror          = nullptr;
+ID3D11ShaderResourceView* window_mirror_resource = nullptr;
+XrExtent2Di               window_mirror_size     = {};
+XrExtent2Di               window_mirror_extent   = {}; // Part of window_mirror holding the eye image
+uint32_t                  window_mirror_mips     = 0;  // Levels in window_mirror
+uint32_t                  window_mirror_levels   = 0;  // Levels window_mirror_resource covers, those the blit samples
+
+// The spectator presents on the XR render path, so it must never block. The
+// swap chain's frame latency object is signaled when the desktop can take
+// another frame; until then, spectator frames are dropped, and Present uses
+// DXGI_PRESENT_DO_NOT_WAIT in case it would still block.
+HANDLE                    window_frame_latency   = nullptr;
+UINT                      window_swapchain_flags = 0; // As created, ResizeBuffers must match them
+bool                      window_frame_slot      = false; // Latency object was signaled, and not yet used by a Present
+uint64_t                  window_presented       = 0;
+uint64_t                  window_dropped         = 0;
+
+bool d3d_init(LUID& adapter_luid);
+void d3d_shutdown();
+IDXGIAdapter1* d3d_get_adapter(LUID& adapter_luid);
+swapchain_surfdata_t d3d_make_surface_data(XrBaseInStructure& swapchainImage, bool shared_depth);
+ID3D11DepthStencilView* d3d_make_depth_view(XrBaseInStructure& swapchainImage);
+ID3D11DepthStencilView* d3d_depth_acquire(int32_t width, int32_t height, int32_t array_size);
+void d3d_depth_release(ID3D11DepthStencilView* view);
+void d3d_memory_report();
+bool d3d_single_pass_supported();
+bool  d3d_gpu_timer_init();
+void  d3d_gpu_timer_destroy();
+void  d3d_gpu_timer_begin();
+void  d3d_gpu_timer_end();
+float d3d_gpu_timer_read();
+void d3d_execute(void* context, const render_command_t& command, const void* data);
+void d3d_render_layer_foveated(XrCompositionLayerProjectionView& layerView, swapchain_surfdata_t& surface, d3d_periphery_target_t& periphery, const foveation_map_t& map);
+void d3d_blit_periphery(d3d_periphery_target_t& periphery, const foveation_map_t& map, const XrRect2Di& rect, float width, float height);
+bool d3d_make_periphery_target(int32_t width, int32_t height, d3d_periphery_target_t& result);
+void d3d_periphery_destroy(d3d_periphery_target_t& target);
+void d3d_swapchain_destroy(swapchain_t& swapchain);
+XMMATRIX d3d_xr_projection(XrFovf fov, float clip_near, float clip_far);
+uint32_t d3d_shader_flags();
+bool d3d_compile_shader(const shader_desc_t& desc, vector<uint8_t>& bytecode);
+void d3d_compiler_identity(char* identity, size_t size);
+bool window_swapchain_init();
+void window_present_vr_view();
+void window_handle_resize();
+bool window_frame_ready();
+void window_present();
+void window_mirror_copy(ID3D11Texture2D* source, const XrRect2Di& rect);
+bool window_draw_mirror(UINT width, UINT height);
+
+// Cube shader with lighting, from Shaders/screen.hlsl. The strings around
+// it balance the lines that make the file a raw string, so the text
+// D3DCompile sees preprocesses to just the file's HLSL.
+constexpr char screen_shader_code[] = "#ifdef __cplusplus\n\""
+#include "Shaders/screen.hlsl"
+	"\"\n#endif\n";
+
+// Full screen blits, from Shaders/blit.hlsl, included the same way
+constexpr char blit_shader_code[] = "#ifdef __cplusplus\n\""
+#include "Shaders/blit.hlsl"
+	"\"\n#endif\n";
+
+// The same entry points, built by FxCompile into $(IntDir)EmbeddedShaders
+#include "EmbeddedShaders/vs.h"
+#include "EmbeddedShaders/ps.h"
+#include "EmbeddedShaders/vs_blit.h"
+#include "EmbeddedShaders/ps_blit.h"
+#include "EmbeddedShaders/ps_mirror.h"
+#include "EmbeddedShaders/vs_stereo.h"
+
+// Cube geometry
+float screen_verts[] = {
+	// Position (x, y, z) + Color (r, g, b) + Normal (x, y, z) - White/Light gray
+	// Light gray RGB: (0.95, 0.95, 0.95) - very light gray, almost white
+	// Front face (normal pointing forward: 0, 0, 1)
+	-0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 0
+	 0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 1
+	 0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 2
+	-0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, 1.0f,  // 3
+	// Back face (normal pointing backward: 0, 0, -1)
+	-0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 4
+	 0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 5
+	 0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 6
+	-0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 0.0f, -1.0f,  // 7
+	// Left face (normal pointing left: -1, 0, 0)
+	-0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 8
+	-0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 9
+	-0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 10
+	-0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   -1.0f, 0.0f, 0.0f,  // 11
+	// Right face (normal pointing right: 1, 0, 0)
+	 0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 12
+	 0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 13
+	 0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 14
+	 0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   1.0f, 0.0f, 0.0f,  // 15
+	// Top face (normal pointing up: 0, 1, 0)
+	-0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 16
+	-0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 17
+	 0.5f,  0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 18
+	 0.5f,  0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, 1.0f, 0.0f,  // 19
+	// Bottom face (normal pointing down: 0, -1, 0)
+	-0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 20
+	-0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 21
+	 0.5f, -0.5f,  0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 22
+	 0.5f, -0.5f, -0.5f,   0.95f, 0.95f, 0.95f,   0.0f, -1.0f, 0.0f,  // 23
+};
+
+uint16_t screen_inds[] = {
+	// Front face
+	0, 1, 2,  0, 2, 3,
+	// Back face
+	5, 4, 7,  5, 7, 6,
+	// Left face
+	8, 9, 10,  8, 10, 11,
+	// Right face
+	12, 13, 14,  12, 14, 15,
+	// Top face
+	16, 17, 18,  16, 18, 19,
+	// Bottom face
+	20, 21, 22,  20, 22, 23
+};
+
+HWND g_debug_window = nullptr;
+
+LRESULT CALLBACK DebugWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	switch (msg) {
+	case WM_PAINT: {
+		PAINTSTRUCT ps;
+		HDC hdc = BeginPaint(hwnd, &ps);
+
+		// Set text color to green
+		SetTextColor(hdc, RGB(0, 255, 0));
+		SetBkColor(hdc, RGB(30, 30, 30));
+
+		// Draw text
+		const char* text = "StreamingSession OpenXR App is running";
+		TextOutA(hdc, 20, 20, text, strlen(text));
+
+		EndPaint(hwnd, &ps);
+		break;
+	}
+	case WM_CLOSE:
+		DestroyWindow(hwnd);
+		return 0;
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		return 0;
+	}
+	return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+void create_window() {
+	WNDCLASS wc = {};
+	wc.lpfnWndProc = DebugWindowProc;
+	wc.hInstance = GetModuleHandle(nullptr);
+	wc.lpszClassName = "DebugWindow";
+	wc.hbrBackground = CreateSolidBrush(RGB(30, 30, 30));
+	wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+
+	RegisterClass(&wc);
+
+	g_debug_window = CreateWindowA(
+		"DebugWindow",
+		"StreamingSession OpenXR App",
+		WS_OVERLAPPEDWINDOW,
+		100, 100, 600, 600,
+		nullptr, nullptr, GetModuleHandle(nullptr), nullptr
+	);
+
+	ShowWindow(g_debug_window, SW_SHOW);
+	UpdateWindow(g_debug_window);
+}
+
+int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR cmdLine, int) {
+	app_launch_time = std::chrono::steady_clock::now();
+
+	// Parse command line arguments                                                                                                                                                                                                                         
+	// Culling benchmark, up to 100k objects. Needs neither OpenXR nor a GPU.
+	if (cmdLine && wcsstr(cmdLine, L"-benchCull")) {
+		bool passed = cull_benchmark(100000);
+		OutputDebugStringA(passed ? "Culling benchmark passed\n" : "Culling benchmark FAILED\n");
+		return passed ? 0 : 1;
+	}
+	// Transform hierarchy benchmark, up to 1M nodes, also headless
+	if (cmdLine && wcsstr(cmdLine, L"-benchTransforms")) {
+		bool passed = transform_benchmark(1000000);
+		OutputDebugStringA(passed ? "Transform benchmark passed\n" : "Transform benchmark FAILED\n");
+		return passed ? 0 : 1;
+	}
+	// Draw sort benchmark, up to 100k draws, also headless
+	if (cmdLine && wcsstr(cmdLine, L"-benchDrawSort")) {
+		bool passed = draw_sort_benchmark(100000);
+		OutputDebugStringA(passed ? "Draw sort benchmark passed\n" : "Draw sort benchmark FAILED\n");
+		return passed ? 0 : 1;
+	}
+	// Opaque data channel receive benchmark, up to 100k messages, against a stub runtime
+	if (cmdLine && wcsstr(cmdLine, L"-benchChannel")) {
+		bool passed = opaque_channel_benchmark(100000);
+		OutputDebugStringA(passed ? "Channel benchmark passed\n" : "Channel benchmark FAILED\n");
+		return passed ? 0 : 1;
+	}
+#ifdef XR_SAMPLE_VULKAN
+	// Vulkan render path without OpenXR or a headset, 90 frames offscreen
+	if (cmdLine && wcsstr(cmdLine, L"-vkValidate")) {
+		bool passed = app_vk_validate(90);
+		OutputDebugStringA(passed ? "Vulkan validation run passed\n" : "Vulkan validation run FAILED\n");
+		return passed ? 0 : 1;
+	}
+#endif
+	if (cmdLine && wcsstr(cmdLine, L"-iOS")) {
+		app_is_ios_mode = true;
+		app_config_form = XR_FORM_FACTOR_HANDHELD_DISPLAY;
+		app_config_view = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO;
+		OutputDebugStringA("Running in iOS mode: XR_FORM_FACTOR_HANDHELD_DISPLAY + XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO\n");
+	} else {
+		OutputDebugStringA("Running in Immersive Mode: XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY + XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-pumpChannel")) {
+		opaque_channel_pump_mode = true;
+		OutputDebugStringA("Opaque data channel serviced from the frame loop (pump mode)\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-noThreadPolicy")) {
+		thread_policy_enabled = false;
+		OutputDebugStringA("Thread affinity and priority policy disabled\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-lateLatch")) {
+		xr_late_latch.enabled = true;
+		OutputDebugStringA("Late latching: views are re-located right before draw submission\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-pipelined")) {
+		app_pipelined = true;
+		OutputDebugStringA("Pipelined frame loop: xrWaitFrame and simulation run ahead of rendering\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-dynres")) {
+		xr_dynres.enabled = true;
+		OutputDebugStringA("Dynamic resolution: render size follows GPU and CPU frame time\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-submitDepth")) {
+		xr_submit_depth = true;
+		OutputDebugStringA("Depth submission: XR_KHR_composition_layer_depth, if the runtime supports it\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-foveate")) {
+		app_foveation.enabled = true;
+		OutputDebugStringA("Foveated rendering: full resolution around the gaze, reduced in the periphery\n");
+	}
+	dynres_init(xr_dynres, dynres_default_config());
+	if (cmdLine && wcsstr(cmdLine, L"-spectatorCamera")) {
+		window_mode = window_mode_camera;
+		OutputDebugStringA("Spectator: independent camera, rendered every few frames\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-nullRender")) {
+		app_null_render = true;
+		OutputDebugStringA("Null render backend: render commands are counted but never reach the GPU\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-recordCommands")) {
+		app_record_commands = true;
+		OutputDebugStringA("Recording render commands, one frame's stream will be logged\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-singlePass")) {
+		xr_single_pass = true;
+		OutputDebugStringA("Single pass stereo: both eyes in one array swapchain, every draw instanced per eye\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-props")) {
+		app_props = true;
+		OutputDebugStringA("Props: a floor of cubes around the hero cube, drawn as instanced buckets\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-parallelRecord")) {
+		app_parallel_record = true;
+		OutputDebugStringA("Parallel recording: each view's draws are recorded on worker threads\n");
+	}
+	if (cmdLine && wcsstr(cmdLine, L"-vulkan")) {
+#ifdef XR_SAMPLE_VULKAN
+		app_vulkan = true;
+		OutputDebugStringA("Vulkan rendering through XR_KHR_vulkan_enable2\n");
+#else
+		OutputDebugStringA("Warning: -vulkan needs a build with XR_SAMPLE_VULKAN, rendering with D3D11\n");
+#endif
+	}
+	// These draw with D3D11 outside of the render commands
+	if (app_vulkan && (xr_submit_depth || app_foveation.enabled)) {
+		OutputDebugStringA("Warning: -submitDepth and -foveate aren't supported with -vulkan, turning them off\n");
+		xr_submit_depth       = false;
+		app_foveation.enabled = false;
+	}
+	if (xr_single_pass && (app_vulkan || app_foveation.enabled)) {
+		OutputDebugStringA("Warning: -singlePass isn't supported with -vulkan or -foveate, rendering each view separately\n");
+		xr_single_pass = false;
+	}
+	// The periphery upscale draws on the immediate context
+	if (app_parallel_record && app_foveation.enabled) {
+		OutputDebugStringA("Warning: -parallelRecord isn't supported with -foveate, recording on the render thread\n");
+		app_parallel_record = false;
+	}
+	foveation_init(app_foveation, foveation_default_config());
+	cull_init(app_cull, cull_best_mode());
+	{
+		char text[64];
+		sprintf_s(text, "Culling: %s\n", cull_mode_name(app_cull.mode));
+		OutputDebugStringA(text);
+		transform_init(app_transforms, transform_best_mode());
+		sprintf_s(text, "Transforms: %s\n", transform_mode_name(app_transforms.mode));
+		OutputDebugStringA(text);
+	}
+	render_backend_t gpu_backend = { "d3d11", d3d_execute, nullptr };
+#ifdef XR_SAMPLE_VULKAN
+	if (app_vulkan) gpu_backend = vk_backend();
+#endif
+	if (app_record_commands) {
+		app_recording.forward = app_null_render ? render_null_backend() : gpu_backend;
+		render_init(app_render, render_recording_backend(app_recording));
+	} else {
+		render_init(app_render, app_null_render ? render_null_backend() : gpu_backend);
+	}
+	opaque_channel_message_handler = app_handle_channel_message;
+
+	thread_policy_init();
+	thread_policy_apply(app_pipelined ? thread_role_frame : thread_role_render);
+
+	// Before app_init, which gives the chunks their deferred contexts. Two
+	// cores are left to the frame and render threads.
+	if (app_parallel_record) {
+		uint32_t hardware = std::thread::hardware_concurrency();
+		uint32_t threads  = hardware > 2 ? hardware - 2 : 0;
+		if (threads > RENDER_WORKERS_MAX_CHUNKS - 1) threads = RENDER_WORKERS_MAX_CHUNKS - 1;
+		render_workers_start(app_workers, threads);
+	}
+
+	// Process-wide and tied to this thread's windows, so it stays on the main
+	// thread, ahead of the window, instead of in a startup task
+	SetProcessDPIAware();
+	create_window();
+
+	if (!app_startup()) {
+		// Joinable worker threads would terminate the process on exit
+		render_workers_stop(app_workers);
+		d3d_shutdown();
+#ifdef XR_SAMPLE_VULKAN
+		vk_shutdown();
+#endif
+		MessageBox(nullptr, "OpenXR initialization failed\n", "Error", 1);
+		return 1;
+	}
+
+	// Start connection process asynchronously - NON-BLOCKING. In pump mode
+	// the frame loop drives the connection instead of a thread.
+	if (xr_opaque_channel != XR_NULL_HANDLE) {
+		if (opaque_channel_pump_mode) {
+			xr_opaque_connecting = true;
+		} else {
+			xr_opaque_connection_thread = std::thread(opaque_channel_connect_async);
+		}
+	}
+
+	frame_timers_init();
+	frame_arena_init(64 * 1024);
+	if (app_pipelined) {
+		app_pipeline.start(app_render_frame, thread_role_render);
+	}
+
+	bool quit = false;
+	while (!quit) {
+		uint64_t pump_start = frame_timer_now();
+
+		// Anything signaled from here on is work this iteration may not see,
+		// and should end the next idle wait. Earlier signals are for work
+		// that is about to be picked up anyway.
+		if (opaque_channel_wakeup_event) ResetEvent(opaque_channel_wakeup_event);
+
+		bool activity = false;
+		MSG msg;
+		while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) {
+				quit = true;
+			}
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+			activity = true;
+		}
+
+		if (quit) break;
+		
+		activity |= openxr_poll_events(quit);
+		if (opaque_channel_pump_mode) {
+			activity |= opaque_channel_pump(opaque_channel_pump_budget_us);
+		}
+		activity |= app_poll_channel_events();
+		uint64_t pump_ticks = frame_timer_now() - pump_start;
+		static int frame_counter = 0;
+		static int message_number = 0;
+
+		if (xr_running) {
+			// Wait and simulate, then either hand the frame to the render
+			// thread or render it right here.
+			app_frame_t& frame = app_pipelined ? app_pipeline.back() : app_frame_state;
+			frame.pump_ticks = pump_ticks;
+			openxr_wait_frame(frame);
+			if (app_pipelined) {
+				app_pipeline.publish();
+			} else {
+				app_render_frame(frame);
+			}
+
+			if (xr_session_state != XR_SESSION_STATE_VISIBLE &&
+				xr_session_state != XR_SESSION_STATE_FOCUSED) {
+				app_idle_wait(activity);
+			}
+
+			// Only send data if connected
+			frame_counter++;
+			if (xr_opaque_connected && frame_counter >= 90) {
+				char message[128];
+				sprintf_s(message, "Message #%d: OpenXR application data", message_number);
+				opaque_channel_send_data((const uint8_t*)message, strlen(message) + 1);
+				message_number++;
+			}
+		} else {
+			// No session yet, or it has stopped. Sleep until there's a
+			// window message or channel wakeup, or the poll timer expires.
+			app_idle_wait(activity);
+		}
+	}
+
+	// Cleanup
+	app_pipeline.stop();
+	render_workers_stop(app_workers);
+	xr_opaque_connecting = false;
+	if (xr_opaque_connection_thread.joinable()) {
+		xr_opaque_connection_thread.join();
+	}
+	frame_timers_report();
+	late_latch_report(xr_late_latch);
+	dynres_report(xr_dynres);
+	foveation_report(app_foveation);
+	cull_report(app_cull);
+	scene_report(app_scene);
+	draw_list_report(app_scene.draws);
+	transform_report(app_transforms);
+	render_report(app_render);
+	render_workers_report(app_workers);
+#ifdef XR_SAMPLE_VULKAN
+	vk_report();
+#endif
+	frame_arena_report();
+	frame_arena_shutdown();
+	{
+		char text[128];
+		sprintf_s(text, "Frames: %llu rendered, %llu skipped without rendering\n", xr_frames_rendered, xr_frames_skipped);
+		OutputDebugStringA(text);
+		sprintf_s(text, "Spectator: %llu presented, %llu dropped rather than wait on the desktop\n", window_presented, window_dropped);
+		OutputDebugStringA(text);
+	}
+	opaque_channel_shutdown();
+	openxr_shutdown();
+	d3d_shutdown();
+#ifdef XR_SAMPLE_VULKAN
+	vk_shutdown();
+#endif
+	if (xr_running) thread_policy_timer_release();
+	return 0;
+}
+
+// Runs every startup step as a task graph, so independent steps overlap.
+// Shader loading needs no device and starts right away. The channel only
+// needs the instance. App resources and GPU timers only need the device, so
+// they run alongside session and swapchain creation, except that app
+// resources wait for the swapchains with -singlePass. With Vulkan, pipelines
+// are built for the swapchain format's render pass, so app resources wait for
+// the swapchains instead. The spectator swap chain belongs to the main
+// thread's window, so it is created here after the graph, not in a task.
+bool app_startup() {
+	startup_graph_t graph;
+	int32_t instance   = startup_add(graph, "xr_instance", []() { return openxr_init_instance("3D Cube"); }, true);
+	int32_t shaders    = app_vulkan ? -1 : startup_add(graph, "shader_load", app_load_shaders, true);
+	int32_t device     = startup_add(graph, app_vulkan ? "vk_device" : "d3d_device", openxr_init_device, true, instance);
+	int32_t session    = startup_add(graph, "xr_session",  openxr_init_session, true, device);
+	int32_t swapchains = startup_add(graph, "xr_swapchains", []() {
+#ifdef XR_SAMPLE_VULKAN
+		if (app_vulkan) {
+			const int64_t formats[] = { VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB };
+			int64_t       format    = vk_choose_format(xr_session, formats, (uint32_t)_countof(formats));
+			return format != 0 && openxr_init_swapchains(format);
+		}
+#endif
+		return openxr_init_swapchains(d3d_swapchain_fmt);
+	}, true, session);
+#ifdef XR_SAMPLE_VULKAN
+	if (app_vulkan) startup_add(graph, "app_resources", app_init_vk, true, swapchains);
+#endif
+	// app_init picks the stereo pipeline by xr_single_pass, which swapchain
+	// creation may still turn off. Only then does it have to wait; with
+	// single pass off from the start, nothing writes the flag.
+	if (!app_vulkan) startup_add(graph, "app_resources", app_init, true, device, shaders, xr_single_pass ? swapchains : -1);
+	startup_add(graph, "opaque_channel", []() {
+		if (!opaque_channel_init()) {
+			OutputDebugStringA("Warning: Failed to initialize opaque data channel\n");
+			return false;
+		}
+		return true;
+	}, false, instance);
+	if (app_foveation.enabled) {
+		startup_add(graph, "eye_gaze", []() {
+			if (!openxr_init_eye_gaze()) {
+				OutputDebugStringA("Warning: eye gaze unavailable, foveation follows channel hints only\n");
+				return false;
+			}
+			return true;
+		}, false, session);
+	}
+	if (xr_dynres.enabled && !app_vulkan) {
+		startup_add(graph, "gpu_timers", []() {
+			if (!d3d_gpu_timer_init()) {
+				OutputDebugStringA("Warning: GPU timestamp queries unavailable, dynamic resolution uses CPU time only\n");
+				return false;
+			}
+			return true;
+		}, false, device);
+	}
+
+	bool result = startup_run(graph, 3);
+	startup_report(graph);
+	if (result && !app_vulkan && !window_swapchain_init()) {
+		OutputDebugStringA("Warning: Failed to create window swap chain\n");
+	}
+	return result;
+}
+
+bool openxr_init_instance(const char* app_name) {
+
+	vector<const char*> use_extensions;
+	const char* ask_extensions[] = { 
+		XR_KHR_D3D11_ENABLE_EXTENSION_NAME, // Use Direct3D11 for rendering
+		XR_EXT_DEBUG_UTILS_EXTENSION_NAME,  // Debug utils for extra info
+		"XR_NVX1_opaque_data_channel",
+		XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME, // Depth for runtime reprojection
+		XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME,    // Gaze for foveated rendering
+#ifdef XR_SAMPLE_VULKAN
+		XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME,          // Vulkan rendering, with -vulkan
+#endif
+	};
+
+	uint32_t ext_count = 0;
+	xrEnumerateInstanceExtensionProperties(nullptr, 0, &ext_count, nullptr);
+	vector<XrExtensionProperties> xr_exts(ext_count, { XR_TYPE_EXTENSION_PROPERTIES });
+	xrEnumerateInstanceExtensionProperties(nullptr, ext_count, &ext_count, xr_exts.data());
+
+	OutputDebugStringA("OpenXR extensions available:\n");
+	for (size_t i = 0; i < xr_exts.size(); i++) {
+		OutputDebugStringA(xr_exts[i].extensionName);
+
+		for (int32_t ask = 0; ask < _countof(ask_extensions); ask++) {
+			if (strcmp(ask_extensions[ask], xr_exts[i].extensionName) == 0) {
+				use_extensions.push_back(ask_extensions[ask]);
+				break;
+			}
+		}
+	}
+
+	const char* graphics_extension = XR_KHR_D3D11_ENABLE_EXTENSION_NAME;
+#ifdef XR_SAMPLE_VULKAN
+	if (app_vulkan) graphics_extension = XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME;
+#endif
+	if (!std::any_of(use_extensions.begin(), use_extensions.end(),
+		[graphics_extension](const char* ext) {
+			return strcmp(ext, graphics_extension) == 0;
+		}))
+		return false;
+
+	if (xr_submit_depth && !std::any_of(use_extensions.begin(), use_extensions.end(),
+		[](const char* ext) {
+			return strcmp(ext, XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME) == 0;
+		})) {
+		OutputDebugStringA("Warning: XR_KHR_composition_layer_depth not available, depth won't be submitted\n");
+		xr_submit_depth = false;
+	}
+	xr_eye_gaze_ext = std::any_of(use_extensions.begin(), use_extensions.end(),
+		[](const char* ext) {
+			return strcmp(ext, XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME) == 0;
+		});
+
+	// Initialize OpenXR with the extensions we've found
+	XrInstanceCreateInfo createInfo = { XR_TYPE_INSTANCE_CREATE_INFO };
+	createInfo.enabledExtensionCount      = use_extensions.size();
+	createInfo.enabledExtensionNames      = use_extensions.data();
+	createInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+	strcpy_s(createInfo.applicationInfo.applicationName, app_name);
+	xrCreateInstance(&createInfo, &xr_instance);
+
+	// Check if OpenXR is available on this system. If null, an OpenXR runtime
+	// must be installed and activated.
+	if (xr_instance == nullptr)
+		return false;
+
+	xrGetInstanceProcAddr(xr_instance, "xrCreateDebugUtilsMessengerEXT", (PFN_xrVoidFunction*)(&ext_xrCreateDebugUtilsMessengerEXT));
+	xrGetInstanceProcAddr(xr_instance, "xrDestroyDebugUtilsMessengerEXT", (PFN_xrVoidFunction*)(&ext_xrDestroyDebugUtilsMessengerEXT));
+	xrGetInstanceProcAddr(xr_instance, "xrGetD3D11GraphicsRequirementsKHR", (PFN_xrVoidFunction*)(&ext_xrGetD3D11GraphicsRequirementsKHR));
+
+	// Opaque data channel APIs
+	xrGetInstanceProcAddr(xr_instance, "xrCreateOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrCreateOpaqueDataChannelNV));
+	xrGetInstanceProcAddr(xr_instance, "xrDestroyOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrDestroyOpaqueDataChannelNV));
+	xrGetInstanceProcAddr(xr_instance, "xrGetOpaqueDataChannelStateNV", (PFN_xrVoidFunction*)(&ext_xrGetOpaqueDataChannelStateNV));
+	xrGetInstanceProcAddr(xr_instance, "xrShutdownOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrShutdownOpaqueDataChannelNV));
+	xrGetInstanceProcAddr(xr_instance, "xrSendOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrSendOpaqueDataChannelNV));
+	xrGetInstanceProcAddr(xr_instance, "xrReceiveOpaqueDataChannelNV", (PFN_xrVoidFunction*)(&ext_xrReceiveOpaqueDataChannelNV));
+
+	// Debug output
+	if (ext_xrCreateOpaqueDataChannelNV) {
+		OutputDebugStringA("Successfully loaded opaque data channel functions\n");
+	}
+	else {
+		OutputDebugStringA("Failed to load opaque data channel functions\n");
+	}
+
+	// Here's some extra information about the message types and severities:
+	// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#debug-message-categorization
+	XrDebugUtilsMessengerCreateInfoEXT debug_info = { XR_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT };
+	debug_info.messageTypes =
+		XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT     |
+		XR_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT  |
+		XR_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT |
+		XR_DEBUG_UTILS_MESSAGE_TYPE_CONFORMANCE_BIT_EXT;
+	debug_info.messageSeverities =
+		XR_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+		XR_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+		XR_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+		XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	debug_info.userCallback = [](XrDebugUtilsMessageSeverityFlagsEXT severity, XrDebugUtilsMessageTypeFlagsEXT types, const XrDebugUtilsMessengerCallbackDataEXT* msg, void* user_data) {
+		printf("%s: %s\n", msg->functionName, msg->message);
+
+		char text[512];
+		sprintf_s(text, "%s: %s", msg->functionName, msg->message);
+		OutputDebugStringA(text);
+		return (XrBool32)XR_FALSE;
+	};
+
+	if (ext_xrCreateDebugUtilsMessengerEXT)
+		ext_xrCreateDebugUtilsMessengerEXT(xr_instance, &debug_info, &xr_debug);
+	
+	// Request a form factor from the device (HMD, Handheld, etc.)
+	XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
+	systemInfo.formFactor = app_config_form;
+	xrGetSystem(xr_instance, &systemInfo, &xr_system_id);
+	return true;
+}
+
+bool openxr_init_device() {
+#ifdef XR_SAMPLE_VULKAN
+	if (app_vulkan)
+		return vk_init_xr(xr_instance, xr_system_id);
+#endif
+	XrGraphicsRequirementsD3D11KHR requirement = { XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR };
+	ext_xrGetD3D11GraphicsRequirementsKHR(xr_instance, xr_system_id, &requirement);
+	return d3d_init(requirement.adapterLuid);
+}
+
+bool openxr_init_session() {
+	XrGraphicsBindingD3D11KHR binding = { XR_TYPE_GRAPHICS_BINDING_D3D11_KHR };
+	binding.device = d3d_device;
+	XrSessionCreateInfo sessionInfo = { XR_TYPE_SESSION_CREATE_INFO };
+	sessionInfo.next     = &binding;
+	sessionInfo.systemId = xr_system_id;
+#ifdef XR_SAMPLE_VULKAN
+	XrGraphicsBindingVulkan2KHR vk_binding = vk_graphics_binding();
+	if (app_vulkan) sessionInfo.next = &vk_binding;
+#endif
+	xrCreateSession(xr_instance, &sessionInfo, &xr_session);
+
+	// Unable to start a session, may not have an MR device attached or ready
+	if (xr_session == nullptr)
+		return false;
+
+	XrReferenceSpaceCreateInfo ref_space = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+	ref_space.poseInReferenceSpace = xr_pose_identity;
+	ref_space.referenceSpaceType   = XR_REFERENCE_SPACE_TYPE_LOCAL;
+	xrCreateReferenceSpace(xr_session, &ref_space, &xr_app_space);
+
+	// Per-view state throughout the frame is sized for LATE_LATCH_MAX_VIEWS
+	uint32_t view_count = 0;
+	xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, app_config_view, 0, &view_count, nullptr);
+	if (view_count == 0 || view_count > LATE_LATCH_MAX_VIEWS) {
+		char text[128];
+		sprintf_s(text, "Error: view configuration has %u views, the sample supports 1 to %u\n", view_count, LATE_LATCH_MAX_VIEWS);
+		OutputDebugStringA(text);
+		return false;
+	}
+	xr_config_views.resize(view_count, { XR_TYPE_VIEW_CONFIGURATION_VIEW });
+	xr_views.resize(view_count, { XR_TYPE_VIEW });
+	xr_late_latch.locate  = openxr_locate_views;
+	xr_late_latch.context = nullptr;
+	xrEnumerateViewConfigurationViews(xr_instance, xr_system_id, app_config_view, view_count, &view_count, xr_config_views.data());
+	return true;
+}
+
+bool openxr_init_swapchains(int64_t swapchain_format) {
+	uint32_t view_count = (uint32_t)xr_config_views.size();
+
+	// Depth swapchains must use a format the runtime lists. D32_FLOAT matches
+	// the depth pool, so rendering is the same either way.
+	const int64_t depth_format = DXGI_FORMAT_D32_FLOAT;
+	if (xr_submit_depth) {
+		uint32_t format_count = 0;
+		xrEnumerateSwapchainFormats(xr_session, 0, &format_count, nullptr);
+		vector<int64_t> formats(format_count);
+		xrEnumerateSwapchainFormats(xr_session, format_count, &format_count, formats.data());
+		if (std::find(formats.begin(), formats.end(), depth_format) == formats.end()) {
+			OutputDebugStringA("Warning: runtime has no D32_FLOAT swapchains, depth won't be submitted\n");
+			xr_submit_depth = false;
+		}
+	}
+
+	// Single pass stereo needs two views and a device that can pick the
+	// render target slice in the vertex shader
+	if (xr_single_pass && (view_count != 2 || !d3d_single_pass_supported())) {
+		OutputDebugStringA("Warning: single pass stereo unavailable on this device or view configuration, rendering each view separately\n");
+		xr_single_pass = false;
+	}
+
+	// With single pass stereo, one swapchain holds every view, a slice each,
+	// sized for the largest of them
+	uint32_t array_size = xr_single_pass ? view_count : 1;
+	for (uint32_t i = 0; i < view_count; i += array_size) {
+		XrViewConfigurationView  view           = xr_config_views[i];
+		XrSwapchainCreateInfo    swapchain_info = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
+		XrSwapchain              handle         = XR_NULL_HANDLE;
+		for (uint32_t v = i + 1; v < i + array_size; v++) {
+			view.recommendedImageRectWidth  = max(view.recommendedImageRectWidth,  xr_config_views[v].recommendedImageRectWidth);
+			view.recommendedImageRectHeight = max(view.recommendedImageRectHeight, xr_config_views[v].recommendedImageRectHeight);
+			view.maxImageRectWidth          = min(view.maxImageRectWidth,          xr_config_views[v].maxImageRectWidth);
+			view.maxImageRectHeight         = min(view.maxImageRectHeight,         xr_config_views[v].maxImageRectHeight);
+		}
+		swapchain_info.arraySize   = array_size;
+		swapchain_info.mipCount    = 1;
+		swapchain_info.faceCount   = 1;
+		swapchain_info.format      = swapchain_format;
+		swapchain_info.width       = view.recommendedImageRectWidth;
+		swapchain_info.height      = view.recommendedImageRectHeight;
+		// With dynamic resolution, allocate for the largest scale up front and
+		// render into a sub-rect, so the size can change every frame.
+		if (xr_dynres.enabled) {
+			swapchain_info.width  = min(view.maxImageRectWidth,  (uint32_t)(view.recommendedImageRectWidth  * xr_dynres.config.max_scale));
+			swapchain_info.height = min(view.maxImageRectHeight, (uint32_t)(view.recommendedImageRectHeight * xr_dynres.config.max_scale));
+		}
+		swapchain_info.sampleCount = view.recommendedSwapchainSampleCount;
+		swapchain_info.usageFlags  = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+		if (XR_FAILED(xrCreateSwapchain(xr_session, &swapchain_info, &handle)) && array_size > 1) {
+			// The runtime can't do array swapchains, so this one only holds
+			// the first view and the rest get their own, as without -singlePass
+			OutputDebugStringA("Warning: runtime can't create array swapchains, rendering each view separately\n");
+			xr_single_pass = false;
+			array_size     = 1;
+			view           = xr_config_views[i];
+			swapchain_info.arraySize = 1;
+			swapchain_info.width     = min(xr_config_views[i].maxImageRectWidth,  swapchain_info.width);
+			swapchain_info.height    = min(xr_config_views[i].maxImageRectHeight, swapchain_info.height);
+			xrCreateSwapchain(xr_session, &swapchain_info, &handle);
+		}
+
+		uint32_t surface_count = 0;
+		xrEnumerateSwapchainImages(handle, 0, &surface_count, nullptr);
+
+		swapchain_t swapchain = {};
+		swapchain.width  = swapchain_info.width;
+		swapchain.height = swapchain_info.height;
+		swapchain.recommended_width  = view.recommendedImageRectWidth;
+		swapchain.recommended_height = view.recommendedImageRectHeight;
+		swapchain.array_size = array_size;
+		swapchain.handle = handle;
+#ifdef XR_SAMPLE_VULKAN
+		if (app_vulkan) {
+			bool created = vk_create_targets(handle, swapchain.width, swapchain.height, swapchain.vk_targets);
+			xr_swapchains.push_back(swapchain);
+			if (!created)
+				return false;
+			continue;
+		}
+#endif
+		// A swapchain whose depth swapchain can't be created renders with a
+		// pooled depth buffer instead, and its views submit no depth info.
+		// Depth info is only chained where depth_handle is set.
+		if (xr_submit_depth) {
+			swapchain_info.format     = depth_format;
+			swapchain_info.usageFlags = XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+			if (XR_FAILED(xrCreateSwapchain(xr_session, &swapchain_info, &swapchain.depth_handle))) {
+				OutputDebugStringA("Warning: failed to create depth swapchain, depth won't be submitted for its views\n");
+				swapchain.depth_handle = XR_NULL_HANDLE;
+			}
+		}
+		if (swapchain.depth_handle != XR_NULL_HANDLE) {
+			uint32_t depth_count = 0;
+			xrEnumerateSwapchainImages(swapchain.depth_handle, 0, &depth_count, nullptr);
+			swapchain.depth_images.resize(depth_count, { XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR });
+			xrEnumerateSwapchainImages(swapchain.depth_handle, depth_count, &depth_count, (XrSwapchainImageBaseHeader*)swapchain.depth_images.data());
+			for (uint32_t i = 0; i < depth_count; i++) {
+				swapchain.depth_views.push_back(d3d_make_depth_view((XrBaseInStructure&)swapchain.depth_images[i]));
+			}
+		}
+
+		swapchain.surface_images.resize(surface_count, { XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR });
+		swapchain.surface_data.resize(surface_count);
+		xrEnumerateSwapchainImages(swapchain.handle, surface_count, &surface_count, (XrSwapchainImageBaseHeader*)swapchain.surface_images.data());
+		for (uint32_t i = 0; i < surface_count; i++) {
+			swapchain.surface_data[i] = d3d_make_surface_data((XrBaseInStructure&)swapchain.surface_images[i], swapchain.depth_handle == XR_NULL_HANDLE);
+		}
+
+		// Sized for the whole swapchain, dynamic resolution renders into a sub-rect
+		if (app_foveation.enabled) {
+			float scale = app_foveation.config.periphery_scale;
+			if (!d3d_make_periphery_target(
+				max(1, (int32_t)ceilf(swapchain.width  * scale)),
+				max(1, (int32_t)ceilf(swapchain.height * scale)), swapchain.periphery)) {
+				OutputDebugStringA("Warning: failed to create foveation periphery target, foveation disabled\n");
+				app_foveation.enabled = false;
+			}
+		}
+		xr_swapchains.push_back(swapchain);
+	}
+	if (!app_vulkan) d3d_memory_report();
+	return true;
+}
+
+// Eye gaze for foveation, where the runtime supports it and the user has
+// allowed it. Hints from the streaming client take precedence when present.
+bool openxr_init_eye_gaze() {
+	if (!xr_eye_gaze_ext)
+		return false;
+
+	XrSystemEyeGazeInteractionPropertiesEXT gaze_properties = { XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT };
+	XrSystemProperties                      properties      = { XR_TYPE_SYSTEM_PROPERTIES };
+	properties.next = &gaze_properties;
+	xrGetSystemProperties(xr_instance, xr_system_id, &properties);
+	if (!gaze_properties.supportsEyeGazeInteraction)
+		return false;
+
+	XrActionSetCreateInfo set_info = { XR_TYPE_ACTION_SET_CREATE_INFO };
+	strcpy_s(set_info.actionSetName,          "gaze");
+	strcpy_s(set_info.localizedActionSetName, "Gaze");
+	if (XR_FAILED(xrCreateActionSet(xr_instance, &set_info, &xr_input.actionSet)))
+		return false;
+
+	XrActionCreateInfo action_info = { XR_TYPE_ACTION_CREATE_INFO };
+	action_info.actionType = XR_ACTION_TYPE_POSE_INPUT;
+	strcpy_s(action_info.actionName,          "gaze_pose");
+	strcpy_s(action_info.localizedActionName, "Gaze Pose");
+	if (XR_FAILED(xrCreateAction(xr_input.actionSet, &action_info, &xr_input.gazeAction)))
+		return false;
+
+	XrPath profile_path, gaze_path;
+	xrStringToPath(xr_instance, "/interaction_profiles/ext/eye_gaze_interaction", &profile_path);
+	xrStringToPath(xr_instance, "/user/eyes_ext/input/gaze_ext/pose", &gaze_path);
+	XrActionSuggestedBinding             binding   = { xr_input.gazeAction, gaze_path };
+	XrInteractionProfileSuggestedBinding suggested = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
+	suggested.interactionProfile     = profile_path;
+	suggested.countSuggestedBindings = 1;
+	suggested.suggestedBindings      = &binding;
+	if (XR_FAILED(xrSuggestInteractionProfileBindings(xr_instance, &suggested)))
+		return false;
+
+	XrSessionActionSetsAttachInfo attach_info = { XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO };
+	attach_info.countActionSets = 1;
+	attach_info.actionSets      = &xr_input.actionSet;
+	if (XR_FAILED(xrAttachSessionActionSets(xr_session, &attach_info)))
+		return false;
+
+	// The frame loop only tracks gaze once this space exists
+	XrActionSpaceCreateInfo space_info = { XR_TYPE_ACTION_SPACE_CREATE_INFO };
+	space_info.action            = xr_input.gazeAction;
+	space_info.poseInActionSpace = xr_pose_identity;
+	return XR_SUCCEEDED(xrCreateActionSpace(xr_session, &space_info, &xr_input.gazeSpace));
+}
+
+void openxr_shutdown() {
+
+	for (int32_t i = 0; i < xr_swapchains.size(); i++) {
+#ifdef XR_SAMPLE_VULKAN
+		vk_destroy_targets(xr_swapchains[i].vk_targets);
+#endif
+		xrDestroySwapchain(xr_swapchains[i].handle);
+		if (xr_swapchains[i].depth_handle != XR_NULL_HANDLE) xrDestroySwapchain(xr_swapchains[i].depth_handle);
+		d3d_swapchain_destroy(xr_swapchains[i]);
+	}
+	xr_swapchains.clear();
+
+	if (xr_input.actionSet != XR_NULL_HANDLE) {
+		if (xr_input.handSpace[0] != XR_NULL_HANDLE) xrDestroySpace(xr_input.handSpace[0]);
+		if (xr_input.handSpace[1] != XR_NULL_HANDLE) xrDestroySpace(xr_input.handSpace[1]);
+		if (xr_input.gazeSpace    != XR_NULL_HANDLE) xrDestroySpace(xr_input.gazeSpace);
+		xrDestroyActionSet(xr_input.actionSet);
+	}
+	if (xr_app_space != XR_NULL_HANDLE) xrDestroySpace   (xr_app_space);
+	if (xr_session   != XR_NULL_HANDLE) xrDestroySession (xr_session);
+	if (xr_debug     != XR_NULL_HANDLE) ext_xrDestroyDebugUtilsMessengerEXT(xr_debug);
+	if (xr_instance  != XR_NULL_HANDLE) xrDestroyInstance(xr_instance);
+}
+
+bool openxr_poll_events(bool& exit) {
+	exit = false;
+
+	bool              received     = false;
+	XrEventDataBuffer event_buffer = { XR_TYPE_EVENT_DATA_BUFFER };
+
+	while (xrPollEvent(xr_instance, &event_buffer) == XR_SUCCESS) {
+		received = true;
+		switch (event_buffer.type) {
+		case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: {
+			XrEventDataSessionStateChanged* changed = (XrEventDataSessionStateChanged*)&event_buffer;
+			xr_session_state = changed->state;
+
+			// Session state change is where we can begin and end sessions, as well as find quit messages
+			switch (xr_session_state) {
+			case XR_SESSION_STATE_READY: {
+				XrSessionBeginInfo begin_info = { XR_TYPE_SESSION_BEGIN_INFO };
+				begin_info.primaryViewConfigurationType = app_config_view;
+				xrBeginSession(xr_session, &begin_info);
+				xr_running = true;
+				thread_policy_timer_acquire();
+			} break;
+			case XR_SESSION_STATE_STOPPING: {
+				xr_running = false;
+				thread_policy_timer_release();
+				app_pipeline.flush();
+				xrEndSession(xr_session);
+			} break;
+			case XR_SESSION_STATE_EXITING: exit = true; break;
+			case XR_SESSION_STATE_LOSS_PENDING: exit = true; break;
+			}
+		} break;
+		case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING: exit = true; return true;
+		}
+		event_buffer = { XR_TYPE_EVENT_DATA_BUFFER };
+	}
+	return received;
+}
+
+void openxr_wait_frame(app_frame_t& frame) {
+	static uint64_t frame_index = 0;
+
+	uint64_t wait_start = frame_timer_now();
+	frame.state = { XR_TYPE_FRAME_STATE };
+	xrWaitFrame(xr_session, nullptr, &frame.state);
+	frame.wait_ticks = frame_timer_now() - wait_start;
+	frame.index      = frame_index++;
+	frame.visible    = xr_session_state == XR_SESSION_STATE_VISIBLE || xr_session_state == XR_SESSION_STATE_FOCUSED;
+
+	// Gaze is only reported while focused; xrSyncActions fails otherwise and
+	// the gaze stays invalid.
+	frame.gaze_valid = false;
+	if (xr_input.gazeSpace != XR_NULL_HANDLE && frame.visible) {
+		XrActiveActionSet active_set = { xr_input.actionSet, XR_NULL_PATH };
+		XrActionsSyncInfo sync_info  = { XR_TYPE_ACTIONS_SYNC_INFO };
+		sync_info.countActiveActionSets = 1;
+		sync_info.activeActionSets      = &active_set;
+		XrSpaceLocation location = { XR_TYPE_SPACE_LOCATION };
+		if (XR_SUCCEEDED(xrSyncActions(xr_session, &sync_info)) &&
+			XR_SUCCEEDED(xrLocateSpace(xr_input.gazeSpace, xr_app_space, frame.state.predictedDisplayTime, &location))) {
+			const XrSpaceLocationFlags tracked = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+			frame.gaze_valid = (location.locationFlags & tracked) == tracked;
+			frame.gaze       = location.pose;
+		}
+	}
+
+	app_update(frame);
+}
+
+// Returns true if anything was rendered this frame
+bool openxr_render_frame(app_frame_t& frame) {
+
+	XrFrameState& frame_state = frame.state;
+	{
+		frame_timer_scope_t timer(frame_phase_begin_frame);
+		xrBeginFrame(xr_session, nullptr);
+	}
+	frame_arena_begin_frame();
+
+	XrCompositionLayerBaseHeader* layer = nullptr;
+	XrCompositionLayerProjection layer_proj = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+	frame_vector<XrCompositionLayerProjectionView> views;
+	// When the runtime says not to render, skip swapchain acquisition and all
+	// GPU work, but still end the frame to keep the frame loop on schedule.
+	bool should_render = frame.visible && frame_state.shouldRender;
+	std::chrono::steady_clock::time_point render_start;
+	if (should_render && openxr_render_layer(frame_state.predictedDisplayTime, views, layer_proj, render_start)) {
+		layer = (XrCompositionLayerBaseHeader*)&layer_proj;
+	}
+	if (layer != nullptr) xr_frames_rendered++;
+	else                  xr_frames_skipped++;
+
+	// Feed this frame's CPU time and the most recent GPU time to the
+	// resolution controller. GPU results lag a few frames behind. CPU time
+	// starts once every image is acquired and the poses are latched, so
+	// waiting on the compositor isn't taken for render cost.
+	if (xr_dynres.enabled && layer != nullptr) {
+		float cpu_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - render_start).count();
+		dynres_update(xr_dynres, d3d_gpu_timer_read(), cpu_ms, frame_state.predictedDisplayPeriod / 1000000.0f);
+	}
+
+	XrFrameEndInfo end_info{ XR_TYPE_FRAME_END_INFO };
+	end_info.displayTime          = frame_state.predictedDisplayTime;
+	end_info.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+	end_info.layerCount           = layer == nullptr ? 0 : 1;
+	end_info.layers               = &layer;
+	frame_timer_scope_t timer(frame_phase_end_frame);
+	xrEndFrame(xr_session, &end_info);
+	return layer != nullptr;
+}
+
+bool openxr_locate_views(void* context, XrTime display_time, XrView* views, uint32_t view_count) {
+	uint32_t         located     = 0;
+	XrViewState      view_state  = { XR_TYPE_VIEW_STATE };
+	XrViewLocateInfo locate_info = { XR_TYPE_VIEW_LOCATE_INFO };
+	locate_info.viewConfigurationType = app_config_view;
+	locate_info.displayTime           = display_time;
+	locate_info.space                 = xr_app_space;
+	if (XR_FAILED(xrLocateViews(xr_session, &locate_info, &view_state, view_count, &located, views)))
+		return false;
+
+	const XrViewStateFlags valid = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT;
+	return located == view_count && (view_state.viewStateFlags & valid) == valid;
+}
+
+// render_start is set to when the swapchain waits and pose locates are done
+// and the CPU's own render work begins
+bool openxr_render_layer(XrTime predictedTime, frame_vector<XrCompositionLayerProjectionView>& views, XrCompositionLayerProjection& layer, std::chrono::steady_clock::time_point& render_start) {
+
+	// Find the state and location of each viewpoint at the predicted time.
+	// If the runtime flags the poses as invalid we still render with them,
+	// same as before late latching existed.
+	uint32_t view_count = (uint32_t)xr_views.size();
+	{
+		frame_timer_scope_t timer(frame_phase_locate_views);
+		late_latch_early(xr_late_latch, predictedTime, xr_views.data(), view_count);
+	}
+	views.resize(view_count);
+
+	// Acquire every image first. xrWaitSwapchainImage is where the frame can
+	// stall, so it has to happen before the late latch, not after.
+	// With single pass stereo there is one swapchain for all the views.
+	uint32_t img_ids  [LATE_LATCH_MAX_VIEWS] = {};
+	uint32_t depth_ids[LATE_LATCH_MAX_VIEWS] = {};
+	for (uint32_t i = 0; i < (uint32_t)xr_swapchains.size(); i++) {
+
+		uint64_t acquire_start = frame_timer_now();
+		XrSwapchainImageAcquireInfo acquire_info = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
+		xrAcquireSwapchainImage(xr_swapchains[i].handle, &acquire_info, &img_ids[i]);
+
+		XrSwapchainImageWaitInfo wait_info = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
+		wait_info.timeout = XR_INFINITE_DURATION;
+		xrWaitSwapchainImage(xr_swapchains[i].handle, &wait_info);
+
+		if (xr_swapchains[i].depth_handle != XR_NULL_HANDLE) {
+			xrAcquireSwapchainImage(xr_swapchains[i].depth_handle, &acquire_info, &depth_ids[i]);
+			xrWaitSwapchainImage   (xr_swapchains[i].depth_handle, &wait_info);
+		}
+		frame_timers_add(frame_phase_swapchain, frame_timer_now() - acquire_start);
+	}
+
+	// Depth info has to outlive this function, until xrEndFrame
+	XrCompositionLayerDepthInfoKHR* depth_infos = xr_submit_depth
+		? (XrCompositionLayerDepthInfoKHR*)frame_arena_alloc(sizeof(XrCompositionLayerDepthInfoKHR) * view_count, alignof(XrCompositionLayerDepthInfoKHR))
+		: nullptr;
+
+	// Re-locate at the last moment. The latched pose is used both for the
+	// view constants and for what we submit in the projection views. This is
+	// once for all views rather than before each view's draws: culling, gaze
+	// and single pass or parallel recording need every view's pose before
+	// the first draw, and xrLocateViews locates all views together anyway.
+	if (xr_late_latch.enabled) {
+		frame_timer_scope_t timer(frame_phase_locate_views);
+		late_latch_latch(xr_late_latch, xr_views.data());
+	}
+	render_start = std::chrono::steady_clock::now();
+
+	// Gaze and foveation work in app_time_s, where roughly now plus one
+	// display period is when this frame reaches the display. Eye gaze was
+	// located for that time already; channel hints are predicted up to it.
+	double display_s = app_time_s() + app_frame_state.state.predictedDisplayPeriod / 1.0e9;
+	if (app_foveation.enabled && app_frame_state.gaze_valid) {
+		for (uint32_t i = 0; i < view_count && i < FOVEATION_MAX_EYES; i++) {
+			float tangent_x, tangent_y;
+			if (foveation_pose_to_tangent(xr_views[i].pose, app_frame_state.gaze, tangent_x, tangent_y))
+				foveation_add_sample(app_foveation, foveation_source_eye_gaze, i, tangent_x, tangent_y, display_s);
+		}
+	}
+
+#ifdef XR_SAMPLE_VULKAN
+	if (app_vulkan) vk_begin_frame();
+#endif
+	// After the late latch, so the frustum matches the poses rendered with,
+	// and after vk_begin_frame, so Vulkan takes the instance upload
+	app_prepare_scene(xr_views.data(), view_count);
+
+	if (xr_dynres.enabled && !app_vulkan) d3d_gpu_timer_begin();
+
+	for (uint32_t i = 0; i < view_count; i++) {
+		uint32_t chain  = xr_single_pass ? 0 : i; // Swapchain, and slice of it, this view renders into
+		uint32_t slice  = xr_single_pass ? i : 0;
+		uint32_t img_id = img_ids[chain];
+
+		// Set up rendering information for the current viewpoint
+		views[i] = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+		views[i].pose = xr_views[i].pose;
+		views[i].fov  = xr_views[i].fov;
+		views[i].subImage.swapchain        = xr_swapchains[chain].handle;
+		views[i].subImage.imageRect.offset = { 0, 0 };
+		views[i].subImage.imageRect.extent = { xr_swapchains[chain].width, xr_swapchains[chain].height };
+		views[i].subImage.imageArrayIndex  = slice;
+		if (xr_dynres.enabled) {
+			XrExtent2Di& extent = views[i].subImage.imageRect.extent;
+			dynres_extent(xr_dynres, xr_swapchains[chain].recommended_width, xr_swapchains[chain].recommended_height,
+				xr_swapchains[chain].width, xr_swapchains[chain].height, extent.width, extent.height);
+		}
+
+#ifdef XR_SAMPLE_VULKAN
+		// Vulkan images are released together, once the frame is submitted
+		if (app_vulkan) {
+			frame_timer_scope_t timer(frame_phase_render_layer);
+			render_handle_t     target = xr_swapchains[chain].vk_targets[img_id];
+			if (app_parallel_record) app_record_views[i] = { &views[i], target, target };
+			else                     app_render_layer(views[i], target, target);
+			continue;
+		}
+#endif
+		swapchain_surfdata_t surface = xr_swapchains[chain].surface_data[img_id];
+		if (xr_swapchains[chain].depth_handle != XR_NULL_HANDLE) {
+			surface.depth_view = xr_swapchains[chain].depth_views[depth_ids[chain]];
+
+			// Same sub-rect as color, and the clip planes the projection used
+			XrCompositionLayerDepthInfoKHR& depth_info = depth_infos[i];
+			depth_info = { XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR };
+			depth_info.subImage.swapchain       = xr_swapchains[chain].depth_handle;
+			depth_info.subImage.imageRect       = views[i].subImage.imageRect;
+			depth_info.subImage.imageArrayIndex = slice;
+			depth_info.minDepth = 0.0f;
+			depth_info.maxDepth = 1.0f;
+			depth_info.nearZ    = app_clip_near;
+			depth_info.farZ     = app_clip_far;
+			views[i].next = &depth_info;
+		}
+		// Rendered together after the loop
+		if (xr_single_pass)
+			continue;
+		if (app_parallel_record) {
+			app_record_views[i] = { &views[i], surface.target_view, surface.depth_view };
+			continue;
+		}
+
+		foveation_map_t fovea_map = {};
+		if (app_foveation.enabled && xr_swapchains[chain].periphery.color != nullptr)
+			foveation_make_map(app_foveation, i, display_s, views[i].fov, views[i].subImage.imageRect, fovea_map);
+
+		{
+			frame_timer_scope_t timer(frame_phase_render_layer);
+			if (fovea_map.foveated) d3d_render_layer_foveated(views[i], surface, xr_swapchains[chain].periphery, fovea_map);
+			else                    app_render_layer         (views[i], surface.target_view, surface.depth_view);
+		}
+
+		// The image belongs to the runtime once released, so the spectator
+		// copy has to happen now
+		if (i == 0 && window_mode == window_mode_mirror)
+			window_mirror_copy(xr_swapchains[chain].surface_images[img_id].texture, views[i].subImage.imageRect);
+		openxr_release_images(xr_swapchains[chain]);
+	}
+
+	// Every view at once, spread over the worker threads. D3D11 images go
+	// back to the runtime once the command lists are on the immediate
+	// context, Vulkan's once the frame is submitted, below.
+	if (app_parallel_record && !xr_single_pass) {
+		{
+			frame_timer_scope_t timer(frame_phase_render_layer);
+			app_record_layers(view_count, false);
+		}
+		if (!app_vulkan) {
+			if (window_mode == window_mode_mirror)
+				window_mirror_copy(xr_swapchains[0].surface_images[img_ids[0]].texture, views[0].subImage.imageRect);
+			for (uint32_t i = 0; i < view_count; i++)
+				openxr_release_images(xr_swapchains[i]);
+		}
+	}
+
+	// Both eyes in one pass, each into its own slice of the one swapchain
+	if (xr_single_pass) {
+		swapchain_t&         swapchain = xr_swapchains[0];
+		swapchain_surfdata_t surface   = swapchain.surface_data[img_ids[0]];
+		if (swapchain.depth_handle != XR_NULL_HANDLE)
+			surface.depth_view = swapchain.depth_views[depth_ids[0]];
+		{
+			frame_timer_scope_t timer(frame_phase_render_layer);
+			if (app_parallel_record) {
+				app_record_views[0] = { views.data(), surface.target_view, surface.depth_view };
+				app_record_layers(1, true);
+			} else {
+				app_render_layer_stereo(views.data(), surface.target_view, surface.depth_view);
+			}
+		}
+		if (window_mode == window_mode_mirror)
+			window_mirror_copy(swapchain.surface_images[img_ids[0]].texture, views[0].subImage.imageRect);
+		openxr_release_images(swapchain);
+	}
+#ifdef XR_SAMPLE_VULKAN
+	// The runtime may read an image as soon as it is released, so the work
+	// rendering it has to be on the queue by then
+	if (app_vulkan) {
+		{
+			frame_timer_scope_t timer(frame_phase_render_layer);
+			vk_end_frame();
+		}
+		frame_timer_scope_t         timer(frame_phase_swapchain);
+		XrSwapchainImageReleaseInfo release_info = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
+		for (uint32_t i = 0; i < (uint32_t)xr_swapchains.size(); i++)
+			xrReleaseSwapchainImage(xr_swapchains[i].handle, &release_info);
+	}
+#endif
+	if (xr_dynres.enabled && !app_vulkan) d3d_gpu_timer_end();
+
+	layer.space     = xr_app_space;
+	layer.viewCount = (uint32_t)views.size();
+	layer.views     = views.data();
+	return true;
+}
+
+// Hands a swapchain's acquired color image, and depth image if it has one,
+// back to the runtime
+void openxr_release_images(const swapchain_t& swapchain) {
+	frame_timer_scope_t         timer(frame_phase_swapchain);
+	XrSwapchainImageReleaseInfo release_info = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
+	xrReleaseSwapchainImage(swapchain.handle, &release_info);
+	if (swapchain.depth_handle != XR_NULL_HANDLE)
+		xrReleaseSwapchainImage(swapchain.depth_handle, &release_info);
+}
+
+bool d3d_init(LUID& adapter_luid) {
+	IDXGIAdapter1* adapter = d3d_get_adapter(adapter_luid);
+	D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0 };
+
+	if (adapter == nullptr)
+		return false;
+	if (FAILED(D3D11CreateDevice(adapter, D3D_DRIVER_TYPE_UNKNOWN, 0, 0, featureLevels, _countof(featureLevels), D3D11_SDK_VERSION, &d3d_device, nullptr, &d3d_context)))
+		return false;
+
+	adapter->Release();
+	return true;
+}
+
+bool window_swapchain_init() {
+	if (!g_debug_window || !d3d_device) {
+		return false;
+	}
+
+	// Get window dimensions
+	RECT rect;
+	GetClientRect(g_debug_window, &rect);
+	UINT width = rect.right - rect.left;
+	UINT height = rect.bottom - rect.top;
+
+	// Create DXGI factory
+	IDXGIFactory1* factory = nullptr;
+	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&factory))) {
+		return false;
+	}
+
+	// Create swap chain descriptor
+	DXGI_SWAP_CHAIN_DESC swap_desc = {};
+	swap_desc.BufferCount = 2;
+	swap_desc.BufferDesc.Width = width;
+	swap_desc.BufferDesc.Height = height;
+	swap_desc.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	swap_desc.BufferDesc.RefreshRate.Numerator = 60;
+	swap_desc.BufferDesc.RefreshRate.Denominator = 1;
+	swap_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	swap_desc.OutputWindow = g_debug_window;
+	swap_desc.SampleDesc.Count = 1;
+	swap_desc.Windowed = TRUE;
+	swap_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+	swap_desc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+	// Create swap chain
+	if (FAILED(factory->CreateSwapChain(d3d_device, &swap_desc, &window_swapchain))) {
+		factory->Release();
+		return false;
+	}
+
+	factory->Release();
+
+	// ResizeBuffers has to be passed the flags the swap chain was created
+	// with, whether or not the waitable object can be used below
+	window_swapchain_flags = swap_desc.Flags;
+
+	// One frame in flight is plenty for a spectator. Without the waitable
+	// object, presents still use DXGI_PRESENT_DO_NOT_WAIT.
+	IDXGISwapChain2* swapchain2 = nullptr;
+	if (SUCCEEDED(window_swapchain->QueryInterface(__uuidof(IDXGISwapChain2), (void**)&swapchain2))) {
+		swapchain2->SetMaximumFrameLatency(1);
+		window_frame_latency = swapchain2->GetFrameLatencyWaitableObject();
+		swapchain2->Release();
+	}
+
+	// Get back buffer and create render target view
+	ID3D11Texture2D* back_buffer = nullptr;
+	if (FAILED(window_swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&back_buffer))) {
+		return false;
+	}
+
+	HRESULT hr = d3d_device->CreateRenderTargetView(back_buffer, nullptr, &window_rtv);
+	back_buffer->Release();
+
+	if (FAILED(hr)) {
+		return false;
+	}
+
+	// Store dimensions
+	window_width = width;
+	window_height = height;
+
+	return true;
+}
+
+void window_handle_resize() {
+	if (!window_swapchain || !g_debug_window) {
+		return;
+	}
+
+	// Get new window dimensions
+	RECT rect;
+	GetClientRect(g_debug_window, &rect);
+	UINT new_width = rect.right - rect.left;
+	UINT new_height = rect.bottom - rect.top;
+
+	// Only resize if dimensions actually changed
+	if (new_width == window_width && new_height == window_height) {
+		return;
+	}
+
+	if (new_width == 0 || new_height == 0) {
+		return;
+	}
+
+	// Release old render target view
+	if (window_rtv) {
+		window_rtv->Release();
+		window_rtv = nullptr;
+	}
+
+	// Resize swap chain buffers
+	HRESULT hr = window_swapchain->ResizeBuffers(0, new_width, new_height, DXGI_FORMAT_UNKNOWN, window_swapchain_flags);
+	if (FAILED(hr)) {
+		OutputDebugStringA("Failed to resize swap chain buffers\n");
+		return;
+	}
+
+	// Get new back buffer and create render target view
+	ID3D11Texture2D* back_buffer = nullptr;
+	if (FAILED(window_swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&back_buffer))) {
+		return;
+	}
+
+	hr = d3d_device->CreateRenderTargetView(back_buffer, nullptr, &window_rtv);
+	back_buffer->Release();
+
+	if (SUCCEEDED(hr)) {
+		window_width = new_width;
+		window_height = new_height;
+	}
+}
+
+void window_present_vr_view() {
+	if (!window_swapchain || !window_rtv || xr_swapchains.empty()) {
+		return;
+	}
+	if (window_mode == window_mode_mirror && window_mirror == nullptr) {
+		return;
+	}
+	if (window_mode == window_mode_camera && window_frames++ % window_camera_interval != 0) {
+		return;
+	}
+	if (!window_frame_ready()) {
+		window_dropped++;
+		return;
+	}
+
+	// Handle window resize
+	window_handle_resize();
+
+	if (!window_rtv) return; // May have failed during resize
+
+	// Get window dimensions
+	RECT rect;
+	GetClientRect(g_debug_window, &rect);
+	UINT width = rect.right - rect.left;
+	UINT height = rect.bottom - rect.top;
+
+	if (width == 0 || height == 0) return;
+
+	// Calculate aspect ratio
+	float aspect = (float)width / (float)height;
+
+	// Set viewport for window
+	render_set_viewport(app_render, { 0.0f, 0.0f, (float)width, (float)height });
+
+	if (window_mode == window_mode_mirror) {
+		if (window_draw_mirror(width, height))
+			window_present();
+		return;
+	}
+
+	float clear_color[] = { 0.098f, 0.137f, 0.294f, 1.0f };
+	render_clear(app_render, window_rtv, nullptr, clear_color);
+	render_set_targets(app_render, window_rtv, nullptr);
+
+	XrCompositionLayerProjectionView placeholder_view = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+
+	float fov_vertical = 0.4f;
+	float fov_horizontal = 2.0f * atanf(tanf(fov_vertical / 2.0f) * aspect);
+
+	placeholder_view.fov.angleLeft = -fov_horizontal / 2.0f;
+	placeholder_view.fov.angleRight = fov_horizontal / 2.0f;
+	placeholder_view.fov.angleUp = fov_vertical / 2.0f;
+	placeholder_view.fov.angleDown = -fov_vertical / 2.0f;
+
+	placeholder_view.pose.orientation = { 0, 0, 0, 1 };
+	placeholder_view.pose.position = { 0, -0.6f, 4.0f };
+
+	// The headset's visible list doesn't apply to this camera
+	XrView spectator_view = { XR_TYPE_VIEW };
+	spectator_view.pose = placeholder_view.pose;
+	spectator_view.fov  = placeholder_view.fov;
+	app_prepare_scene(&spectator_view, 1);
+
+	app_draw(placeholder_view);
+
+	// Present to window
+	window_present();
+}
+
+// Returns false while the desktop still has a spectator frame queued. A
+// signal taken here stays valid until a Present uses it, so frames that are
+// skipped for other reasons don't lose it.
+bool window_frame_ready() {
+	if (window_frame_latency == nullptr)
+		return true;
+	if (!window_frame_slot)
+		window_frame_slot = WaitForSingleObjectEx(window_frame_latency, 0, FALSE) == WAIT_OBJECT_0;
+	return window_frame_slot;
+}
+
+void window_present() {
+	HRESULT hr = window_swapchain->Present(1, DXGI_PRESENT_DO_NOT_WAIT);
+	if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+		window_dropped++;
+		return;
+	}
+	window_frame_slot = false;
+	window_presented++;
+}
+
+void window_mirror_copy(ID3D11Texture2D* source, const XrRect2Di& rect) {
+	if (!window_swapchain)
+		return;
+
+	// Sized for the whole swapchain image, so dynamic resolution never
+	// needs a new one
+	D3D11_TEXTURE2D_DESC source_desc;
+	source->GetDesc(&source_desc);
+	if (window_mirror == nullptr || window_mirror_size.width != (int32_t)source_desc.Width || window_mirror_size.height != (int32_t)source_desc.Height) {
+		if (window_mirror_resource) { window_mirror_resource->Release(); window_mirror_resource = nullptr; }
+		if (window_mirror)          { window_mirror         ->Release(); window_mirror          = nullptr; }
+
+		// Full chain, though only the levels the blit reaches get generated
+		D3D11_TEXTURE2D_DESC mirror_desc = {};
+		mirror_desc.SampleDesc.Count = 1;
+		mirror_desc.MipLevels        = 0;
+		mirror_desc.Width            = source_desc.Width;
+		mirror_desc.Height           = source_desc.Height;
+		mirror_desc.ArraySize        = 1;
+		mirror_desc.Format           = DXGI_FORMAT_B8G8R8A8_TYPELESS;
+		mirror_desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+		mirror_desc.MiscFlags        = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		if (FAILED(d3d_device->CreateTexture2D(&mirror_desc, nullptr, &window_mirror)))
+			return;
+		window_mirror->GetDesc(&mirror_desc);
+		window_mirror_mips   = mirror_desc.MipLevels;
+		window_mirror_levels = 0;
+		window_mirror_size   = { (int32_t)source_desc.Width, (int32_t)source_desc.Height };
+	}
+
+	// Mips are left to window_draw_mirror, which only runs on frames that
+	// actually present the mirror
+	D3D11_BOX box = { (UINT)rect.offset.x, (UINT)rect.offset.y, 0,
+		(UINT)(rect.offset.x + rect.extent.width), (UINT)(rect.offset.y + rect.extent.height), 1 };
+	d3d_context->CopySubresourceRegion(window_mirror, 0, 0, 0, 0, source, 0, &box);
+	window_mirror_extent = rect.extent;
+}
+
+// Draws the mirrored eye over the whole window, cropped to the window's
+// aspect ratio rather than stretched
+bool window_draw_mirror(UINT width, UINT height) {
+	float source_width  = (float)window_mirror_extent.width;
+	float source_height = (float)window_mirror_extent.height;
+	float aspect        = (float)width / (float)height;
+	float crop_width    = min(source_width,  source_height * aspect);
+	float crop_height   = min(source_height, source_width  / aspect);
+
+	// Trilinear filtering, minifying by ratio, reads levels floor(log2(ratio))
+	// and the one below. The view is limited to those, so GenerateMips only
+	// fills what is sampled.
+	float    ratio  = max(crop_width / width, crop_height / height);
+	uint32_t levels = 1;
+	while (levels < window_mirror_mips && (float)(1u << (levels - 1)) < ratio)
+		levels++;
+	if (levels != window_mirror_levels) {
+		if (window_mirror_resource) { window_mirror_resource->Release(); window_mirror_resource = nullptr; }
+		D3D11_SHADER_RESOURCE_VIEW_DESC resource_desc = {};
+		resource_desc.ViewDimension       = D3D11_SRV_DIMENSION_TEXTURE2D;
+		resource_desc.Format              = DXGI_FORMAT_B8G8R8A8_UNORM;
+		resource_desc.Texture2D.MipLevels = levels;
+		window_mirror_levels = 0;
+		if (FAILED(d3d_device->CreateShaderResourceView(window_mirror, &resource_desc, &window_mirror_resource)))
+			return false;
+		window_mirror_levels = levels;
+	}
+	if (levels > 1)
+		d3d_context->GenerateMips(window_mirror_resource);
+
+	app_blit_buffer_t blit_buffer = {};
+	blit_buffer.dest_rect    = { 0.0f, 0.0f, (float)width, (float)height };
+	blit_buffer.source_scale = {
+		crop_width  / window_mirror_size.width,
+		crop_height / window_mirror_size.height,
+		(source_width  - crop_width)  * 0.5f / window_mirror_size.width,
+		(source_height - crop_height) * 0.5f / window_mirror_size.height };
+	render_update_constants(app_render, app_blit_buffer, &blit_buffer, sizeof(blit_buffer));
+
+	render_handle_t mirror = window_mirror_resource;
+	render_set_targets  (app_render, window_rtv, nullptr);
+	render_set_pipeline (app_render, &app_mirror_pipeline);
+	render_set_constants(app_render, render_stage_pixel, 2, app_blit_buffer);
+	render_set_textures (app_render, 0, 1, &mirror);
+	render_draw(app_render, 3);
+
+	// Unbind, so the next copy and GenerateMips don't find it still bound
+	render_handle_t no_texture = nullptr;
+	render_set_textures(app_render, 0, 1, &no_texture);
+	return true;
+}
+
+IDXGIAdapter1* d3d_get_adapter(LUID& adapter_luid) {
+	// Turn the LUID into a specific graphics device adapter
+	IDXGIAdapter1*     final_adapter = nullptr;
+	IDXGIAdapter1*     curr_adapter  = nullptr;
+	IDXGIFactory1*     dxgi_factory;
+	DXGI_ADAPTER_DESC1 adapter_desc;
+
+	CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)(&dxgi_factory));
+
+	int curr = 0;
+	while (dxgi_factory->EnumAdapters1(curr++, &curr_adapter) == S_OK) {
+		curr_adapter->GetDesc1(&adapter_desc);
+
+		if (memcmp(&adapter_desc.AdapterLuid, &adapter_luid, sizeof(&adapter_luid)) == 0) {
+			final_adapter = curr_adapter;
+			break;
+		}
+		curr_adapter->Release();
+		curr_adapter = nullptr;
+	}
+	dxgi_factory->Release();
+	return final_adapter;
+}
+
+void d3d_shutdown() {
+	d3d_gpu_timer_destroy();
+	if (window_mirror_resource) { window_mirror_resource->Release(); window_mirror_resource = nullptr; }
+	if (window_mirror) { window_mirror->Release(); window_mirror = nullptr; }
+	if (window_frame_latency) { CloseHandle(window_frame_latency); window_frame_latency = nullptr; }
+	if (window_rtv) { window_rtv->Release(); window_rtv = nullptr; }
+	if (window_swapchain) { window_swapchain->Release(); window_swapchain = nullptr; }
+	for (uint32_t c = 0; c < RENDER_WORKERS_MAX_CHUNKS; c++) {
+		if (d3d_deferred[c]) { d3d_deferred[c]->Release(); d3d_deferred[c] = nullptr; }
+	}
+	if (d3d_context) { d3d_context->Release(); d3d_context = nullptr; }
+	if (d3d_device) { d3d_device->Release(); d3d_device = nullptr; }
+}
+
+swapchain_surfdata_t d3d_make_surface_data(XrBaseInStructure& swapchain_img, bool shared_depth) {
+	swapchain_surfdata_t result = {};
+
+	// Get information about the swapchain image created by OpenXR
+	XrSwapchainImageD3D11KHR& d3d_swapchain_img = (XrSwapchainImageD3D11KHR&)swapchain_img;
+	D3D11_TEXTURE2D_DESC      color_desc;
+	d3d_swapchain_img.texture->GetDesc(&color_desc);
+
+	// Create a view resource for the swapchain image target that we can use to set up rendering.
+	// Array images (single pass stereo) get a view of every slice.
+	D3D11_RENDER_TARGET_VIEW_DESC target_desc = {};
+	target_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+	target_desc.Format        = (DXGI_FORMAT)d3d_swapchain_fmt;
+	if (color_desc.ArraySize > 1) {
+		target_desc.ViewDimension            = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+		target_desc.Texture2DArray.ArraySize = color_desc.ArraySize;
+	}
+	d3d_device->CreateRenderTargetView(d3d_swapchain_img.texture, &target_desc, &result.target_view);
+
+	// Share a depth buffer with every other image of the same size, unless
+	// depth comes from a depth swapchain instead
+	if (shared_depth)
+		result.depth_view = d3d_depth_acquire(color_desc.Width, color_desc.Height, color_desc.ArraySize);
+
+	return result;
+}
+
+ID3D11DepthStencilView* d3d_make_depth_view(XrBaseInStructure& swapchain_img) {
+	XrSwapchainImageD3D11KHR& d3d_swapchain_img = (XrSwapchainImageD3D11KHR&)swapchain_img;
+	D3D11_TEXTURE2D_DESC      depth_desc;
+	d3d_swapchain_img.texture->GetDesc(&depth_desc);
+
+	D3D11_DEPTH_STENCIL_VIEW_DESC stencil_desc = {};
+	stencil_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+	stencil_desc.Format        = DXGI_FORMAT_D32_FLOAT;
+	if (depth_desc.ArraySize > 1) {
+		stencil_desc.ViewDimension            = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		stencil_desc.Texture2DArray.ArraySize = depth_desc.ArraySize;
+	}
+	ID3D11DepthStencilView* view = nullptr;
+	d3d_device->CreateDepthStencilView(d3d_swapchain_img.texture, &stencil_desc, &view);
+	return view;
+}
+
+ID3D11DepthStencilView* d3d_depth_acquire(int32_t width, int32_t height, int32_t array_size) {
+	for (size_t i = 0; i < d3d_depth_pool.size(); i++) {
+		if (d3d_depth_pool[i].width == width && d3d_depth_pool[i].height == height && d3d_depth_pool[i].array_size == array_size) {
+			d3d_depth_pool[i].users++;
+			return d3d_depth_pool[i].view;
+		}
+	}
+
+	d3d_depth_target_t target = {};
+	target.width  = width;
+	target.height     = height;
+	target.array_size = array_size;
+	target.users      = 1;
+
+	D3D11_TEXTURE2D_DESC depth_desc = {};
+	depth_desc.SampleDesc.Count = 1;
+	depth_desc.MipLevels        = 1;
+	depth_desc.Width            = width;
+	depth_desc.Height           = height;
+	depth_desc.ArraySize        = array_size;
+	depth_desc.Format           = DXGI_FORMAT_R32_TYPELESS;
+	depth_desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_DEPTH_STENCIL;
+	d3d_device->CreateTexture2D(&depth_desc, nullptr, &target.texture);
+
+	// Create a view resource for the depth buffer for rendering setup
+	D3D11_DEPTH_STENCIL_VIEW_DESC stencil_desc = {};
+	stencil_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+	stencil_desc.Format        = DXGI_FORMAT_D32_FLOAT;
+	if (array_size > 1) {
+		stencil_desc.ViewDimension            = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		stencil_desc.Texture2DArray.ArraySize = array_size;
+	}
+	d3d_device->CreateDepthStencilView(target.texture, &stencil_desc, &target.view);
+
+	d3d_depth_pool.push_back(target);
+	return target.view;
+}
+
+void d3d_depth_release(ID3D11DepthStencilView* view) {
+	for (size_t i = 0; i < d3d_depth_pool.size(); i++) {
+		d3d_depth_target_t& target = d3d_depth_pool[i];
+		if (target.view != view || --target.users > 0)
+			continue;
+		target.view   ->Release();
+		target.texture->Release();
+		d3d_depth_pool.erase(d3d_depth_pool.begin() + i);
+		return;
+	}
+}
+
+// Estimated VRAM for the XR render targets, assuming 4 bytes per sample for
+// both color and depth. Drivers may pad or compress, so this is a lower bound.
+void d3d_memory_report() {
+	uint64_t color_bytes     = 0;
+	uint64_t submitted_bytes = 0; // Depth swapchains, with -submitDepth
+	for (size_t i = 0; i < xr_swapchains.size(); i++) {
+		const swapchain_t& swapchain = xr_swapchains[i];
+		uint64_t           image_bytes = (uint64_t)swapchain.width * swapchain.height * 4 * swapchain.array_size;
+		color_bytes     += image_bytes * swapchain.surface_images.size();
+		submitted_bytes += image_bytes * swapchain.depth_images.size();
+	}
+	uint64_t depth_bytes    = 0;
+	uint64_t unshared_bytes = 0; // What one depth buffer per swapchain image would take
+	for (size_t i = 0; i < d3d_depth_pool.size(); i++) {
+		uint64_t bytes = (uint64_t)d3d_depth_pool[i].width * d3d_depth_pool[i].height * 4 * d3d_depth_pool[i].array_size;
+		depth_bytes    += bytes;
+		unshared_bytes += bytes * d3d_depth_pool[i].users;
+	}
+
+	const double mb = 1024.0 * 1024.0;
+	char text[256];
+	if (submitted_bytes > 0) {
+		sprintf_s(text, "XR render targets: color %.1f MB, depth %.1f MB in depth swapchains\n",
+			color_bytes / mb, submitted_bytes / mb);
+	} else {
+		sprintf_s(text, "XR render targets: color %.1f MB, depth %.1f MB in %zu shared buffers (%.1f MB saved over one per image)\n",
+			color_bytes / mb, depth_bytes / mb, d3d_depth_pool.size(), (unshared_bytes - depth_bytes) / mb);
+	}
+	OutputDebugStringA(text);
+}
+
+// Single pass stereo selects the render target slice in the vertex shader,
+// which D3D11 only allows on devices reporting this option
+bool d3d_single_pass_supported() {
+	D3D11_FEATURE_DATA_D3D11_OPTIONS3 options = {};
+	if (FAILED(d3d_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS3, &options, sizeof(options))))
+		return false;
+	return options.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer == TRUE;
+}
+
+bool d3d_gpu_timer_init() {
+	D3D11_QUERY_DESC disjoint_desc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+	D3D11_QUERY_DESC stamp_desc    = { D3D11_QUERY_TIMESTAMP,          0 };
+	for (int32_t i = 0; i < D3D_GPU_TIMER_LATENCY; i++) {
+		if (FAILED(d3d_device->CreateQuery(&disjoint_desc, &d3d_gpu_timer.disjoint[i])) ||
+			FAILED(d3d_device->CreateQuery(&stamp_desc,    &d3d_gpu_timer.start[i]))    ||
+			FAILED(d3d_device->CreateQuery(&stamp_desc,    &d3d_gpu_timer.end[i]))) {
+			d3d_gpu_timer_destroy();
+			return false;
+		}
+	}
+	return true;
+}
+
+void d3d_gpu_timer_destroy() {
+	for (int32_t i = 0; i < D3D_GPU_TIMER_LATENCY; i++) {
+		if (d3d_gpu_timer.disjoint[i]) d3d_gpu_timer.disjoint[i]->Release();
+		if (d3d_gpu_timer.start[i])    d3d_gpu_timer.start[i]   ->Release();
+		if (d3d_gpu_timer.end[i])      d3d_gpu_timer.end[i]     ->Release();
+	}
+	d3d_gpu_timer = {};
+}
+
+void d3d_gpu_timer_begin() {
+	if (d3d_gpu_timer.disjoint[0] == nullptr)
+		return;
+	// Out of slots, give up on the oldest frame rather than wait for it
+	if (d3d_gpu_timer.issued - d3d_gpu_timer.read >= D3D_GPU_TIMER_LATENCY)
+		d3d_gpu_timer.read++;
+
+	uint32_t slot = d3d_gpu_timer.issued % D3D_GPU_TIMER_LATENCY;
+	d3d_context->Begin(d3d_gpu_timer.disjoint[slot]);
+	d3d_context->End  (d3d_gpu_timer.start[slot]);
+}
+
+void d3d_gpu_timer_end() {
+	if (d3d_gpu_timer.disjoint[0] == nullptr)
+		return;
+	uint32_t slot = d3d_gpu_timer.issued % D3D_GPU_TIMER_LATENCY;
+	d3d_context->End(d3d_gpu_timer.end[slot]);
+	d3d_context->End(d3d_gpu_timer.disjoint[slot]);
+	d3d_gpu_timer.issued++;
+}
+
+// Returns the newest GPU frame time that is ready, in ms, or -1 if none is
+float d3d_gpu_timer_read() {
+	float result = -1;
+	while (d3d_gpu_timer.read < d3d_gpu_timer.issued) {
+		uint32_t slot = d3d_gpu_timer.read % D3D_GPU_TIMER_LATENCY;
+
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+		if (d3d_context->GetData(d3d_gpu_timer.disjoint[slot], &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+		UINT64 start = 0, end = 0;
+		if (d3d_context->GetData(d3d_gpu_timer.start[slot], &start, sizeof(start), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+			d3d_context->GetData(d3d_gpu_timer.end  [slot], &end,   sizeof(end),   D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+
+		d3d_gpu_timer.read++;
+		if (!disjoint.Disjoint && disjoint.Frequency > 0 && end > start)
+			result = (float)((double)(end - start) * 1000.0 / (double)disjoint.Frequency);
+	}
+	return result;
+}
+
+void app_render_layer(XrCompositionLayerProjectionView& view, render_handle_t color, render_handle_t depth) {
+	XrRect2Di& rect = view.subImage.imageRect;
+	render_set_viewport(app_render, { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height });
+
+	// Clear swapchain color and depth targets and prepare for rendering
+	// Navy blue background color
+	float clear[] = { 0.098f, 0.137f, 0.294f, 1.0f }; // R, G, B, A
+	render_clear(app_render, color, depth, clear);
+	render_set_targets(app_render, color, depth);
+
+	app_draw(view);
+}
+
+// Single pass stereo. Both views share the swapchain and so the image rect,
+// and the target views cover every slice, so one clear and one instanced
+// draw per mesh render both eyes.
+void app_render_layer_stereo(XrCompositionLayerProjectionView* views, render_handle_t color, render_handle_t depth) {
+	XrRect2Di& rect = views[0].subImage.imageRect;
+	render_set_viewport(app_render, { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height });
+
+	float clear[] = { 0.098f, 0.137f, 0.294f, 1.0f };
+	render_clear(app_render, color, depth, clear);
+	render_set_targets(app_render, color, depth);
+
+	app_draw_stereo(views);
+}
+
+// D3D11 has no variable rate shading, so foveation renders the view twice:
+// once at full resolution, scissored to the fovea, and once whole into the
+// low resolution periphery target. The periphery is then upscaled into the
+// swapchain image everywhere outside the fovea, depth included, so submitted
+// depth stays complete.
+void d3d_render_layer_foveated(XrCompositionLayerProjectionView& view, swapchain_surfdata_t& surface, d3d_periphery_target_t& periphery, const foveation_map_t& map) {
+	XrRect2Di&    rect     = view.subImage.imageRect;
+	render_rect_t viewport = { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height };
+	render_rect_t scissor  = { (float)map.fovea.offset.x, (float)map.fovea.offset.y, (float)map.fovea.extent.width, (float)map.fovea.extent.height };
+	float clear[] = { 0.098f, 0.137f, 0.294f, 1.0f };
+
+	// Fovea, at full resolution
+	render_set_viewport(app_render, viewport);
+	render_set_scissor (app_render, scissor);
+	render_clear(app_render, surface.target_view, surface.depth_view, clear);
+	render_set_targets(app_render, surface.target_view, surface.depth_view);
+	app_draw(view, &app_cube_scissor_pipeline);
+
+	// Whole view, at periphery resolution
+	float width  = min((float)periphery.width,  max(1.0f, floorf(rect.extent.width  * map.periphery_scale)));
+	float height = min((float)periphery.height, max(1.0f, floorf(rect.extent.height * map.periphery_scale)));
+	render_set_viewport(app_render, { 0.0f, 0.0f, width, height });
+	render_clear(app_render, periphery.color_target, periphery.depth_target, clear);
+	render_set_targets(app_render, periphery.color_target, periphery.depth_target);
+	app_draw(view);
+
+	render_set_viewport(app_render, viewport);
+	render_set_targets(app_render, surface.target_view, surface.depth_view);
+	d3d_blit_periphery(periphery, map, rect, width, height);
+}
+
+void d3d_blit_periphery(d3d_periphery_target_t& periphery, const foveation_map_t& map, const XrRect2Di& rect, float width, float height) {
+	app_blit_buffer_t blit_buffer;
+	blit_buffer.fovea_rect   = { (float)map.fovea.offset.x, (float)map.fovea.offset.y,
+		(float)(map.fovea.offset.x + map.fovea.extent.width), (float)(map.fovea.offset.y + map.fovea.extent.height) };
+	blit_buffer.dest_rect    = { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height };
+	blit_buffer.source_scale = { width / periphery.width, height / periphery.height, 0, 0 };
+	render_update_constants(app_render, app_blit_buffer, &blit_buffer, sizeof(blit_buffer));
+
+	render_handle_t textures[] = { periphery.color_resource, periphery.depth_resource };
+	render_set_pipeline (app_render, &app_blit_pipeline);
+	render_set_constants(app_render, render_stage_pixel, 2, app_blit_buffer);
+	render_set_textures (app_render, 0, (uint32_t)_countof(textures), textures);
+	render_draw(app_render, 3);
+
+	// Unbind, so the periphery can be a render target again for the next view
+	render_handle_t no_textures[_countof(textures)] = {};
+	render_set_textures(app_render, 0, (uint32_t)_countof(no_textures), no_textures);
+}
+
+// On failure, result is left empty, with nothing for the foveated path to bind
+bool d3d_make_periphery_target(int32_t width, int32_t height, d3d_periphery_target_t& result) {
+	result = {};
+	result.width  = width;
+	result.height = height;
+
+	D3D11_TEXTURE2D_DESC color_desc = {};
+	color_desc.SampleDesc.Count = 1;
+	color_desc.MipLevels        = 1;
+	color_desc.Width            = width;
+	color_desc.Height           = height;
+	color_desc.ArraySize        = 1;
+	color_desc.Format           = (DXGI_FORMAT)d3d_swapchain_fmt;
+	color_desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	bool created =
+		SUCCEEDED(d3d_device->CreateTexture2D(&color_desc, nullptr, &result.color)) &&
+		SUCCEEDED(d3d_device->CreateRenderTargetView  (result.color, nullptr, &result.color_target)) &&
+		SUCCEEDED(d3d_device->CreateShaderResourceView(result.color, nullptr, &result.color_resource));
+
+	D3D11_TEXTURE2D_DESC depth_desc = color_desc;
+	depth_desc.Format    = DXGI_FORMAT_R32_TYPELESS;
+	depth_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_DEPTH_STENCIL;
+
+	D3D11_DEPTH_STENCIL_VIEW_DESC stencil_desc = {};
+	stencil_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+	stencil_desc.Format        = DXGI_FORMAT_D32_FLOAT;
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC resource_desc = {};
+	resource_desc.ViewDimension       = D3D11_SRV_DIMENSION_TEXTURE2D;
+	resource_desc.Format              = DXGI_FORMAT_R32_FLOAT;
+	resource_desc.Texture2D.MipLevels = 1;
+
+	created = created &&
+		SUCCEEDED(d3d_device->CreateTexture2D(&depth_desc, nullptr, &result.depth)) &&
+		SUCCEEDED(d3d_device->CreateDepthStencilView  (result.depth, &stencil_desc,  &result.depth_target)) &&
+		SUCCEEDED(d3d_device->CreateShaderResourceView(result.depth, &resource_desc, &result.depth_resource));
+	if (!created)
+		d3d_periphery_destroy(result);
+	return created;
+}
+
+void d3d_periphery_destroy(d3d_periphery_target_t& target) {
+	if (target.color_resource) target.color_resource->Release();
+	if (target.color_target)   target.color_target  ->Release();
+	if (target.color)          target.color         ->Release();
+	if (target.depth_resource) target.depth_resource->Release();
+	if (target.depth_target)   target.depth_target  ->Release();
+	if (target.depth)          target.depth         ->Release();
+	target = {};
+}
+
+// D3D11 backend for RenderBackend.h. Handles are the D3D objects themselves,
+// except for pipelines, which are d3d_pipeline_t. The backend's context is a
+// deferred context to record into, or null for the immediate context.
+void d3d_execute(void* context, const render_command_t& command, const void* data) {
+	ID3D11DeviceContext* target = context ? (ID3D11DeviceContext*)context : d3d_context;
+	switch (command.type) {
+	case render_cmd_set_pipeline: {
+		const d3d_pipeline_t& pipeline = *(const d3d_pipeline_t*)command.handles[0];
+		target->VSSetShader(pipeline.vshader, nullptr, 0);
+		target->PSSetShader(pipeline.pshader, nullptr, 0);
+		target->IASetInputLayout(pipeline.layout);
+		target->IASetPrimitiveTopology(pipeline.topology);
+		target->RSSetState(pipeline.raster);
+		target->OMSetDepthStencilState(pipeline.depth, 0);
+		target->PSSetSamplers(0, _countof(pipeline.samplers), pipeline.samplers);
+	} break;
+	case render_cmd_set_targets: {
+		ID3D11RenderTargetView* color = (ID3D11RenderTargetView*)command.handles[0];
+		target->OMSetRenderTargets(color ? 1 : 0, &color, (ID3D11DepthStencilView*)command.handles[1]);
+	} break;
+	case render_cmd_set_viewport: {
+		D3D11_VIEWPORT viewport = CD3D11_VIEWPORT(command.rect.x, command.rect.y, command.rect.width, command.rect.height);
+		target->RSSetViewports(1, &viewport);
+	} break;
+	case render_cmd_set_scissor: {
+		D3D11_RECT rect = { (LONG)command.rect.x, (LONG)command.rect.y,
+			(LONG)(command.rect.x + command.rect.width), (LONG)(command.rect.y + command.rect.height) };
+		target->RSSetScissorRects(1, &rect);
+	} break;
+	case render_cmd_set_vertex_buffer: {
+		ID3D11Buffer* buffer = (ID3D11Buffer*)command.handles[0];
+		UINT          stride = command.count;
+		UINT          offset = 0;
+		target->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+	} break;
+	case render_cmd_set_index_buffer:
+		target->IASetIndexBuffer((ID3D11Buffer*)command.handles[0], command.count == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
+		break;
+	case render_cmd_set_instance_buffer: {
+		ID3D11Buffer* buffer = (ID3D11Buffer*)command.handles[0];
+		UINT          stride = command.count;
+		UINT          offset = 0;
+		target->IASetVertexBuffers(1, 1, &buffer, &stride, &offset);
+	} break;
+	case render_cmd_set_constants: {
+		ID3D11Buffer* buffer = (ID3D11Buffer*)command.handles[0];
+		if (command.stages & render_stage_vertex) target->VSSetConstantBuffers(command.slot, 1, &buffer);
+		if (command.stages & render_stage_pixel)  target->PSSetConstantBuffers(command.slot, 1, &buffer);
+	} break;
+	case render_cmd_set_textures: {
+		ID3D11ShaderResourceView* textures[2] = { (ID3D11ShaderResourceView*)command.handles[0], (ID3D11ShaderResourceView*)command.handles[1] };
+		target->PSSetShaderResources(command.slot, command.count, textures);
+	} break;
+	case render_cmd_update_constants:
+		target->UpdateSubresource((ID3D11Buffer*)command.handles[0], 0, nullptr, data, 0, 0);
+		break;
+	case render_cmd_update_buffer: {
+		// Dynamic buffers only, discarding hands back fresh memory each time
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		if (SUCCEEDED(target->Map((ID3D11Buffer*)command.handles[0], 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+			memcpy(mapped.pData, data, command.count);
+			target->Unmap((ID3D11Buffer*)command.handles[0], 0);
+		}
+	} break;
+	case render_cmd_clear:
+		if (command.handles[0]) target->ClearRenderTargetView((ID3D11RenderTargetView*)command.handles[0], command.color);
+		if (command.handles[1]) target->ClearDepthStencilView((ID3D11DepthStencilView*)command.handles[1], D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		break;
+	case render_cmd_draw:
+		if (command.instances > 1) target->DrawInstanced(command.count, command.instances, 0, 0);
+		else                       target->Draw(command.count, 0);
+		break;
+	case render_cmd_draw_indexed:
+		if (command.instances > 1 || command.first > 0) target->DrawIndexedInstanced(command.count, command.instances, 0, 0, command.first);
+		else                       target->DrawIndexed(command.count, 0, 0);
+		break;
+	}
+}
+
+void d3d_swapchain_destroy(swapchain_t& swapchain) {
+	for (uint32_t i = 0; i < swapchain.surface_data.size(); i++) {
+		if (swapchain.surface_data[i].depth_view) d3d_depth_release(swapchain.surface_data[i].depth_view);
+		swapchain.surface_data[i].target_view->Release();
+	}
+	for (uint32_t i = 0; i < swapchain.depth_views.size(); i++) {
+		if (swapchain.depth_views[i]) swapchain.depth_views[i]->Release();
+	}
+	d3d_periphery_destroy(swapchain.periphery);
+}
+
+XMMATRIX d3d_xr_projection(XrFovf fov, float clip_near, float clip_far) {
+	const float left  = clip_near * tanf(fov.angleLeft);
+	const float right = clip_near * tanf(fov.angleRight);
+	const float down  = clip_near * tanf(fov.angleDown);
+	const float up    = clip_near * tanf(fov.angleUp);
+
+	return XMMatrixPerspectiveOffCenterRH(left, right, down, up, clip_near, clip_far);
+}
+
+uint32_t d3d_shader_flags() {
+	DWORD flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
+#ifdef _DEBUG
+	flags |= D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_DEBUG;
+#else
+	flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+	return flags;
+}
+
+// Only reached on a shader cache miss. Runs on shader cache worker threads.
+bool d3d_compile_shader(const shader_desc_t& desc, vector<uint8_t>& bytecode) {
+	ID3DBlob* compiled = nullptr;
+	ID3DBlob* errors   = nullptr;
+	if (FAILED(D3DCompile(desc.source, strlen(desc.source), nullptr, nullptr, nullptr, desc.entry, desc.target, desc.flags, 0, &compiled, &errors))) {
+		char text[128];
+		sprintf_s(text, "Error: D3DCompile failed for %s %s\n", desc.entry, desc.target);
+		OutputDebugStringA(text);
+		if (errors) OutputDebugStringA((char*)errors->GetBufferPointer());
+	}
+	if (errors) errors->Release();
+	if (compiled == nullptr)
+		return false;
+
+	const uint8_t* bytes = (const uint8_t*)compiled->GetBufferPointer();
+	bytecode.assign(bytes, bytes + compiled->GetBufferSize());
+	compiled->Release();
+	return true;
+}
+
+// Identifies the D3DCompile build for the shader cache key: the header's
+// compiler version plus the file version of the DLL actually loaded, so a
+// redistributable or SDK update never reuses older bytecode.
+void d3d_compiler_identity(char* identity, size_t size) {
+	DWORD version_ms = 0;
+	DWORD version_ls = 0;
+	char  path[MAX_PATH];
+	HMODULE module = GetModuleHandleA(D3DCOMPILER_DLL_A);
+	if (module && GetModuleFileNameA(module, path, sizeof(path))) {
+		DWORD             handle     = 0;
+		vector<uint8_t>   info(GetFileVersionInfoSizeA(path, &handle));
+		VS_FIXEDFILEINFO* fixed      = nullptr;
+		UINT              fixed_size = 0;
+		if (!info.empty() && GetFileVersionInfoA(path, 0, (DWORD)info.size(), info.data()) &&
+			VerQueryValueA(info.data(), "\\", (void**)&fixed, &fixed_size) && fixed) {
+			version_ms = fixed->dwFileVersionMS;
+			version_ls = fixed->dwFileVersionLS;
+		}
+	}
+	sprintf_s(identity, size, "%s %d %u.%u.%u.%u", D3DCOMPILER_DLL_A, D3D_COMPILER_VERSION,
+		HIWORD(version_ms), LOWORD(version_ms), HIWORD(version_ls), LOWORD(version_ls));
+}
+
+bool app_poll_channel_events() {
+	bool received = false;
+	opaque_channel_event_t channel_event;
+	while (opaque_channel_poll_event(channel_event)) {
+		received = true;
+		switch (channel_event) {
+		case opaque_channel_event_connected:    OutputDebugStringA("Channel event: connected\n");    break;
+		case opaque_channel_event_disconnected: OutputDebugStringA("Channel event: disconnected\n"); break;
+		}
+	}
+	return received;
+}
+
+// Runs on whichever thread receives channel data. Returns true if the message
+// was consumed here, rather than by the channel's default handling.
+bool app_handle_channel_message(const uint8_t* data, uint32_t size) {
+	foveation_hint_message_t hint;
+	if (!app_foveation.enabled || !foveation_parse_hint(data, size, hint))
+		return false;
+	foveation_add_hint(app_foveation, hint, app_time_s());
+	return true;
+}
+
+// Seconds since launch, the clock foveation samples are kept in
+double app_time_s() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - app_launch_time).count();
+}
+
+void app_idle_wait(bool activity) {
+	if (activity) {
+		app_idle_wait_ms = 1;
+	}
+
+	// xrPollEvent has nothing to wait on, so the timeout doubles as the XR
+	// event poll timer. Window input and channel wakeups end the wait early.
+	HANDLE handles[1];
+	DWORD  handle_count = 0;
+	if (opaque_channel_wakeup_event) {
+		handles[handle_count++] = opaque_channel_wakeup_event;
+	}
+	MsgWaitForMultipleObjects(handle_count, handles, FALSE, app_idle_wait_ms, QS_ALLINPUT);
+
+	// In pump mode nothing receives while the loop sleeps, so the wait also
+	// stands in for the channel's state check interval
+	uint32_t max_wait_ms = app_idle_max_wait_ms;
+	if (opaque_channel_pump_mode && xr_opaque_channel != XR_NULL_HANDLE)
+		max_wait_ms = min(max_wait_ms, opaque_channel_state_check_interval_ms);
+	app_idle_wait_ms = min(app_idle_wait_ms * 2, max_wait_ms);
+}
+
+void app_update(app_frame_t& frame) {
+	// Add rotation animation (single axis, slow spin). Driven by display
+	// time, so the speed doesn't depend on the refresh rate or on frames the
+	// runtime skips.
+	static XrTime first_display_time = frame.state.predictedDisplayTime;
+	double seconds = (double)(frame.state.predictedDisplayTime - first_display_time) / 1.0e9;
+	float  angle   = (float)fmod(seconds * app_spin_rate, (double)XM_2PI);
+	app_hero_local.rotation[1] = sinf(angle * 0.5f);
+	app_hero_local.rotation[3] = cosf(angle * 0.5f);
+	transform_set_local(app_transforms, app_hero_node, app_hero_local);
+
+	// Once per frame, every view and the spectator draw with the result
+	transform_update(app_transforms);
+	transform_get_world(app_transforms, app_hero_node, frame.cube_world.m);
+}
+
+// Runs on the render thread when pipelined, otherwise inline in wWinMain
+void app_render_frame(app_frame_t& frame) {
+	frame_timers_begin_frame();
+	frame_timers_add(frame_phase_message_pump, frame.pump_ticks);
+	frame_timers_add(frame_phase_wait_frame,   frame.wait_ticks);
+	frame_timers_add(frame_phase_frame,        frame.pump_ticks + frame.wait_ticks);
+
+	if (&frame != &app_frame_state) {
+		app_frame_state = frame;
+	}
+	// Nothing else binds state, but a fresh start each frame keeps any
+	// stale assumption from lasting longer than a frame
+	render_invalidate(app_render);
+	bool rendered = openxr_render_frame(app_frame_state);
+
+	// Render to window for spectator view, but only on frames the headset
+	// rendered too
+	if (rendered) {
+		frame_timer_scope_t timer(frame_phase_spectator);
+		window_present_vr_view();
+	}
+	if (rendered && app_first_frame_ms < 0) {
+		app_first_frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - app_launch_time).count();
+		char text[64];
+		sprintf_s(text, "Time to first frame: %.1f ms\n", app_first_frame_ms);
+		OutputDebugStringA(text);
+	}
+	if (rendered) {
+		render_end_frame(app_render);
+	}
+	if (app_record_commands) {
+		if (rendered && app_render.stats.frames == app_record_frame)
+			render_recording_dump(app_recording);
+		render_recording_clear(app_recording);
+	}
+	frame_timers_end_frame();
+	frame_arena_end_frame();
+}
+
+// Load shaders from the shader cache, compiling only on a miss. Needs no
+// device, so it runs from the very start of app_startup.
+bool app_load_shaders() {
+	shader_desc_t shader_descs[] = {
+		{ screen_shader_code, "vs", "vs_5_0", d3d_shader_flags() },
+		{ screen_shader_code, "ps", "ps_5_0", d3d_shader_flags() },
+		{ blit_shader_code, "vs_blit", "vs_5_0", d3d_shader_flags() },
+		{ blit_shader_code, "ps_blit", "ps_5_0", d3d_shader_flags() },
+		{ blit_shader_code, "ps_mirror", "ps_5_0", d3d_shader_flags() },
+		{ screen_shader_code, "vs_stereo", "vs_5_0", d3d_shader_flags() },
+	};
+	static_assert(_countof(shader_descs) == _countof(app_shader_blobs), "One blob per shader");
+
+	// Keyed from the descs above, so these only hit while the build flags
+	// in the vcxproj match d3d_shader_flags
+	static const shader_embedded_t embedded[] = {
+		{ shader_descs[0], embedded_vs,        sizeof(embedded_vs)        },
+		{ shader_descs[1], embedded_ps,        sizeof(embedded_ps)        },
+		{ shader_descs[2], embedded_vs_blit,   sizeof(embedded_vs_blit)   },
+		{ shader_descs[3], embedded_ps_blit,   sizeof(embedded_ps_blit)   },
+		{ shader_descs[4], embedded_ps_mirror, sizeof(embedded_ps_mirror) },
+		{ shader_descs[5], embedded_vs_stereo, sizeof(embedded_vs_stereo) },
+	};
+	static_assert(_countof(embedded) == _countof(shader_descs), "One embedded blob per shader");
+
+	char compiler[128];
+	d3d_compiler_identity(compiler, sizeof(compiler));
+	std::string directory = shader_cache_default_directory("StreamingSession-OpenXRSample");
+	shader_cache_init(directory.empty() ? nullptr : directory.c_str(), compiler, d3d_compile_shader, embedded, _countof(embedded));
+	bool result = shader_cache_get(shader_descs, app_shader_blobs, _countof(shader_descs));
+	if (!result) {
+		OutputDebugStringA("Error: shader compilation failed\n");
+	}
+	shader_cache_report();
+	return result;
+}
+
+bool app_init() {
+	vector<uint8_t>& vert_shader_blob  = app_shader_blobs[0].bytecode;
+	vector<uint8_t>& pixel_shader_blob = app_shader_blobs[1].bytecode;
+
+	d3d_device->CreateVertexShader(vert_shader_blob.data(), vert_shader_blob.size(), nullptr, &app_vshader);
+	if (xr_single_pass) {
+		vector<uint8_t>& stereo_shader_blob = app_shader_blobs[5].bytecode;
+		d3d_device->CreateVertexShader(stereo_shader_blob.data(), stereo_shader_blob.size(), nullptr, &app_stereo_vshader);
+	}
+
+	d3d_device->CreatePixelShader(pixel_shader_blob.data(), pixel_shader_blob.size(), nullptr, &app_pshader);
+
+	// Update vertex layout for color and normal coordinates
+	D3D11_INPUT_ELEMENT_DESC vert_desc[] = {
+		{"SV_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"COLOR",       0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"NORMAL",      0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"WORLD",       0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{"WORLD",       1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{"WORLD",       2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{"WORLD",       3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+	};
+
+	d3d_device->CreateInputLayout(vert_desc, (UINT)_countof(vert_desc), vert_shader_blob.data(), vert_shader_blob.size(), &app_shader_layout);
+	if (xr_single_pass) {
+		for (uint32_t i = 3; i < _countof(vert_desc); i++)
+			vert_desc[i].InstanceDataStepRate = 2;
+		vector<uint8_t>& stereo_shader_blob = app_shader_blobs[5].bytecode;
+		d3d_device->CreateInputLayout(vert_desc, (UINT)_countof(vert_desc), stereo_shader_blob.data(), stereo_shader_blob.size(), &app_stereo_layout);
+	}
+	// Create GPU resources for cube
+	D3D11_SUBRESOURCE_DATA vert_buff_data = { screen_verts };
+	D3D11_SUBRESOURCE_DATA ind_buff_data = { screen_inds };
+	CD3D11_BUFFER_DESC vert_buff_desc(sizeof(screen_verts), D3D11_BIND_VERTEX_BUFFER);
+	CD3D11_BUFFER_DESC ind_buff_desc(sizeof(screen_inds), D3D11_BIND_INDEX_BUFFER);
+	CD3D11_BUFFER_DESC const_buff_desc(sizeof(app_material_buffer_t), D3D11_BIND_CONSTANT_BUFFER);
+	CD3D11_BUFFER_DESC view_buff_desc(sizeof(app_view_buffer_t), D3D11_BIND_CONSTANT_BUFFER);
+	CD3D11_BUFFER_DESC stereo_buff_desc(sizeof(app_stereo_view_buffer_t), D3D11_BIND_CONSTANT_BUFFER);
+
+	d3d_device->CreateBuffer(&vert_buff_desc, &vert_buff_data, &app_vertex_buffer);
+	d3d_device->CreateBuffer(&ind_buff_desc, &ind_buff_data, &app_index_buffer);
+	d3d_device->CreateBuffer(&const_buff_desc, nullptr, &app_material_buffer);
+	d3d_device->CreateBuffer(&view_buff_desc, nullptr, &app_view_buffer);
+	d3d_device->CreateBuffer(&stereo_buff_desc, nullptr, &app_stereo_view_buffer);
+
+	// Create rasterizer state with no culling so all cube faces are visible
+	D3D11_RASTERIZER_DESC raster_desc = {};
+	raster_desc.FillMode = D3D11_FILL_SOLID;
+	raster_desc.CullMode = D3D11_CULL_NONE;  // Disable back-face culling
+	raster_desc.FrontCounterClockwise = FALSE;
+	raster_desc.DepthClipEnable = TRUE;
+	d3d_device->CreateRasterizerState(&raster_desc, &app_rasterizer_state);
+	raster_desc.ScissorEnable = TRUE;
+	d3d_device->CreateRasterizerState(&raster_desc, &app_rasterizer_scissor);
+
+	// Periphery upscale for foveated rendering, and the spectator mirror
+	vector<uint8_t>& blit_vert_blob    = app_shader_blobs[2].bytecode;
+	vector<uint8_t>& blit_pixel_blob   = app_shader_blobs[3].bytecode;
+	vector<uint8_t>& mirror_pixel_blob = app_shader_blobs[4].bytecode;
+	d3d_device->CreateVertexShader(blit_vert_blob.data(),    blit_vert_blob.size(),    nullptr, &app_blit_vshader);
+	d3d_device->CreatePixelShader (blit_pixel_blob.data(),   blit_pixel_blob.size(),   nullptr, &app_blit_pshader);
+	d3d_device->CreatePixelShader (mirror_pixel_blob.data(), mirror_pixel_blob.size(), nullptr, &app_mirror_pshader);
+
+	CD3D11_BUFFER_DESC blit_buff_desc(sizeof(app_blit_buffer_t), D3D11_BIND_CONSTANT_BUFFER);
+	d3d_device->CreateBuffer(&blit_buff_desc, nullptr, &app_blit_buffer);
+
+	D3D11_SAMPLER_DESC sampler_desc = {};
+	sampler_desc.Filter         = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	sampler_desc.AddressU       = D3D11_TEXTURE_ADDRESS_CLAMP;
+	sampler_desc.AddressV       = D3D11_TEXTURE_ADDRESS_CLAMP;
+	sampler_desc.AddressW       = D3D11_TEXTURE_ADDRESS_CLAMP;
+	sampler_desc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+	sampler_desc.MaxLOD         = D3D11_FLOAT32_MAX;
+	d3d_device->CreateSamplerState(&sampler_desc, &app_blit_samplers[0]);
+	// Depth isn't filtered, blending depths across an edge makes up surfaces
+	sampler_desc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+	d3d_device->CreateSamplerState(&sampler_desc, &app_blit_samplers[1]);
+
+	D3D11_DEPTH_STENCIL_DESC depth_state_desc = {};
+	depth_state_desc.DepthEnable    = TRUE;
+	depth_state_desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	depth_state_desc.DepthFunc      = D3D11_COMPARISON_ALWAYS;
+	d3d_device->CreateDepthStencilState(&depth_state_desc, &app_blit_depth_state);
+
+	app_cube_pipeline = { app_vshader, app_pshader, app_shader_layout, app_rasterizer_state, nullptr, {}, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST };
+	app_cube_scissor_pipeline        = app_cube_pipeline;
+	app_cube_scissor_pipeline.raster = app_rasterizer_scissor;
+	app_cube_stereo_pipeline         = app_cube_pipeline;
+	app_cube_stereo_pipeline.vshader = app_stereo_vshader;
+	app_cube_stereo_pipeline.layout  = app_stereo_layout;
+	app_blit_pipeline   = { app_blit_vshader, app_blit_pshader,   nullptr, app_rasterizer_state, app_blit_depth_state,
+		{ app_blit_samplers[0], app_blit_samplers[1] }, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST };
+	app_mirror_pipeline = { app_blit_vshader, app_mirror_pshader, nullptr, app_rasterizer_state, nullptr,
+		{ app_blit_samplers[0], app_blit_samplers[1] }, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST };
+
+	scene_mesh_t cube = { app_vertex_buffer, app_index_buffer, sizeof(float) * 9, sizeof(uint16_t), (uint32_t)_countof(screen_inds), 0.8661f };
+	app_build_scene(cube, &app_cube_pipeline, app_stereo_vshader ? &app_cube_stereo_pipeline : nullptr);
+
+	// Room for every object at once, a frame where all of them are visible
+	CD3D11_BUFFER_DESC instance_buff_desc((UINT)(app_scene.object_bucket.size() * sizeof(scene_instance_t)), D3D11_BIND_VERTEX_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+	d3d_device->CreateBuffer(&instance_buff_desc, nullptr, &app_instance_buffer);
+	app_draw_buffers = { app_material_buffer, app_view_buffer, app_stereo_view_buffer, app_instance_buffer };
+
+	// Chunks without a deferred context are recorded and replayed, which is
+	// also what -nullRender and -recordCommands need
+	if (app_parallel_record && !app_null_render && !app_record_commands) {
+		for (uint32_t c = 0; c < RENDER_WORKERS_MAX_CHUNKS; c++) {
+			if (FAILED(d3d_device->CreateDeferredContext(0, &d3d_deferred[c])))
+				break;
+			render_workers_set_backend(app_workers, c, { "d3d11 deferred", d3d_execute, d3d_deferred[c] });
+		}
+	}
+	return true;
+}
+
+#ifdef XR_SAMPLE_VULKAN
+// app_init for the Vulkan backend, the cube only. Shaders are SPIR-V that
+// the project's custom build step compiles from Shaders/cube.vert and
+// cube.frag into a Shaders folder next to the executable.
+bool app_init_vk() {
+	char path[MAX_PATH];
+	DWORD length = GetModuleFileNameA(nullptr, path, sizeof(path));
+	if (length == 0 || length == sizeof(path))
+		return false;
+	string directory = string(path, length);
+	directory = directory.substr(0, directory.find_last_of("\\/") + 1) + "Shaders\\";
+
+	vector<uint32_t> vert_code, frag_code;
+	if (!vk_load_spirv((directory + "cube.vert.spv").c_str(), vert_code) || !vk_load_spirv((directory + "cube.frag.spv").c_str(), frag_code))
+		return false;
+
+	vk_pipeline_desc_t desc = {};
+	desc.vertex_code     = vert_code.data();
+	desc.vertex_size     = vert_code.size() * sizeof(uint32_t);
+	desc.fragment_code   = frag_code.data();
+	desc.fragment_size   = frag_code.size() * sizeof(uint32_t);
+	desc.vertex_stride   = sizeof(float) * 9; // pos(3) + color(3) + normal(3)
+	desc.attributes[0]   = VK_FORMAT_R32G32B32_SFLOAT;
+	desc.attributes[1]   = VK_FORMAT_R32G32B32_SFLOAT;
+	desc.attributes[2]   = VK_FORMAT_R32G32B32_SFLOAT;
+	desc.attribute_count = 3;
+	desc.depth_test      = true;
+
+	// The world matrix, one row per attribute, as in the D3D11 input layout
+	desc.instance_stride = sizeof(scene_instance_t);
+	for (uint32_t i = 0; i < 4; i++)
+		desc.instance_attributes[i] = VK_FORMAT_R32G32B32A32_SFLOAT;
+	desc.instance_attribute_count = 4;
+
+	// Both constant buffers fit in push constants, in the order the shader
+	// declares them
+	render_handle_t pipeline = vk_create_pipeline(desc);
+	app_draw_buffers.material_constants = vk_create_push_constants(0, sizeof(app_material_buffer_t));
+	app_draw_buffers.view_constants     = vk_create_push_constants(sizeof(app_material_buffer_t), sizeof(app_view_buffer_t));
+
+	scene_mesh_t cube = { nullptr, nullptr, sizeof(float) * 9, sizeof(uint16_t), (uint32_t)_countof(screen_inds), 0.8661f };
+	cube.vertex_buffer = vk_create_buffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, screen_verts, sizeof(screen_verts));
+	cube.index_buffer  = vk_create_buffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT,  screen_inds,  sizeof(screen_inds));
+	if (!pipeline || !app_draw_buffers.material_constants || !app_draw_buffers.view_constants || !cube.vertex_buffer || !cube.index_buffer)
+		return false;
+
+	app_build_scene(cube, pipeline, nullptr);
+	app_draw_buffers.instance_buffer = vk_create_dynamic_buffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, app_scene.object_bucket.size() * sizeof(scene_instance_t));
+	return app_draw_buffers.instance_buffer != nullptr;
+}
+
+// -vkValidate. The app's scene through vk_validate, animated and rendered
+// with the same commands a headset frame records for one view, on an
+// offscreen target the size of a typical eye buffer.
+bool app_vk_validate(uint32_t frames) {
+	vk_validate_scene_t scene = {};
+	scene.init  = [](void*) { return app_init_vk(); };
+	scene.frame = [](void*, XrCompositionLayerProjectionView& layer_view, render_handle_t target, XrTime display_time) {
+		app_frame_state.state.predictedDisplayTime = display_time;
+		app_update(app_frame_state);
+
+		XrView view = { XR_TYPE_VIEW };
+		view.pose = layer_view.pose;
+		view.fov  = layer_view.fov;
+		app_prepare_scene(&view, 1);
+		app_render_layer(layer_view, target, target);
+	};
+	return vk_validate(app_render, scene, frames, 1024);
+}
+#endif
+
+// View and projection of one view, transposed for the shader
+XMFLOAT4X4 app_view_proj(const XrCompositionLayerProjectionView& view) {
+	// Set up camera matrices
+	// Reading camera matrices from headset via OpenXR
+	XMMATRIX mat_projection = d3d_xr_projection(view.fov, app_clip_near, app_clip_far);
+	XMMATRIX mat_view = XMMatrixInverse(nullptr, XMMatrixAffineTransformation(
+		DirectX::g_XMOne, DirectX::g_XMZero,
+		XMLoadFloat4((XMFLOAT4*)&view.pose.orientation),
+		XMLoadFloat3((XMFLOAT3*)&view.pose.position)));
+
+	XMFLOAT4X4 result;
+	XMStoreFloat4x4(&result, XMMatrixTranspose(mat_view * mat_projection));
+	return result;
+}
+
+// Fills app_scene with the cube as the hero object, and the props with
+// -props, placed through app_transforms. Every material shares the cube's
+// pipelines and only changes the tint. The hero's world matrix is set each
+// frame by app_prepare_scene.
+void app_build_scene(const scene_mesh_t& mesh, render_handle_t pipeline, render_handle_t stereo_pipeline) {
+	const float tints[][4] = {
+		{ 1.0f,  1.0f,  1.0f,  1.0f }, // Hero
+		{ 0.9f,  0.55f, 0.4f,  1.0f },
+		{ 0.45f, 0.75f, 0.5f,  1.0f },
+		{ 0.5f,  0.6f,  0.95f, 1.0f },
+	};
+	app_scene = {};
+	uint32_t cube = scene_add_mesh(app_scene, mesh);
+	uint32_t materials[_countof(tints)];
+	for (uint32_t i = 0; i < _countof(tints); i++) {
+		scene_material_t material = { pipeline, stereo_pipeline };
+		memcpy(material.tint, tints[i], sizeof(material.tint));
+		materials[i] = scene_add_material(app_scene, material);
+	}
+
+	// The hero spins in place, app_update turns it
+	app_hero_local = transform_identity();
+	app_hero_local.position[1] = -0.6f;
+	app_hero_local.position[2] = -2.0f;
+	app_hero_local.scale[0] = app_hero_local.scale[1] = app_hero_local.scale[2] = 0.7f;
+	app_hero_node = transform_add(app_transforms, TRANSFORM_NONE, app_hero_local);
+
+	// Half a meter apart on the floor, centered under the hero
+	vector<uint32_t> prop_nodes;
+	if (app_props) {
+		transform_trs_t floor = transform_identity();
+		floor.position[1] = -1.5f;
+		floor.position[2] = -2.0f;
+		uint32_t floor_node = transform_add(app_transforms, TRANSFORM_NONE, floor);
+
+		float offset = (app_prop_grid - 1) * 0.5f;
+		for (uint32_t z = 0; z < app_prop_grid; z++) {
+			for (uint32_t x = 0; x < app_prop_grid; x++) {
+				transform_trs_t prop = transform_identity();
+				prop.position[0] = (x - offset) * 0.5f;
+				prop.position[2] = (z - offset) * 0.5f;
+				prop.scale[0] = prop.scale[1] = prop.scale[2] = 0.15f;
+				prop_nodes.push_back(transform_add(app_transforms, floor_node, prop));
+			}
+		}
+	}
+	transform_update(app_transforms);
+
+	scene_instance_t world;
+	transform_get_world(app_transforms, app_hero_node, world.world);
+	app_hero_object = scene_add_object(app_scene, cube, materials[0], world);
+	for (uint32_t i = 0; i < prop_nodes.size(); i++) {
+		transform_get_world(app_transforms, prop_nodes[i], world.world);
+		scene_add_object(app_scene, cube, materials[1 + (i % app_prop_grid + i / app_prop_grid) % 3], world);
+	}
+
+	// A draw is at most a pipeline, two buffers, a tint and the draw itself
+	render_recording_clear(app_order_recording);
+	app_order_recording.commands.reserve(app_scene.buckets.size() * 5 + 8);
+	app_order_recording.data    .reserve((app_scene.buckets.size() + 1) * 256);
+}
+
+// Moves the hero to this frame's transform, culls the scene for the views,
+// uploads the visible instances and sorts the draws. Draws after this use
+// the upload, so the spectator camera prepares the scene again for its own
+// view.
+void app_prepare_scene(const XrView* views, uint32_t view_count) {
+	scene_instance_t hero;
+	memcpy(hero.world, &app_frame_state.cube_world, sizeof(hero.world));
+	scene_set_world(app_scene, app_hero_object, hero);
+
+	cull_frustum_t frustum;
+	cull_make_frustum(views, view_count, app_clip_near, app_clip_far, frustum);
+	cull_run(app_cull, frustum, app_scene.bounds);
+
+	scene_build_instances(app_scene, app_cull.visible.data(), (uint32_t)app_cull.visible.size());
+	if (!app_scene.instances.empty())
+		render_update_buffer(app_render, app_draw_buffers.instance_buffer, app_scene.instances.data(), (uint32_t)(app_scene.instances.size() * sizeof(scene_instance_t)));
+
+	// Depth is measured from between the eyes
+	float eye[3] = {};
+	for (uint32_t i = 0; i < view_count; i++) {
+		eye[0] += views[i].pose.position.x / view_count;
+		eye[1] += views[i].pose.position.y / view_count;
+		eye[2] += views[i].pose.position.z / view_count;
+	}
+	// The frame counter moves on at the end of the frame
+	if (app_record_commands && app_render.stats.frames + 1 == app_record_frame)
+		app_log_draw_order(views[0], eye);
+	scene_build_draws(app_scene, eye, app_clip_far, true);
+}
+
+// Logs the binds one view's draws take in bucket order and in sort key
+// order, on the frame -recordCommands logs. Both are recorded without
+// reaching the GPU.
+void app_log_draw_order(const XrView& view, const float eye[3]) {
+	static uint64_t logged_frame = 0;
+	if (logged_frame == app_render.stats.frames)
+		return;
+	logged_frame = app_render.stats.frames;
+
+	XrCompositionLayerProjectionView layer_view = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+	layer_view.pose = view.pose;
+	layer_view.fov  = view.fov;
+
+	uint32_t binds[2];
+	for (uint32_t sorted = 0; sorted < 2; sorted++) {
+		render_context_t render;
+		render_recording_clear(app_order_recording);
+		render_init(render, render_recording_backend(app_order_recording));
+		scene_build_draws(app_scene, eye, app_clip_far, sorted == 1);
+		app_draw_buckets(render, layer_view, nullptr, 0, (uint32_t)app_scene.draws.items.size());
+		binds[sorted] = render_recording_binds(app_order_recording);
+	}
+
+	char text[128];
+	sprintf_s(text, "Draw order, one view: %u binds in bucket order, %u in sort key order\n", binds[0], binds[1]);
+	OutputDebugStringA(text);
+}
+
+void app_draw(XrCompositionLayerProjectionView& view, render_handle_t pipeline) {
+	app_draw_buckets(app_render, view, pipeline, 0, (uint32_t)app_scene.draws.items.size());
+}
+
+// app_draw for both eyes at once. Every draw has twice the instances, and
+// vs_stereo sends odd ones to the right eye's slice.
+void app_draw_stereo(XrCompositionLayerProjectionView* views) {
+	app_draw_stereo_buckets(app_render, views, 0, (uint32_t)app_scene.draws.items.size());
+}
+
+// Draws [first_draw, end_draw) of app_scene.draws through render, which may
+// be a worker's context that knows nothing of what is bound, so the shared
+// constants and instance buffer are always set.
+void app_draw_buckets(render_context_t& render, const XrCompositionLayerProjectionView& view, render_handle_t pipeline, uint32_t first_draw, uint32_t end_draw) {
+	// Nothing visible to any view, see app_prepare_scene
+	if (app_cull.visible.empty())
+		return;
+
+	render_set_constants(render, render_stage_vertex, 0, app_draw_buffers.material_constants);
+	render_set_constants(render, render_stage_vertex, 1, app_draw_buffers.view_constants);
+	render_set_instance_buffer(render, app_draw_buffers.instance_buffer, sizeof(scene_instance_t));
+
+	// Every bucket shares the view constants, which are written once, right
+	// before the first draw, so the pose they carry is the latest one we have.
+	app_view_buffer_t view_buffer;
+	view_buffer.viewproj = app_view_proj(view);
+	render_update_constants(render, app_draw_buffers.view_constants, &view_buffer, sizeof(view_buffer));
+
+	// One instanced draw per bucket with anything visible, in sort key order.
+	// render drops pipeline and buffer binds that match the previous draw,
+	// and the tint is only rewritten when the material changes.
+	uint32_t bound_material = UINT32_MAX;
+	for (uint32_t d = first_draw; d < end_draw; d++) {
+		const scene_bucket_t&   bucket   = app_scene.buckets[app_scene.draws.items[d]];
+		const scene_mesh_t&     mesh     = app_scene.meshes[bucket.mesh];
+		const scene_material_t& material = app_scene.materials[bucket.material];
+
+		// Shaders, culling disabled, scissored for the fovea if asked to
+		render_set_pipeline(render, pipeline ? pipeline : material.pipeline);
+		render_set_vertex_buffer(render, mesh.vertex_buffer, mesh.vertex_stride);
+		render_set_index_buffer (render, mesh.index_buffer, mesh.index_size);
+
+		if (bucket.material != bound_material) {
+			app_material_buffer_t material_buffer;
+			material_buffer.tint = XMFLOAT4(material.tint);
+			render_update_constants(render, app_draw_buffers.material_constants, &material_buffer, sizeof(material_buffer));
+			bound_material = bucket.material;
+		}
+		render_draw_indexed(render, mesh.index_count, bucket.instance_count, bucket.first_instance);
+	}
+}
+
+void app_draw_stereo_buckets(render_context_t& render, const XrCompositionLayerProjectionView* views, uint32_t first_draw, uint32_t end_draw) {
+	if (app_cull.visible.empty())
+		return;
+
+	render_set_constants(render, render_stage_vertex, 0, app_draw_buffers.material_constants);
+	render_set_constants(render, render_stage_vertex, 2, app_draw_buffers.stereo_view_constants);
+	render_set_instance_buffer(render, app_draw_buffers.instance_buffer, sizeof(scene_instance_t));
+
+	app_stereo_view_buffer_t view_buffer;
+	view_buffer.viewproj[0] = app_view_proj(views[0]);
+	view_buffer.viewproj[1] = app_view_proj(views[1]);
+	render_update_constants(render, app_draw_buffers.stereo_view_constants, &view_buffer, sizeof(view_buffer));
+
+	uint32_t bound_material = UINT32_MAX;
+	for (uint32_t d = first_draw; d < end_draw; d++) {
+		const scene_bucket_t&   bucket   = app_scene.buckets[app_scene.draws.items[d]];
+		const scene_mesh_t&     mesh     = app_scene.meshes[bucket.mesh];
+		const scene_material_t& material = app_scene.materials[bucket.material];
+
+		render_set_pipeline(render, material.stereo_pipeline);
+		render_set_vertex_buffer(render, mesh.vertex_buffer, mesh.vertex_stride);
+		render_set_index_buffer (render, mesh.index_buffer, mesh.index_size);
+
+		if (bucket.material != bound_material) {
+			app_material_buffer_t material_buffer;
+			material_buffer.tint = XMFLOAT4(material.tint);
+			render_update_constants(render, app_draw_buffers.material_constants, &material_buffer, sizeof(material_buffer));
+			bound_material = bucket.material;
+		}
+		render_draw_indexed(render, mesh.index_count, 2 * bucket.instance_count, bucket.first_instance);
+	}
+}
+
+// Records the views in app_record_views across app_workers and submits them
+// in view order. Each view is split into as many chunks as it has threads to
+// itself, the caller counting as one, as long as every chunk keeps
+// app_record_min_draws draws. With only a few draws each view is one chunk,
+// and the views record side by side.
+void app_record_layers(uint32_t view_count, bool stereo) {
+	uint32_t draw_count = (uint32_t)app_scene.draws.items.size();
+	uint32_t per_view   = (app_workers.thread_count + view_count) / view_count;
+	if (per_view > draw_count / app_record_min_draws)      per_view = draw_count / app_record_min_draws;
+	if (per_view > RENDER_WORKERS_MAX_CHUNKS / view_count) per_view = RENDER_WORKERS_MAX_CHUNKS / view_count;
+	if (per_view < 1)                                      per_view = 1;
+
+	uint32_t chunk_count = 0;
+	for (uint32_t v = 0; v < view_count; v++) {
+		for (uint32_t c = 0; c < per_view; c++) {
+			app_record_chunk_t& chunk = app_record_chunks[chunk_count++];
+			chunk.view       = v;
+			chunk.first_draw = draw_count * c / per_view;
+			chunk.end_draw   = draw_count * (c + 1) / per_view;
+			chunk.clear      = c == 0;
+		}
+	}
+	app_record_stereo = stereo;
+	render_workers_record(app_workers, chunk_count, app_record_chunk, nullptr);
+
+	// Deferred contexts' command lists go to the immediate context in chunk
+	// order, the same order recorded streams are replayed in
+	for (uint32_t c = 0; c < chunk_count; c++) {
+		if (d3d_command_lists[c] == nullptr)
+			continue;
+		d3d_context->ExecuteCommandList(d3d_command_lists[c], FALSE);
+		d3d_command_lists[c]->Release();
+		d3d_command_lists[c] = nullptr;
+	}
+	render_workers_submit(app_workers, chunk_count, app_render);
+}
+
+// One chunk of app_record_layers, on whichever thread took it. The same
+// commands app_render_layer issues for the chunk's share of its view.
+void app_record_chunk(render_context_t& render, uint32_t chunk, void*) {
+	const app_record_chunk_t& plan   = app_record_chunks[chunk];
+	const app_record_view_t&  target = app_record_views[plan.view];
+
+	XrRect2Di& rect = target.view->subImage.imageRect;
+	render_set_viewport(render, { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height });
+	if (plan.clear) {
+		float clear[] = { 0.098f, 0.137f, 0.294f, 1.0f };
+		render_clear(render, target.color, target.depth, clear);
+	}
+	render_set_targets(render, target.color, target.depth);
+
+	if (app_record_stereo) app_draw_stereo_buckets(render, target.view, plan.first_draw, plan.end_draw);
+	else                   app_draw_buckets       (render, *target.view, nullptr, plan.first_draw, plan.end_draw);
+
+	// Nothing recorded on a deferred context runs until its command list is
+	// executed. Its state needn't survive, the chunk's context is invalidated
+	// before every recording.
+	if (d3d_deferred[chunk])
+		d3d_deferred[chunk]->FinishCommandList(FALSE, &d3d_command_lists[chunk]);
+}